@@ -0,0 +1,253 @@
+// Loader/block_device.cpp
+
+#include "block_device.h"
+#include "decompress.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+// Образы больше 2GB: fseek с long на Windows не хватает
+bool SeekFile(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+uint64_t FileSize(std::FILE* file) {
+#ifdef _WIN32
+    _fseeki64(file, 0, SEEK_END);
+    const __int64 size = _ftelli64(file);
+#else
+    fseeko(file, 0, SEEK_END);
+    const off_t size = ftello(file);
+#endif
+    return size > 0 ? static_cast<uint64_t>(size) : 0;
+}
+
+#pragma pack(push, 1)
+struct CompressedHeader {
+    char magic[4];          // "CISO" или "ZISO"
+    uint32_t headerSize;
+    uint64_t totalBytes;
+    uint32_t blockSize;
+    uint8_t version;
+    uint8_t align;          // смещения в индексе сдвинуты на align
+    uint8_t reserved[2];
+};
+#pragma pack(pop)
+
+constexpr uint32_t INDEX_PLAIN = 0x80000000;    // блок хранится без сжатия
+
+}  // namespace
+
+IsoBlockDevice::IsoBlockDevice(std::FILE* file) : file_(file) {
+    numSectors_ = static_cast<uint32_t>(FileSize(file_) / SECTOR_SIZE);
+}
+
+IsoBlockDevice::~IsoBlockDevice() {
+    std::fclose(file_);
+}
+
+bool IsoBlockDevice::ReadSectors(uint32_t first, uint32_t count, uint8_t* out) {
+    if (uint64_t(first) + count > numSectors_) return false;
+    if (!SeekFile(file_, uint64_t(first) * SECTOR_SIZE)) return false;
+    return std::fread(out, SECTOR_SIZE, count, file_) == count;
+}
+
+CompressedBlockDevice::CompressedBlockDevice(std::FILE* file, const Options& options)
+    : file_(file), options_(options) {
+    if (!ParseHeader()) {
+        blockSize_ = 0;
+        return;
+    }
+    maxCachedBlocks_ = std::max<size_t>(1, options_.cacheBytes / blockSize_);
+    // Упреждающее чтение не должно вытеснять то, что ещё не прочитано
+    options_.readAheadBlocks = static_cast<uint32_t>(
+        std::min<size_t>(options_.readAheadBlocks, maxCachedBlocks_ / 2));
+    if (options_.readAheadBlocks) {
+        aheadThread_ = std::thread(&CompressedBlockDevice::ReadAheadLoop, this);
+    }
+}
+
+CompressedBlockDevice::~CompressedBlockDevice() {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        stop_ = true;
+    }
+    aheadCv_.notify_one();
+    if (aheadThread_.joinable()) aheadThread_.join();
+    std::fclose(file_);
+}
+
+bool CompressedBlockDevice::ParseHeader() {
+    CompressedHeader header;
+    if (!SeekFile(file_, 0) || std::fread(&header, sizeof(header), 1, file_) != 1) return false;
+
+    if (std::memcmp(header.magic, "CISO", 4) == 0) {
+        lz4_ = false;
+    } else if (std::memcmp(header.magic, "ZISO", 4) == 0) {
+        lz4_ = true;
+    } else {
+        return false;
+    }
+    // Блок - целое число секторов, смещения индекса - 31 бит со сдвигом
+    if (header.blockSize < SECTOR_SIZE || header.blockSize % SECTOR_SIZE != 0 ||
+        header.blockSize > 1024 * 1024 || header.align > 31 || header.totalBytes == 0) {
+        return false;
+    }
+
+    const uint64_t numBlocks = (header.totalBytes + header.blockSize - 1) / header.blockSize;
+    if (numBlocks >= UINT32_MAX) return false;
+
+    blockSize_ = header.blockSize;
+    alignShift_ = header.align;
+    numBlocks_ = static_cast<uint32_t>(numBlocks);
+    numSectors_ = static_cast<uint32_t>(header.totalBytes / SECTOR_SIZE);
+    totalBytes_ = header.totalBytes;
+
+    index_.resize(numBlocks_ + 1);
+    return std::fread(index_.data(), sizeof(uint32_t), index_.size(), file_) == index_.size();
+}
+
+bool CompressedBlockDevice::ReadSectors(uint32_t first, uint32_t count, uint8_t* out) {
+    if (uint64_t(first) + count > numSectors_) return false;
+    if (count == 0) return true;
+
+    const uint64_t begin = uint64_t(first) * SECTOR_SIZE;
+    const uint64_t end = begin + uint64_t(count) * SECTOR_SIZE;
+    const uint32_t firstBlock = static_cast<uint32_t>(begin / blockSize_);
+    const uint32_t lastBlock = static_cast<uint32_t>((end - 1) / blockSize_);
+
+    // Продолжение предыдущего чтения - просим поток распаковать следующие блоки
+    if (options_.readAheadBlocks) {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (lastBlock_ != UINT32_MAX && (firstBlock == lastBlock_ || firstBlock == lastBlock_ + 1)) {
+            aheadEnd_ = std::min(numBlocks_, lastBlock + 1 + options_.readAheadBlocks);
+            // После перехода в другое место окно начинается заново
+            if (aheadNext_ <= lastBlock || aheadNext_ > aheadEnd_) aheadNext_ = lastBlock + 1;
+            aheadCv_.notify_one();
+        }
+        lastBlock_ = lastBlock;
+    }
+
+    for (uint32_t block = firstBlock; block <= lastBlock; ++block) {
+        Block data = GetBlock(block);
+        if (!data) return false;
+
+        const uint64_t blockStart = uint64_t(block) * blockSize_;
+        const uint64_t from = std::max(begin, blockStart);
+        const uint64_t to = std::min(end, blockStart + blockSize_);
+        std::memcpy(out + (from - begin), data->data() + (from - blockStart), static_cast<size_t>(to - from));
+    }
+    return true;
+}
+
+CompressedBlockDevice::Block CompressedBlockDevice::GetBlock(uint32_t block) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        auto it = cache_.find(block);
+        if (it != cache_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++hits_;
+            return it->second.data;
+        }
+        ++misses_;
+    }
+    Block data = LoadBlock(block);
+    if (data) Insert(block, data);
+    return data;
+}
+
+CompressedBlockDevice::Block CompressedBlockDevice::LoadBlock(uint32_t block) {
+    const bool plain = (index_[block] & INDEX_PLAIN) != 0;
+    const uint64_t offset = uint64_t(index_[block] & ~INDEX_PLAIN) << alignShift_;
+    const uint64_t next = uint64_t(index_[block + 1] & ~INDEX_PLAIN) << alignShift_;
+    if (next <= offset || next - offset > blockSize_ + (uint64_t(1) << alignShift_)) {
+        std::cerr << "Corrupt index for block " << block << std::endl;
+        return nullptr;
+    }
+
+    std::vector<uint8_t> packed(static_cast<size_t>(next - offset));
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (!SeekFile(file_, offset) || std::fread(packed.data(), 1, packed.size(), file_) != packed.size()) {
+            // Последний блок может быть короче выравнивания
+            if (block + 1 != numBlocks_ || std::ferror(file_)) return nullptr;
+        }
+    }
+
+    auto data = std::make_shared<std::vector<uint8_t>>(blockSize_, 0);
+    // Блок, который не ужался, хранится как есть (maxcso делает так без флага)
+    if (plain || packed.size() >= blockSize_) {
+        std::memcpy(data->data(), packed.data(), std::min<size_t>(packed.size(), blockSize_));
+        return data;
+    }
+
+    // Последний блок образа короче остальных
+    const size_t expected = static_cast<size_t>(
+        std::min<uint64_t>(blockSize_, totalBytes_ - uint64_t(block) * blockSize_));
+    const ptrdiff_t size = lz4_
+        ? Lz4Decompress(packed.data(), packed.size(), data->data(), expected)
+        : Inflate(packed.data(), packed.size(), data->data(), expected);
+    if (size < 0) {
+        std::cerr << "Failed to decompress block " << block << std::endl;
+        return nullptr;
+    }
+    return data;
+}
+
+void CompressedBlockDevice::Insert(uint32_t block, Block data) {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    if (cache_.count(block)) return;
+    while (cache_.size() >= maxCachedBlocks_) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(block);
+    cache_.emplace(block, CacheEntry{ std::move(data), lru_.begin() });
+}
+
+void CompressedBlockDevice::ReadAheadLoop() {
+    std::unique_lock<std::mutex> lock(cacheMutex_);
+    for (;;) {
+        aheadCv_.wait(lock, [&] { return stop_ || aheadNext_ < aheadEnd_; });
+        if (stop_) return;
+
+        const uint32_t block = aheadNext_++;
+        if (cache_.count(block)) continue;
+
+        lock.unlock();
+        Block data = LoadBlock(block);
+        if (data) Insert(block, std::move(data));
+        lock.lock();
+    }
+}
+
+std::unique_ptr<BlockDevice> OpenBlockDevice(const std::string& path,
+                                             const CompressedBlockDevice::Options& options) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return nullptr;
+
+    char magic[4] = {};
+    const bool hasMagic = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic);
+    if (hasMagic && (std::memcmp(magic, "CISO", 4) == 0 || std::memcmp(magic, "ZISO", 4) == 0)) {
+        auto device = std::make_unique<CompressedBlockDevice>(file, options);
+        if (!device->IsValid()) {
+            std::cerr << "Invalid compressed image: " << path << std::endl;
+            return nullptr;
+        }
+        return device;
+    }
+    return std::make_unique<IsoBlockDevice>(file);
+}
+
+}  // namespace loader
+}  // namespace ppsspp
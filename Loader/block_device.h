@@ -0,0 +1,125 @@
+// Loader/block_device.h
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ppsspp {
+namespace loader {
+
+// Образ диска с произвольным доступом по секторам
+class BlockDevice {
+public:
+    static constexpr uint32_t SECTOR_SIZE = 2048;
+
+    virtual ~BlockDevice() = default;
+
+    // Читает count секторов начиная с first; false - ошибка чтения или распаковки
+    virtual bool ReadSectors(uint32_t first, uint32_t count, uint8_t* out) = 0;
+    virtual uint32_t GetNumSectors() const = 0;
+};
+
+// Несжатый ISO: чтение напрямую из файла
+class IsoBlockDevice : public BlockDevice {
+public:
+    explicit IsoBlockDevice(std::FILE* file);
+    ~IsoBlockDevice() override;
+
+    // Запрещаем копирование
+    IsoBlockDevice(const IsoBlockDevice&) = delete;
+    IsoBlockDevice& operator=(const IsoBlockDevice&) = delete;
+
+    bool ReadSectors(uint32_t first, uint32_t count, uint8_t* out) override;
+    uint32_t GetNumSectors() const override { return numSectors_; }
+
+private:
+    std::FILE* file_;
+    uint32_t numSectors_ = 0;
+};
+
+// Сжатый образ CSO (DEFLATE) или ZSO (LZ4). Блоки распаковываются по запросу
+// в LRU-кэш с бюджетом в байтах; при последовательном чтении фоновый поток
+// заранее распаковывает следующие блоки.
+class CompressedBlockDevice : public BlockDevice {
+public:
+    struct Options {
+        size_t cacheBytes = 8 * 1024 * 1024;
+        uint32_t readAheadBlocks = 32;      // 0 - без упреждающего чтения
+    };
+
+    // file закрывается устройством; false из IsValid() - неверный заголовок
+    CompressedBlockDevice(std::FILE* file, const Options& options);
+    ~CompressedBlockDevice() override;
+
+    // Запрещаем копирование
+    CompressedBlockDevice(const CompressedBlockDevice&) = delete;
+    CompressedBlockDevice& operator=(const CompressedBlockDevice&) = delete;
+
+    bool IsValid() const { return blockSize_ != 0; }
+
+    bool ReadSectors(uint32_t first, uint32_t count, uint8_t* out) override;
+    uint32_t GetNumSectors() const override { return numSectors_; }
+
+    // Статистика кэша
+    uint64_t GetCacheHits() const { return hits_; }
+    uint64_t GetCacheMisses() const { return misses_; }
+
+private:
+    using Block = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct CacheEntry {
+        Block data;
+        std::list<uint32_t>::iterator lru;
+    };
+
+    bool ParseHeader();
+    // Блок из кэша или с диска; nullptr - ошибка
+    Block GetBlock(uint32_t block);
+    Block LoadBlock(uint32_t block);
+    void Insert(uint32_t block, Block data);
+    void ReadAheadLoop();
+
+    std::FILE* file_;
+    Options options_;
+    bool lz4_ = false;
+    uint32_t blockSize_ = 0;
+    uint32_t alignShift_ = 0;
+    uint32_t numBlocks_ = 0;
+    uint32_t numSectors_ = 0;
+    uint64_t totalBytes_ = 0;
+    std::vector<uint32_t> index_;   // numBlocks_ + 1 записей
+
+    std::mutex fileMutex_;          // чтение файла: вызывающий и фоновый поток
+    std::mutex cacheMutex_;
+    std::unordered_map<uint32_t, CacheEntry> cache_;
+    std::list<uint32_t> lru_;       // в начале - последние использованные
+    size_t maxCachedBlocks_ = 1;
+    std::atomic<uint64_t> hits_{ 0 };
+    std::atomic<uint64_t> misses_{ 0 };
+
+    // Упреждающее чтение: поток распаковывает [aheadNext_, aheadEnd_)
+    uint32_t lastBlock_ = UINT32_MAX;
+    uint32_t aheadNext_ = 0;
+    uint32_t aheadEnd_ = 0;
+    bool stop_ = false;
+    std::condition_variable aheadCv_;
+    std::thread aheadThread_;
+};
+
+// Открывает ISO, CSO или ZSO по сигнатуре; nullptr - файл не открыт или повреждён
+std::unique_ptr<BlockDevice> OpenBlockDevice(const std::string& path,
+                                             const CompressedBlockDevice::Options& options = {});
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,327 @@
+// Loader/decompress.cpp
+
+#include "decompress.h"
+
+#include <cstring>
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+constexpr int MAX_BITS = 15;
+constexpr int FAST_BITS = 9;    // коды не длиннее декодируются одной выборкой из таблицы
+constexpr int MAX_LITLEN_CODES = 288;
+constexpr int MAX_DIST_CODES = 30;
+
+constexpr uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+constexpr uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+constexpr uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+constexpr uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+constexpr uint8_t CODE_LENGTH_ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Биты DEFLATE идут от младшего к старшему; буфер держит до 64 бит
+class BitReader {
+public:
+    BitReader(const uint8_t* in, size_t size) : in_(in), size_(size) {}
+
+    bool Need(int n) {
+        while (count_ < n) {
+            if (pos_ >= size_) return false;
+            buffer_ |= uint64_t(in_[pos_++]) << count_;
+            count_ += 8;
+        }
+        return true;
+    }
+
+    // Дочитывает сколько есть, не требуя n бит (для выборки из таблицы у конца потока)
+    void Fill() {
+        while (count_ <= 56 && pos_ < size_) {
+            buffer_ |= uint64_t(in_[pos_++]) << count_;
+            count_ += 8;
+        }
+    }
+
+    uint32_t Peek(int n) const { return static_cast<uint32_t>(buffer_ & ((uint64_t(1) << n) - 1)); }
+    int Available() const { return count_; }
+    void Drop(int n) { buffer_ >>= n; count_ -= n; }
+
+    bool Bits(int n, uint32_t& out) {
+        if (!Need(n)) return false;
+        out = Peek(n);
+        Drop(n);
+        return true;
+    }
+
+    // Начало несжатого блока: остаток байта отбрасывается
+    void AlignToByte() { Drop(count_ & 7); }
+
+    // Несжатые байты: сначала из буфера, затем напрямую из входа
+    bool Copy(uint8_t* out, size_t n) {
+        while (n && count_ >= 8) {
+            *out++ = static_cast<uint8_t>(buffer_);
+            Drop(8);
+            --n;
+        }
+        if (n > size_ - pos_) return false;
+        std::memcpy(out, in_ + pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+private:
+    const uint8_t* in_;
+    size_t size_;
+    size_t pos_ = 0;
+    uint64_t buffer_ = 0;
+    int count_ = 0;
+};
+
+// Канонический код Хаффмана: таблица для коротких кодов + счётчики по длинам
+struct Huffman {
+    uint16_t fast[1 << FAST_BITS];      // symbol << 4 | length; 0 - код длиннее FAST_BITS
+    uint16_t count[MAX_BITS + 1];
+    uint16_t symbol[MAX_LITLEN_CODES];
+
+    bool Build(const uint8_t* lengths, int n) {
+        std::memset(count, 0, sizeof(count));
+        std::memset(fast, 0, sizeof(fast));
+        for (int s = 0; s < n; ++s) ++count[lengths[s]];
+        count[0] = 0;
+
+        // Переподписанный код недопустим; неполный разрешён (одиночный код расстояния)
+        int left = 1;
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            left = (left << 1) - count[len];
+            if (left < 0) return false;
+        }
+
+        uint16_t offsets[MAX_BITS + 2];
+        offsets[1] = 0;
+        for (int len = 1; len <= MAX_BITS; ++len) offsets[len + 1] = offsets[len] + count[len];
+        for (int s = 0; s < n; ++s) {
+            if (lengths[s]) symbol[offsets[lengths[s]]++] = static_cast<uint16_t>(s);
+        }
+
+        // Коды назначаются по возрастанию и в потоке читаются перевёрнутыми
+        uint32_t code = 0;
+        int index = 0;
+        for (int len = 1; len <= FAST_BITS; ++len) {
+            for (int k = 0; k < count[len]; ++k, ++code, ++index) {
+                uint32_t reversed = 0;
+                for (int b = 0; b < len; ++b) reversed |= ((code >> b) & 1) << (len - 1 - b);
+                for (uint32_t fill = reversed; fill < (1u << FAST_BITS); fill += 1u << len) {
+                    fast[fill] = static_cast<uint16_t>((symbol[index] << 4) | len);
+                }
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    int Decode(BitReader& bits) const {
+        bits.Fill();
+        const uint16_t entry = fast[bits.Peek(FAST_BITS)];
+        if (entry && (entry & 15) <= bits.Available()) {
+            bits.Drop(entry & 15);
+            return entry >> 4;
+        }
+        // Длинный код: побитово, как в эталонном puff
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            uint32_t bit;
+            if (!bits.Bits(1, bit)) return -1;
+            code |= bit;
+            const int n = count[len];
+            if (code - n < first) return symbol[index + (code - first)];
+            index += n;
+            first = (first + n) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+};
+
+bool BuildFixed(Huffman& litlen, Huffman& dist) {
+    uint8_t lengths[MAX_LITLEN_CODES];
+    int s = 0;
+    for (; s < 144; ++s) lengths[s] = 8;
+    for (; s < 256; ++s) lengths[s] = 9;
+    for (; s < 280; ++s) lengths[s] = 7;
+    for (; s < 288; ++s) lengths[s] = 8;
+    if (!litlen.Build(lengths, MAX_LITLEN_CODES)) return false;
+    for (s = 0; s < MAX_DIST_CODES; ++s) lengths[s] = 5;
+    return dist.Build(lengths, MAX_DIST_CODES);
+}
+
+bool BuildDynamic(BitReader& bits, Huffman& litlen, Huffman& dist) {
+    uint32_t nlen, ndist, ncode;
+    if (!bits.Bits(5, nlen) || !bits.Bits(5, ndist) || !bits.Bits(4, ncode)) return false;
+    nlen += 257;
+    ndist += 1;
+    ncode += 4;
+    if (nlen > 286 || ndist > MAX_DIST_CODES) return false;
+
+    uint8_t lengths[MAX_LITLEN_CODES + MAX_DIST_CODES] = {};
+    for (uint32_t i = 0; i < ncode; ++i) {
+        uint32_t len;
+        if (!bits.Bits(3, len)) return false;
+        lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(len);
+    }
+    Huffman lencode;
+    if (!lencode.Build(lengths, 19)) return false;
+
+    uint32_t index = 0;
+    while (index < nlen + ndist) {
+        int symbol = lencode.Decode(bits);
+        if (symbol < 0) return false;
+        if (symbol < 16) {
+            lengths[index++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        uint8_t value = 0;
+        uint32_t repeat;
+        if (symbol == 16) {
+            if (index == 0 || !bits.Bits(2, repeat)) return false;
+            value = lengths[index - 1];
+            repeat += 3;
+        } else if (symbol == 17) {
+            if (!bits.Bits(3, repeat)) return false;
+            repeat += 3;
+        } else {
+            if (!bits.Bits(7, repeat)) return false;
+            repeat += 11;
+        }
+        if (index + repeat > nlen + ndist) return false;
+        while (repeat--) lengths[index++] = value;
+    }
+    // Без кода конца блока поток не завершить
+    if (lengths[256] == 0) return false;
+    return litlen.Build(lengths, nlen) && dist.Build(lengths + nlen, ndist);
+}
+
+}  // namespace
+
+ptrdiff_t Inflate(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize) {
+    BitReader bits(in, inSize);
+    size_t written = 0;
+    Huffman litlen, dist;
+
+    uint32_t last = 0;
+    while (!last) {
+        uint32_t type;
+        if (!bits.Bits(1, last) || !bits.Bits(2, type)) return -1;
+
+        if (type == 0) {
+            bits.AlignToByte();
+            uint32_t len, nlen;
+            if (!bits.Bits(16, len) || !bits.Bits(16, nlen) || len != (~nlen & 0xFFFF)) return -1;
+            if (len > outSize - written) return -1;
+            if (!bits.Copy(out + written, len)) return -1;
+            written += len;
+            if (written == outSize) break;
+            continue;
+        }
+        if (type == 1) {
+            if (!BuildFixed(litlen, dist)) return -1;
+        } else if (type == 2) {
+            if (!BuildDynamic(bits, litlen, dist)) return -1;
+        } else {
+            return -1;
+        }
+
+        for (;;) {
+            const int symbol = litlen.Decode(bits);
+            if (symbol < 0) return -1;
+            if (symbol < 256) {
+                if (written == outSize) return -1;
+                out[written++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            if (symbol == 256) break;
+
+            const int lenIndex = symbol - 257;
+            if (lenIndex >= 29) return -1;
+            uint32_t extra;
+            if (!bits.Bits(LENGTH_EXTRA[lenIndex], extra)) return -1;
+            const size_t length = LENGTH_BASE[lenIndex] + extra;
+
+            const int distIndex = dist.Decode(bits);
+            if (distIndex < 0 || distIndex >= MAX_DIST_CODES) return -1;
+            if (!bits.Bits(DIST_EXTRA[distIndex], extra)) return -1;
+            const size_t distance = DIST_BASE[distIndex] + extra;
+
+            if (distance > written || length > outSize - written) return -1;
+            // Источник может перекрываться с приёмником - копия побайтовая
+            const uint8_t* src = out + written - distance;
+            uint8_t* dst = out + written;
+            for (size_t i = 0; i < length; ++i) dst[i] = src[i];
+            written += length;
+        }
+        if (written == outSize) break;
+    }
+    return static_cast<ptrdiff_t>(written);
+}
+
+ptrdiff_t Lz4Decompress(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize) {
+    const uint8_t* ip = in;
+    const uint8_t* const inEnd = in + inSize;
+    uint8_t* op = out;
+    uint8_t* const outEnd = out + outSize;
+
+    auto readLength = [&](size_t& length) {
+        uint8_t b;
+        do {
+            if (ip >= inEnd) return false;
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip < inEnd) {
+        const uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) return -1;
+        if (literals > size_t(inEnd - ip) || literals > size_t(outEnd - op)) return -1;
+        std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // Последняя последовательность состоит только из литералов; за ней
+        // во входе может идти выравнивание образа, поэтому полный выход - тоже конец
+        if (ip >= inEnd || op == outEnd) break;
+
+        if (inEnd - ip < 2) return -1;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > size_t(op - out)) return -1;
+
+        size_t match = token & 15;
+        if (match == 15 && !readLength(match)) return -1;
+        match += 4;
+        if (match > size_t(outEnd - op)) return -1;
+
+        const uint8_t* src = op - offset;
+        if (offset >= match) {
+            std::memcpy(op, src, match);
+        } else {
+            for (size_t i = 0; i < match; ++i) op[i] = src[i];
+        }
+        op += match;
+    }
+    return op - out;
+}
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,21 @@
+// Loader/decompress.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ppsspp {
+namespace loader {
+
+// Распаковка raw DEFLATE (RFC 1951, без заголовка zlib) - блоки CSO.
+// Возвращает число записанных байт или -1 при ошибке в данных.
+// Распаковка останавливается на последнем блоке потока или при заполнении out.
+ptrdiff_t Inflate(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize);
+
+// Распаковка блока LZ4 (без заголовка кадра) - блоки ZSO.
+// Возвращает число записанных байт или -1 при ошибке в данных.
+ptrdiff_t Lz4Decompress(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize);
+
+}  // namespace loader
+}  // namespace ppsspp
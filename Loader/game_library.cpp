@@ -0,0 +1,301 @@
+// Loader/game_library.cpp
+
+#include "game_library.h"
+#include "block_device.h"
+#include "iso_filesystem.h"
+#include "loader.h"
+#include "mapped_file.h"
+#include "param_sfo.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+constexpr int INDEX_VERSION = 1;
+
+bool IsImageExtension(std::string ext) {
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return ext == ".pbp" || ext == ".iso" || ext == ".cso" || ext == ".zso";
+}
+
+// FNV-1a по 64-битным словам: файл читается потоком, без отображения -
+// образы UMD больше адресного пространства 32-битного процесса
+uint64_t HashFile(const std::string& path, bool& ok) {
+    constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+    constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+    ok = false;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return 0;
+
+    uint64_t hash = FNV_OFFSET;
+    std::vector<uint8_t> buffer(1 << 20);
+    size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        size_t i = 0;
+        for (; i + 8 <= read; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, buffer.data() + i, 8);
+            hash = (hash ^ word) * FNV_PRIME;
+        }
+        for (; i < read; ++i) hash = (hash ^ buffer[i]) * FNV_PRIME;
+    }
+    ok = !std::ferror(file);
+    std::fclose(file);
+    return hash;
+}
+
+bool ReadSfoFromPBP(const std::string& path, ParamSfo& sfo) {
+    MappedFile file(path);
+    if (!file.IsValid()) return false;
+    const uint8_t* elf = nullptr;
+    size_t elfSize = 0;
+    return Loader::ExtractFromPBP(file.GetData(), file.GetSize(), elf, elfSize, sfo) && sfo.GetCount();
+}
+
+bool ReadSfoFromImage(const std::string& path, ParamSfo& sfo) {
+    // Нужен один файл: без упреждающего чтения и с маленьким кэшем
+    CompressedBlockDevice::Options options;
+    options.cacheBytes = 64 * 1024;
+    options.readAheadBlocks = 0;
+
+    IsoFileSystem umd(OpenBlockDevice(path, options));
+    if (!umd.Mount()) return false;
+
+    const IsoFileSystem::Entry* entry = umd.Find("PSP_GAME/PARAM.SFO");
+    if (!entry || entry->directory) return false;
+
+    std::vector<uint8_t> data(entry->size);
+    if (umd.Read(*entry, 0, data.data(), data.size()) != static_cast<ptrdiff_t>(data.size())) return false;
+    return sfo.Parse(data.data(), data.size());
+}
+
+json ToJson(const GameInfo& game) {
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(game.hash));
+    return {
+        { "path", game.path },
+        { "title", game.title },
+        { "discId", game.discId },
+        { "version", game.version },
+        { "size", game.fileSize },
+        { "mtime", game.modifiedTime },
+        { "hash", hash },
+    };
+}
+
+GameInfo FromJson(const json& j) {
+    GameInfo game;
+    game.path = j.at("path").get<std::string>();
+    game.title = j.value("title", "");
+    game.discId = j.value("discId", "");
+    game.version = j.value("version", "");
+    game.fileSize = j.value("size", uint64_t(0));
+    game.modifiedTime = j.value("mtime", int64_t(0));
+    game.hash = std::strtoull(j.value("hash", "0").c_str(), nullptr, 16);
+    return game;
+}
+
+}  // namespace
+
+GameLibrary::GameLibrary(std::string indexPath) : indexPath_(std::move(indexPath)) {}
+
+bool GameLibrary::Load() {
+    games_.clear();
+    failed_.clear();
+    dirty_ = false;
+    try {
+        std::ifstream file(indexPath_);
+        if (!file.is_open()) return false;
+
+        json j;
+        file >> j;
+        if (j.value("version", 0) != INDEX_VERSION) return false;
+        for (const json& entry : j.at("games")) {
+            games_.push_back(FromJson(entry));
+        }
+        // Индексы без списка неразобранных образов тоже годятся
+        for (const json& entry : j.value("failed", json::array())) {
+            failed_.push_back({ entry.at("path").get<std::string>(), entry.value("size", uint64_t(0)),
+                                entry.value("mtime", int64_t(0)) });
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Game index " << indexPath_ << " is corrupt: " << e.what() << std::endl;
+        games_.clear();
+        failed_.clear();
+        return false;
+    }
+
+    std::sort(games_.begin(), games_.end(),
+              [](const GameInfo& a, const GameInfo& b) { return a.path < b.path; });
+    std::sort(failed_.begin(), failed_.end(),
+              [](const FailedImage& a, const FailedImage& b) { return a.path < b.path; });
+    return true;
+}
+
+bool GameLibrary::Save() {
+    if (!dirty_) return true;
+    try {
+        json games = json::array();
+        for (const GameInfo& game : games_) {
+            games.push_back(ToJson(game));
+        }
+        json failed = json::array();
+        for (const FailedImage& image : failed_) {
+            failed.push_back({ { "path", image.path }, { "size", image.fileSize }, { "mtime", image.modifiedTime } });
+        }
+        json j = { { "version", INDEX_VERSION }, { "games", std::move(games) }, { "failed", std::move(failed) } };
+
+        // Пишем во временный файл и подменяем: прерванная запись не портит индекс
+        const std::string tempPath = indexPath_ + ".tmp";
+        {
+            std::ofstream file(tempPath);
+            if (!file.is_open()) return false;
+            file << j.dump(1);
+            if (!file) return false;
+        }
+        std::filesystem::rename(tempPath, indexPath_);
+        dirty_ = false;
+        return true;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+GameLibrary::ScanStats GameLibrary::Scan(const std::string& directory) {
+    ScanStats stats;
+
+    std::unordered_map<std::string, size_t> known;
+    known.reserve(games_.size());
+    for (size_t i = 0; i < games_.size(); ++i) {
+        known.emplace(games_[i].path, i);
+    }
+    std::unordered_map<std::string, size_t> knownFailed;
+    knownFailed.reserve(failed_.size());
+    for (size_t i = 0; i < failed_.size(); ++i) {
+        knownFailed.emplace(failed_[i].path, i);
+    }
+
+    std::vector<GameInfo> scanned;
+    std::vector<FailedImage> scannedFailed;
+    std::error_code ec;
+    namespace fs = std::filesystem;
+    for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        const fs::directory_entry& entry = *it;
+        std::error_code statError;
+        if (!entry.is_regular_file(statError) || !IsImageExtension(entry.path().extension().string())) continue;
+
+        ++stats.total;
+        const std::string path = entry.path().generic_string();
+        const uint64_t fileSize = entry.file_size(statError);
+        const int64_t modifiedTime = entry.last_write_time(statError).time_since_epoch().count();
+        if (statError) {
+            ++stats.failed;
+            continue;
+        }
+
+        // Размер и время совпали - файл не трогали, разбор не нужен
+        auto cached = known.find(path);
+        if (cached != known.end()) {
+            const GameInfo& old = games_[cached->second];
+            if (old.fileSize == fileSize && old.modifiedTime == modifiedTime) {
+                scanned.push_back(old);
+                ++stats.reused;
+                continue;
+            }
+        }
+        // Так же не разбираем заново неизменённый образ, который уже не разобрался
+        auto bad = knownFailed.find(path);
+        if (bad != knownFailed.end()) {
+            const FailedImage& old = failed_[bad->second];
+            if (old.fileSize == fileSize && old.modifiedTime == modifiedTime) {
+                scannedFailed.push_back(old);
+                ++stats.skipped;
+                continue;
+            }
+        }
+
+        GameInfo game;
+        if (!ReadGameInfo(path, game)) {
+            scannedFailed.push_back({ path, fileSize, modifiedTime });
+            ++stats.failed;
+            dirty_ = true;
+            continue;
+        }
+        game.fileSize = fileSize;
+        game.modifiedTime = modifiedTime;
+        scanned.push_back(std::move(game));
+        ++stats.parsed;
+    }
+    if (ec) {
+        std::cerr << "Failed to scan " << directory << ": " << ec.message() << std::endl;
+    }
+
+    // Записи из других каталогов сохраняются, записи этого каталога заменяются
+    std::string prefix = fs::path(directory).generic_string();
+    if (!prefix.empty() && prefix.back() != '/') prefix.push_back('/');
+    for (const GameInfo& game : games_) {
+        if (game.path.compare(0, prefix.size(), prefix) != 0) scanned.push_back(game);
+    }
+    for (const FailedImage& image : failed_) {
+        if (image.path.compare(0, prefix.size(), prefix) != 0) scannedFailed.push_back(image);
+    }
+
+    std::sort(scanned.begin(), scanned.end(),
+              [](const GameInfo& a, const GameInfo& b) { return a.path < b.path; });
+    std::sort(scannedFailed.begin(), scannedFailed.end(),
+              [](const FailedImage& a, const FailedImage& b) { return a.path < b.path; });
+    if (stats.parsed || scanned.size() != games_.size() ||
+        scannedFailed.size() != failed_.size()) {
+        dirty_ = true;
+    }
+    games_ = std::move(scanned);
+    failed_ = std::move(scannedFailed);
+    return stats;
+}
+
+const GameInfo* GameLibrary::Find(const std::string& path) const {
+    auto it = std::lower_bound(games_.begin(), games_.end(), path,
+                               [](const GameInfo& game, const std::string& p) { return game.path < p; });
+    return (it != games_.end() && it->path == path) ? &*it : nullptr;
+}
+
+bool GameLibrary::ReadGameInfo(const std::string& path, GameInfo& out) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+    ParamSfo sfo;
+    const bool parsed = (ext == ".pbp") ? ReadSfoFromPBP(path, sfo) : ReadSfoFromImage(path, sfo);
+    if (!parsed) {
+        std::cerr << "No PARAM.SFO in " << path << std::endl;
+        return false;
+    }
+
+    bool hashed = false;
+    out.path = path;
+    out.title = sfo.GetString("TITLE");
+    out.discId = sfo.GetString("DISC_ID");
+    out.version = sfo.GetString("APP_VER", sfo.GetString("DISC_VERSION"));
+    out.hash = HashFile(path, hashed);
+    return hashed;
+}
+
+}  // namespace loader
+}  // namespace ppsspp
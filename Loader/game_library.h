@@ -0,0 +1,74 @@
+// Loader/game_library.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ppsspp {
+namespace loader {
+
+// Метаданные одного образа (PBP, ISO, CSO, ZSO)
+struct GameInfo {
+    std::string path;
+    std::string title;
+    std::string discId;
+    std::string version;    // APP_VER, а если его нет - DISC_VERSION
+    uint64_t fileSize = 0;
+    int64_t modifiedTime = 0;   // время изменения файла, единицы часов файловой системы
+    uint64_t hash = 0;          // хэш содержимого файла
+};
+
+// Индекс библиотеки образов, хранящийся на диске в JSON. Повторное
+// сканирование разбирает только новые и изменённые файлы (по размеру и
+// времени изменения), остальные записи берутся из индекса как есть.
+// Образы, которые не удалось разобрать, тоже запоминаются и пропускаются,
+// пока не изменятся.
+class GameLibrary {
+public:
+    struct ScanStats {
+        size_t total = 0;       // образов в каталоге
+        size_t reused = 0;      // взяты из индекса
+        size_t parsed = 0;      // прочитаны заново
+        size_t failed = 0;      // не удалось разобрать
+        size_t skipped = 0;     // не разбирались и не изменились с прошлого раза
+    };
+
+    explicit GameLibrary(std::string indexPath);
+
+    // Запрещаем копирование
+    GameLibrary(const GameLibrary&) = delete;
+    GameLibrary& operator=(const GameLibrary&) = delete;
+
+    // Читает индекс с диска; false - файла нет или он повреждён (индекс пуст)
+    bool Load();
+    // Записывает индекс, только если он изменился после Load/Save
+    bool Save();
+
+    // Обходит каталог рекурсивно и приводит индекс в соответствие с ним:
+    // удалённые образы исчезают, изменённые перечитываются
+    ScanStats Scan(const std::string& directory);
+
+    const std::vector<GameInfo>& GetGames() const { return games_; }
+    const GameInfo* Find(const std::string& path) const;
+
+    // Разбирает образ целиком: PARAM.SFO и хэш содержимого
+    static bool ReadGameInfo(const std::string& path, GameInfo& out);
+
+private:
+    struct FailedImage {
+        std::string path;
+        uint64_t fileSize = 0;
+        int64_t modifiedTime = 0;
+    };
+
+    std::string indexPath_;
+    std::vector<GameInfo> games_;   // по возрастанию path
+    std::vector<FailedImage> failed_;   // по возрастанию path
+    bool dirty_ = false;
+};
+
+}  // namespace loader
+}  // namespace ppsspp
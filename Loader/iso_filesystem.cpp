@@ -0,0 +1,196 @@
+// Loader/iso_filesystem.cpp
+
+#include "iso_filesystem.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+constexpr uint32_t SECTOR_SIZE = BlockDevice::SECTOR_SIZE;
+constexpr uint32_t PVD_SECTOR = 16;
+constexpr size_t ROOT_RECORD_OFFSET = 156;
+constexpr uint8_t FLAG_DIRECTORY = 0x02;
+
+// Поля записи каталога (ISO9660 9.1); числа хранятся в обоих порядках байт,
+// берём little-endian половину
+uint32_t ReadLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+struct DirectoryRecord {
+    uint32_t sector;
+    uint32_t size;
+    uint8_t flags;
+    std::string_view name;
+};
+
+// false - запись обрезана
+bool ParseRecord(const uint8_t* p, size_t available, DirectoryRecord& out) {
+    const uint8_t length = p[0];
+    if (length < 33 || length > available) return false;
+    const uint8_t nameLength = p[32];
+    if (33u + nameLength > length) return false;
+    out.sector = ReadLE32(p + 2);
+    out.size = ReadLE32(p + 10);
+    out.flags = p[25];
+    out.name = std::string_view(reinterpret_cast<const char*>(p + 33), nameLength);
+    return true;
+}
+
+// "FILE.BIN;1" -> "FILE.BIN", "NOEXT.;1" -> "NOEXT"
+std::string CleanName(std::string_view name) {
+    const size_t version = name.find(';');
+    if (version != std::string_view::npos) name = name.substr(0, version);
+    if (!name.empty() && name.back() == '.') name.remove_suffix(1);
+    std::string result(name);
+    for (char& c : result) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return result;
+}
+
+}  // namespace
+
+IsoFileSystem::IsoFileSystem(std::unique_ptr<BlockDevice> device) : device_(std::move(device)) {}
+
+std::string IsoFileSystem::NormalizePath(std::string_view path) {
+    const size_t colon = path.find(':');
+    if (colon != std::string_view::npos) path = path.substr(colon + 1);
+
+    std::vector<std::string_view> parts;
+    while (!path.empty()) {
+        const size_t slash = path.find_first_of("/\\");
+        const std::string_view part = path.substr(0, slash);
+        path = slash == std::string_view::npos ? std::string_view() : path.substr(slash + 1);
+
+        if (part.empty() || part == ".") continue;
+        if (part == "..") {
+            if (!parts.empty()) parts.pop_back();
+            continue;
+        }
+        parts.push_back(part);
+    }
+
+    std::string result;
+    for (std::string_view part : parts) {
+        if (!result.empty()) result.push_back('/');
+        result.append(part);
+    }
+    for (char& c : result) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return result;
+}
+
+bool IsoFileSystem::Mount() {
+    entries_.clear();
+    if (!device_ || device_->GetNumSectors() <= PVD_SECTOR) return false;
+
+    uint8_t pvd[SECTOR_SIZE];
+    if (!device_->ReadSectors(PVD_SECTOR, 1, pvd)) return false;
+    if (pvd[0] != 1 || std::memcmp(pvd + 1, "CD001", 5) != 0) {
+        std::cerr << "No ISO9660 primary volume descriptor." << std::endl;
+        return false;
+    }
+
+    DirectoryRecord root;
+    if (!ParseRecord(pvd + ROOT_RECORD_OFFSET, 34, root)) return false;
+
+    // Обход в ширину; экстенты каталогов запоминаются, чтобы битый образ
+    // с петлёй в дереве не завесил монтирование
+    std::vector<Entry> pending = { { "", root.sector, root.size, true } };
+    std::unordered_set<uint32_t> visited;
+    while (!pending.empty()) {
+        Entry dir = std::move(pending.back());
+        pending.pop_back();
+        if (!visited.insert(dir.sector).second) continue;
+        if (!ReadDirectory(dir.path, dir.sector, dir.size, pending)) return false;
+    }
+
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) { return a.path < b.path; });
+    return true;
+}
+
+bool IsoFileSystem::ReadDirectory(const std::string& prefix, uint32_t sector, uint32_t size,
+                                  std::vector<Entry>& pending) {
+    const uint32_t numSectors = (size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    std::vector<uint8_t> data(size_t(numSectors) * SECTOR_SIZE);
+    if (numSectors && !device_->ReadSectors(sector, numSectors, data.data())) return false;
+
+    // Записи не пересекают границу сектора; нулевая длина - добивка до конца сектора
+    size_t pos = 0;
+    while (pos < size) {
+        const size_t sectorEnd = (pos / SECTOR_SIZE + 1) * SECTOR_SIZE;
+        if (data[pos] == 0) {
+            pos = sectorEnd;
+            continue;
+        }
+        DirectoryRecord record;
+        if (!ParseRecord(data.data() + pos, sectorEnd - pos, record)) {
+            pos = sectorEnd;
+            continue;
+        }
+        pos += data[pos];
+
+        // "." и ".." записаны байтами 0 и 1
+        if (record.name.size() == 1 && (record.name[0] == 0 || record.name[0] == 1)) continue;
+
+        Entry entry;
+        entry.path = prefix.empty() ? CleanName(record.name) : prefix + "/" + CleanName(record.name);
+        entry.sector = record.sector;
+        entry.size = record.size;
+        entry.directory = (record.flags & FLAG_DIRECTORY) != 0;
+        if (entry.directory) pending.push_back(entry);
+        entries_.push_back(std::move(entry));
+    }
+    return true;
+}
+
+const IsoFileSystem::Entry* IsoFileSystem::Find(std::string_view path) const {
+    const std::string key = NormalizePath(path);
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), key,
+                               [](const Entry& entry, const std::string& k) { return entry.path < k; });
+    if (it == entries_.end() || it->path != key) return nullptr;
+    return &*it;
+}
+
+ptrdiff_t IsoFileSystem::Read(const Entry& entry, uint64_t offset, void* out, size_t size) const {
+    if (offset >= entry.size) return 0;
+    size = static_cast<size_t>(std::min<uint64_t>(size, entry.size - offset));
+    uint8_t* dst = static_cast<uint8_t*>(out);
+
+    uint32_t sector = entry.sector + static_cast<uint32_t>(offset / SECTOR_SIZE);
+    size_t skip = static_cast<size_t>(offset % SECTOR_SIZE);
+    size_t remaining = size;
+    uint8_t buffer[SECTOR_SIZE];
+
+    // Неполный первый сектор - через буфер
+    if (skip) {
+        if (!device_->ReadSectors(sector, 1, buffer)) return -1;
+        const size_t chunk = std::min(remaining, size_t(SECTOR_SIZE) - skip);
+        std::memcpy(dst, buffer + skip, chunk);
+        dst += chunk;
+        remaining -= chunk;
+        ++sector;
+    }
+    // Целые секторы - прямо в приёмник одним вызовом
+    const uint32_t whole = static_cast<uint32_t>(remaining / SECTOR_SIZE);
+    if (whole) {
+        if (!device_->ReadSectors(sector, whole, dst)) return -1;
+        dst += size_t(whole) * SECTOR_SIZE;
+        remaining -= size_t(whole) * SECTOR_SIZE;
+        sector += whole;
+    }
+    if (remaining) {
+        if (!device_->ReadSectors(sector, 1, buffer)) return -1;
+        std::memcpy(dst, buffer, remaining);
+    }
+    return static_cast<ptrdiff_t>(size);
+}
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,60 @@
+// Loader/iso_filesystem.h
+
+#pragma once
+
+#include "block_device.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ppsspp {
+namespace loader {
+
+// Файловая система ISO9660 образа UMD. Дерево каталогов обходится один раз
+// при монтировании и превращается в плоский индекс путь -> экстент,
+// отсортированный по пути: поиск - двоичный, без повторного обхода каталогов.
+class IsoFileSystem {
+public:
+    struct Entry {
+        std::string path;       // "PSP_GAME/SYSDIR/EBOOT.BIN", без ведущего '/'
+        uint32_t sector = 0;    // первый сектор экстента
+        uint32_t size = 0;      // байт
+        bool directory = false;
+    };
+
+    explicit IsoFileSystem(std::unique_ptr<BlockDevice> device);
+
+    // Запрещаем копирование
+    IsoFileSystem(const IsoFileSystem&) = delete;
+    IsoFileSystem& operator=(const IsoFileSystem&) = delete;
+
+    // Читает дескриптор тома и строит индекс; false - не ISO9660
+    bool Mount();
+
+    // Путь без учёта регистра; префикс устройства ("disc0:", "umd0:") и
+    // ведущие '/' отбрасываются. nullptr - нет такого файла или каталога
+    const Entry* Find(std::string_view path) const;
+
+    // Читает до size байт файла с позиции offset; возвращает прочитанное
+    // или -1 при ошибке устройства
+    ptrdiff_t Read(const Entry& entry, uint64_t offset, void* out, size_t size) const;
+
+    size_t GetEntryCount() const { return entries_.size(); }
+
+    // Приводит путь к виду ключа индекса
+    static std::string NormalizePath(std::string_view path);
+
+private:
+    bool ReadDirectory(const std::string& prefix, uint32_t sector, uint32_t size,
+                       std::vector<Entry>& pending);
+
+    std::unique_ptr<BlockDevice> device_;
+    std::vector<Entry> entries_;    // по возрастанию path
+};
+
+}  // namespace loader
+}  // namespace ppsspp
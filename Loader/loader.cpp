@@ -1,15 +1,19 @@
 // Loader/loader.cpp
 
 #include "loader.h"
+#include "mapped_file.h"
+#include "iso_filesystem.h"
+#include "relocation.h"
+#include "segment_copy.h"
+#include "../syscall/nid_table.h"
 
-#include <fstream>
 #include <vector>
 #include <string>
 #include <cstring>
 #include <iostream>
-#include <filesystem>
 #include <cstdint>
 #include <cstddef>
+#include <algorithm>
 
 namespace ppsspp {
 namespace loader {
@@ -50,58 +54,152 @@ struct Elf32_Phdr {
     uint32_t p_align;
 };
 
+struct Elf32_Shdr {
+    uint32_t sh_name;
+    uint32_t sh_type;
+    uint32_t sh_flags;
+    uint32_t sh_addr;
+    uint32_t sh_offset;
+    uint32_t sh_size;
+    uint32_t sh_link;
+    uint32_t sh_info;
+    uint32_t sh_addralign;
+    uint32_t sh_entsize;
+};
+
+namespace {
+
+constexpr uint16_t ET_SCE_PRX = 0xFFA0;
+constexpr uint32_t PT_LOAD = 1;
+constexpr uint32_t PT_PSP_REL = 0x700000A0;
+constexpr uint32_t PT_PSP_REL2 = 0x700000A1;    // сжатый формат, такие модули отклоняются
+constexpr uint32_t SHT_PSP_REL = 0x700000A0;
+
+// Структуры модуля PSP в памяти гостя (адреса уже перемещены)
+struct SceModuleInfo {
+    uint16_t attribute;
+    uint8_t version[2];
+    char name[28];
+    uint32_t gp;
+    uint32_t libent;
+    uint32_t libentend;
+    uint32_t libstub;
+    uint32_t libstubend;
+};
+
+struct SceLibEntry {
+    uint32_t name;
+    uint16_t version;
+    uint16_t attribute;
+    uint8_t size;           // в словах
+    uint8_t numVars;
+    uint16_t numFuncs;
+    uint32_t entryTable;    // NID функций, NID переменных, затем их адреса
+};
+
+struct SceLibStub {
+    uint32_t name;
+    uint16_t version;
+    uint16_t flags;
+    uint8_t size;           // в словах
+    uint8_t numVars;
+    uint16_t numFuncs;
+    uint32_t nidData;
+    uint32_t firstSymAddr;  // заглушки по 8 байт
+};
+
+// Заглушки импорта
+constexpr uint32_t MIPS_JR_RA = 0x03E00008;
+constexpr uint32_t MIPS_NOP = 0x00000000;
+constexpr uint32_t MIPS_LUI_V0_KERNEL_ERROR = 0x3C028002;   // v0 = 0x80020000
+
+constexpr uint32_t MipsSyscall(uint32_t code) { return (code << 6) | 0x0C; }
+constexpr uint32_t MipsJump(uint32_t target) { return 0x08000000 | ((target >> 2) & 0x03FFFFFF); }
+
+template <typename T>
+T ReadStruct(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
 Loader::Loader(core::Memory& memory) : memory_(memory) {}
 
 bool Loader::LoadPBP(const std::string& path, uint32_t& outEntry) {
-    std::vector<uint8_t> fileData;
-    if (!LoadFileToMemory(path, fileData)) {
+    // PBP отображается в память, заголовки разбираются на месте
+    MappedFile file(path);
+    if (!file.IsValid()) {
         std::cerr << "Failed to read PBP file: " << path << std::endl;
         return false;
     }
 
-    std::vector<uint8_t> elf;
-    std::string titleID;
+    const uint8_t* elf = nullptr;
+    size_t elfSize = 0;
+    ParamSfo sfo;
 
-    if (!ExtractFromPBP(fileData.data(), fileData.size(), elf, titleID)) {
+    if (!ExtractFromPBP(file.GetData(), file.GetSize(), elf, elfSize, sfo)) {
         std::cerr << "Invalid PBP format." << std::endl;
         return false;
     }
 
-    std::filesystem::create_directories("saves");
-    std::ofstream meta("saves/" + titleID + ".meta.txt");
-    if (meta.is_open()) {
-        meta << "TitleID=" << titleID << "\n";
-        meta.close();
+    std::cout << "Loading " << sfo.GetString("DISC_ID", "(no disc id)") << ": "
+              << sfo.GetString("TITLE") << std::endl;
+
+    return LoadELF(elf, elfSize, outEntry);
+}
+
+bool Loader::LoadUMD(const IsoFileSystem& umd, uint32_t& outEntry) {
+    // BOOT.BIN - незашифрованная копия EBOOT.BIN; на части дисков она пустая
+    static const char* const BOOT_PATHS[] = {
+        "PSP_GAME/SYSDIR/BOOT.BIN",
+        "PSP_GAME/SYSDIR/EBOOT.BIN",
+    };
+
+    for (const char* bootPath : BOOT_PATHS) {
+        const IsoFileSystem::Entry* entry = umd.Find(bootPath);
+        if (!entry || entry->directory || entry->size < 4) continue;
+
+        std::vector<uint8_t> elf(entry->size);
+        if (umd.Read(*entry, 0, elf.data(), elf.size()) != static_cast<ptrdiff_t>(elf.size())) {
+            std::cerr << "Failed to read " << bootPath << " from UMD." << std::endl;
+            return false;
+        }
+        if (std::memcmp(elf.data(), "\x7F" "ELF", 4) != 0) {
+            std::cerr << bootPath << " is not a plain ELF (encrypted?), skipping." << std::endl;
+            continue;
+        }
+        return LoadELF(elf.data(), elf.size(), outEntry);
     }
 
-    return LoadELF(elf.data(), elf.size(), outEntry);
+    std::cerr << "No bootable executable on UMD." << std::endl;
+    return false;
 }
 
 bool Loader::ExtractFromPBP(const uint8_t* pbp, size_t size,
-                            std::vector<uint8_t>& outELF,
-                            std::string& outTitleID) {
+                            const uint8_t*& outELF, size_t& outELFSize,
+                            ParamSfo& outSfo) {
     if (size < sizeof(PBPHeader)) return false;
 
     const PBPHeader* hdr = reinterpret_cast<const PBPHeader*>(pbp);
     if (std::memcmp(hdr->magic, "\0PBP", 4) != 0) return false;
 
-    uint32_t elfStart   = hdr->offsets[0];
-    uint32_t paramStart = hdr->offsets[4];
-
-    uint32_t elfEnd = (hdr->offsets[1] < size) ? hdr->offsets[1] : (uint32_t)size;
-    if (elfEnd > size || elfStart >= elfEnd) return false;
+    // Секции: PARAM.SFO, ICON0, ICON1, PIC0, PIC1, SND0, DATA.PSP, DATA.PSAR;
+    // каждая заканчивается там, где начинается следующая
+    uint32_t paramStart = hdr->offsets[0];
+    uint32_t paramEnd   = std::min<uint32_t>(hdr->offsets[1], (uint32_t)size);
+    uint32_t elfStart   = hdr->offsets[6];
+    uint32_t elfEnd     = std::min<uint32_t>(hdr->offsets[7], (uint32_t)size);
+    if (elfStart >= elfEnd) elfEnd = (uint32_t)size;
+    if (elfStart >= elfEnd) return false;
 
-    outELF.assign(pbp + elfStart, pbp + elfEnd);
+    outELF = pbp + elfStart;
+    outELFSize = elfEnd - elfStart;
 
-    // Read TitleID from PARAM.SFO
-    if (paramStart + 512 <= size) {
-        const char* param = reinterpret_cast<const char*>(pbp + paramStart);
-        for (size_t i = 0; i + 8 + 9 <= 512; ++i) {
-            if (std::memcmp(param + i, "TITLE_ID", 8) == 0) {
-                outTitleID.assign(param + i + 8, 9);
-                break;
-            }
-        }
+    // PARAM.SFO не обязателен для запуска
+    if (paramStart >= paramEnd || !outSfo.Parse(pbp + paramStart, paramEnd - paramStart)) {
+        std::cerr << "PBP has no valid PARAM.SFO." << std::endl;
     }
 
     return true;
@@ -110,36 +208,200 @@ bool Loader::ExtractFromPBP(const uint8_t* pbp, size_t size,
 bool Loader::LoadELF(const uint8_t* data, size_t size, uint32_t& outEntry) {
     if (size < sizeof(Elf32_Ehdr)) return false;
 
-    const Elf32_Ehdr* hdr = reinterpret_cast<const Elf32_Ehdr*>(data);
-    outEntry = hdr->e_entry;
+    // data указывает в отображение файла и может быть не выровнен:
+    // заголовки копируются, а не читаются по указателю
+    const Elf32_Ehdr hdr = ReadStruct<Elf32_Ehdr>(data);
 
-    const Elf32_Phdr* phdrs = reinterpret_cast<const Elf32_Phdr*>(data + hdr->e_phoff);
-    if ((hdr->e_phoff + hdr->e_phnum * sizeof(Elf32_Phdr)) > size)
+    if ((uint64_t(hdr.e_phoff) + hdr.e_phnum * sizeof(Elf32_Phdr)) > size)
         return false;
 
-    for (uint16_t i = 0; i < hdr->e_phnum; ++i) {
+    std::vector<Elf32_Phdr> phdrs(hdr.e_phnum);
+    for (uint16_t i = 0; i < hdr.e_phnum; ++i) {
+        phdrs[i] = ReadStruct<Elf32_Phdr>(data + hdr.e_phoff + i * sizeof(Elf32_Phdr));
+    }
+    // Секции необязательны: у многих модулей их таблица вырезана
+    std::vector<Elf32_Shdr> shdrs;
+    if (hdr.e_shnum && uint64_t(hdr.e_shoff) + hdr.e_shnum * sizeof(Elf32_Shdr) <= size) {
+        shdrs.resize(hdr.e_shnum);
+        for (uint16_t i = 0; i < hdr.e_shnum; ++i) {
+            shdrs[i] = ReadStruct<Elf32_Shdr>(data + hdr.e_shoff + i * sizeof(Elf32_Shdr));
+        }
+    }
+
+    // PRX и модули с таблицами перемещений грузятся по PRX_LOAD_BASE
+    const bool hasRelSections =
+        std::any_of(shdrs.begin(), shdrs.end(), [](const Elf32_Shdr& sh) {
+            return sh.sh_type == SHT_PSP_REL;
+        });
+    const bool hasRel2 =
+        std::any_of(phdrs.begin(), phdrs.end(), [](const Elf32_Phdr& ph) {
+            return ph.p_type == PT_PSP_REL2;
+        });
+    // Без перемещений модуль по PRX_LOAD_BASE неработоспособен: не грузим
+    if (hasRel2 && !hasRelSections) {
+        std::cerr << "PT_PSP_REL2 relocations are not supported, module not loaded." << std::endl;
+        return false;
+    }
+    const bool hasRelocs = hasRelSections ||
+        std::any_of(phdrs.begin(), phdrs.end(), [](const Elf32_Phdr& ph) {
+            return ph.p_type == PT_PSP_REL;
+        });
+    const bool relocatable = hdr.e_type == ET_SCE_PRX || hasRelocs;
+    const uint32_t base = relocatable ? PRX_LOAD_BASE : 0;
+
+    // Учёт памяти (границы, грязные страницы, копии при записи, кэш кода)
+    // ведётся здесь, в одном потоке; сами байты копирует CopySegments
+    std::vector<uint32_t> segmentAddrs(phdrs.size());
+    std::vector<SegmentCopy> copies;
+    uint32_t imageStart = UINT32_MAX;
+    uint32_t imageEnd = 0;
+    for (size_t i = 0; i < phdrs.size(); ++i) {
         const Elf32_Phdr& ph = phdrs[i];
-        if (ph.p_type != 1) continue;  // PT_LOAD
+        segmentAddrs[i] = base + ph.p_vaddr;
+        if (ph.p_type != PT_LOAD) continue;
 
-        if ((ph.p_offset + ph.p_filesz) > size) return false;
+        if ((uint64_t(ph.p_offset) + ph.p_filesz) > size) return false;
+        if (ph.p_memsz < ph.p_filesz) return false;
+        if (ph.p_memsz == 0) continue;
+
+        const std::span<uint8_t> dst = memory_.GetRange(segmentAddrs[i], ph.p_memsz);
+        copies.push_back({ dst.data(), data + ph.p_offset, ph.p_filesz });
+        copies.push_back({ dst.data() + ph.p_filesz, nullptr, ph.p_memsz - ph.p_filesz });
+        imageStart = std::min(imageStart, segmentAddrs[i]);
+        imageEnd = std::max(imageEnd, segmentAddrs[i] + ph.p_memsz);
+    }
+    CopySegments(copies);
+    outEntry = base + hdr.e_entry;
+    if (imageStart >= imageEnd) return true;
 
-        memory_.WriteBytes(ph.p_vaddr, data + ph.p_offset, ph.p_filesz);
-        memory_.Memset(ph.p_vaddr + ph.p_filesz, 0, ph.p_memsz - ph.p_filesz);
+    if (hasRelocs) {
+        Relocate(data, size, phdrs, shdrs, segmentAddrs, imageStart, imageEnd);
     }
 
+    const uint32_t moduleInfo = FindModuleInfo(data, size, hdr, phdrs, shdrs, segmentAddrs);
+    if (moduleInfo) {
+        LinkModule(moduleInfo);
+    } else {
+        std::cerr << "Module info not found, imports left unresolved." << std::endl;
+    }
     return true;
 }
 
-bool Loader::LoadFileToMemory(const std::string& path, std::vector<uint8_t>& out) {
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file) return false;
+void Loader::Relocate(const uint8_t* data, size_t size,
+                      const std::vector<Elf32_Phdr>& phdrs,
+                      const std::vector<Elf32_Shdr>& shdrs,
+                      const std::vector<uint32_t>& segmentAddrs,
+                      uint32_t imageStart, uint32_t imageEnd) {
+    // Образ модуля проверяется и берётся один раз; перемещения идут по указателю
+    const RelocTarget target = {
+        memory_.GetRange(imageStart, imageEnd - imageStart),
+        imageStart, segmentAddrs.data(), segmentAddrs.size()
+    };
+
+    RelocStats total;
+    auto apply = [&](uint32_t offset, uint32_t bytes) {
+        if (uint64_t(offset) + bytes > size) return;
+        const RelocStats stats = ApplyRelocations(target, data + offset, bytes / sizeof(Elf32_Rel));
+        total.applied += stats.applied;
+        total.skipped += stats.skipped;
+    };
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    bool fromSections = false;
+    for (const Elf32_Shdr& sh : shdrs) {
+        if (sh.sh_type != SHT_PSP_REL) continue;
+        apply(sh.sh_offset, sh.sh_size);
+        fromSections = true;
+    }
+    if (!fromSections) {
+        for (const Elf32_Phdr& ph : phdrs) {
+            if (ph.p_type == PT_PSP_REL) apply(ph.p_offset, ph.p_filesz);
+        }
+    }
+
+    if (total.skipped) {
+        std::cerr << "Relocations: " << total.applied << " applied, "
+                  << total.skipped << " skipped." << std::endl;
+    }
+}
+
+uint32_t Loader::FindModuleInfo(const uint8_t* data, size_t size, const Elf32_Ehdr& hdr,
+                                const std::vector<Elf32_Phdr>& phdrs,
+                                const std::vector<Elf32_Shdr>& shdrs,
+                                const std::vector<uint32_t>& segmentAddrs) const {
+    // По имени секции, если таблица строк секций на месте
+    if (hdr.e_shstrndx < shdrs.size()) {
+        const Elf32_Shdr& strtab = shdrs[hdr.e_shstrndx];
+        static constexpr char NAME[] = ".rodata.sceModuleInfo";
+        for (const Elf32_Shdr& sh : shdrs) {
+            const uint64_t nameOffset = uint64_t(strtab.sh_offset) + sh.sh_name;
+            if (sh.sh_name + sizeof(NAME) > strtab.sh_size || nameOffset + sizeof(NAME) > size) continue;
+            if (std::memcmp(data + nameOffset, NAME, sizeof(NAME)) == 0) {
+                const uint32_t base = segmentAddrs.empty() ? 0 : segmentAddrs[0] - phdrs[0].p_vaddr;
+                return base + sh.sh_addr;
+            }
+        }
+    }
+    // У PRX p_paddr первого сегмента - смещение SceModuleInfo в файле
+    if (hdr.e_type == ET_SCE_PRX && !phdrs.empty()) {
+        const uint32_t fileOffset = phdrs[0].p_paddr & 0x7FFFFFFF;
+        if (fileOffset >= phdrs[0].p_offset) {
+            return segmentAddrs[0] + (fileOffset - phdrs[0].p_offset);
+        }
+    }
+    return 0;
+}
+
+void Loader::LinkModule(uint32_t moduleInfoAddr) {
+    SceModuleInfo info;
+    memory_.ReadBytes(moduleInfoAddr, &info, sizeof(info));
+
+    // Экспорты регистрируются первыми, чтобы следующие модули их видели
+    for (uint32_t addr = info.libent; addr + sizeof(SceLibEntry) <= info.libentend;) {
+        SceLibEntry entry;
+        memory_.ReadBytes(addr, &entry, sizeof(entry));
+        if (entry.size == 0) break;
+        const uint32_t total = entry.numFuncs + entry.numVars;
+        for (uint32_t f = 0; f < entry.numFuncs; ++f) {
+            const uint32_t nid = memory_.Read32(entry.entryTable + f * 4);
+            exports_[nid] = memory_.Read32(entry.entryTable + (total + f) * 4);
+        }
+        addr += entry.size * 4;
+    }
+
+    uint32_t hle = 0, linked = 0, unresolved = 0;
+    for (uint32_t addr = info.libstub; addr + sizeof(SceLibStub) <= info.libstubend;) {
+        SceLibStub stub;
+        memory_.ReadBytes(addr, &stub, sizeof(stub));
+        if (stub.size == 0) break;
+
+        for (uint32_t f = 0; f < stub.numFuncs; ++f) {
+            const uint32_t nid = memory_.Read32(stub.nidData + f * 4);
+            const uint32_t stubAddr = stub.firstSymAddr + f * 8;
+            uint32_t code = 0;
+
+            if (auto it = exports_.find(nid); it != exports_.end()) {
+                memory_.Write32(stubAddr, MipsJump(it->second));
+                memory_.Write32(stubAddr + 4, MIPS_NOP);
+                ++linked;
+            } else if (syscall::LookupNid(nid, code)) {
+                memory_.Write32(stubAddr, MIPS_JR_RA);
+                memory_.Write32(stubAddr + 4, MipsSyscall(code));
+                ++hle;
+            } else {
+                // Нереализованная функция возвращает ошибку ядра
+                memory_.Write32(stubAddr, MIPS_JR_RA);
+                memory_.Write32(stubAddr + 4, MIPS_LUI_V0_KERNEL_ERROR);
+                std::cerr << "Unresolved import " << (stub.name ? memory_.ReadCString(stub.name, 64) : "?")
+                          << " NID 0x" << std::hex << nid << std::dec << std::endl;
+                ++unresolved;
+            }
+        }
+        addr += stub.size * 4;
+    }
 
-    if (size <= 0) return false;
-    out.resize(static_cast<size_t>(size));
-    return file.read(reinterpret_cast<char*>(out.data()), size).good();
+    std::cout << "Module " << std::string(info.name, strnlen(info.name, sizeof(info.name)))
+              << ": " << hle << " HLE imports, " << linked << " linked, "
+              << unresolved << " unresolved." << std::endl;
 }
 
 }  // namespace loader
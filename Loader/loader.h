@@ -3,34 +3,64 @@
 #pragma once
 
 #include "../core/memory.h"
+#include "param_sfo.h"
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <cstdint>
 
 namespace ppsspp {
 namespace loader {
 
+struct Elf32_Ehdr;
+struct Elf32_Phdr;
+struct Elf32_Shdr;
+class IsoFileSystem;
+
 class Loader {
 public:
+    // Начало пользовательской памяти: сюда грузятся перемещаемые модули
+    static constexpr uint32_t PRX_LOAD_BASE = 0x08804000;
+
     explicit Loader(core::Memory& memory);
 
     // Загружает PBP-файл, возвращает точку входа
     bool LoadPBP(const std::string& path, uint32_t& outEntry);
 
+    // Загружает исполняемый файл смонтированного UMD, возвращает точку входа
+    bool LoadUMD(const IsoFileSystem& umd, uint32_t& outEntry);
+
+    // Находит ELF (DATA.PSP) внутри PBP без копирования и разбирает PARAM.SFO
+    static bool ExtractFromPBP(const uint8_t* pbp, size_t size,
+                               const uint8_t*& outELF, size_t& outELFSize,
+                               ParamSfo& outSfo);
+
 private:
-    // Извлекает ELF и TitleID из PBP
-    bool ExtractFromPBP(const uint8_t* pbp, size_t size,
-                       std::vector<uint8_t>& outELF,
-                       std::string& outTitleID);
 
-    // Загружает ELF в память
+    // Загружает ELF или PRX в память: сегменты копируются прямо из data,
+    // затем применяются перемещения и связываются импорты
     bool LoadELF(const uint8_t* data, size_t size, uint32_t& outEntry);
 
-    // Загружает файл в память
-    bool LoadFileToMemory(const std::string& path, std::vector<uint8_t>& out);
+    // Перемещения из секций SHT_PSP_REL, а если их нет - из сегментов PT_PSP_REL
+    void Relocate(const uint8_t* data, size_t size,
+                  const std::vector<Elf32_Phdr>& phdrs,
+                  const std::vector<Elf32_Shdr>& shdrs,
+                  const std::vector<uint32_t>& segmentAddrs,
+                  uint32_t imageStart, uint32_t imageEnd);
+
+    // Адрес SceModuleInfo в памяти гостя; 0 - не найден
+    uint32_t FindModuleInfo(const uint8_t* data, size_t size, const Elf32_Ehdr& hdr,
+                            const std::vector<Elf32_Phdr>& phdrs,
+                            const std::vector<Elf32_Shdr>& shdrs,
+                            const std::vector<uint32_t>& segmentAddrs) const;
+
+    // Регистрирует экспорты модуля и патчит заглушки его импортов
+    void LinkModule(uint32_t moduleInfoAddr);
 
     core::Memory& memory_;
+    // NID -> адрес функции, экспортированной уже загруженным модулем
+    std::unordered_map<uint32_t, uint32_t> exports_;
 };
 
 }  // namespace loader
@@ -0,0 +1,97 @@
+// Loader/mapped_file.cpp
+
+#include "mapped_file.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ppsspp {
+namespace loader {
+
+MappedFile::MappedFile(const std::string& path) {
+    if (!Map(path)) {
+        Read(path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (!mapping_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping_);
+    CloseHandle(static_cast<HANDLE>(mappingHandle_));
+#else
+    munmap(mapping_, size_);
+#endif
+}
+
+bool MappedFile::Map(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+    // Отображение держит файл открытым само
+    HANDLE handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!handle) return false;
+
+    void* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(handle);
+        return false;
+    }
+    mappingHandle_ = handle;
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+    mapping_ = view;
+    data_ = static_cast<const uint8_t*>(view);
+    return true;
+}
+
+bool MappedFile::Read(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    if (size <= 0) return false;
+    buffer_.resize(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(buffer_.data()), size)) {
+        buffer_.clear();
+        return false;
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+}
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,43 @@
+// Loader/mapped_file.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ppsspp {
+namespace loader {
+
+// Файл, отображённый в память только для чтения. Если отобразить не удалось,
+// файл читается в буфер целиком - для вызывающего разницы нет.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    // Запрещаем копирование
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsValid() const { return data_ != nullptr; }
+    bool IsMapped() const { return mapping_ != nullptr; }
+    const uint8_t* GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+
+private:
+    bool Map(const std::string& path);
+    bool Read(const std::string& path);
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    void* mapping_ = nullptr;       // начало отображения
+#ifdef _WIN32
+    void* mappingHandle_ = nullptr;
+#endif
+    std::vector<uint8_t> buffer_;   // запасной путь без отображения
+};
+
+}  // namespace loader
+}  // namespace ppsspp
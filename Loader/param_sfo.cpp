@@ -0,0 +1,108 @@
+// Loader/param_sfo.cpp
+
+#include "param_sfo.h"
+
+#include <cstring>
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+#pragma pack(push, 1)
+struct SfoHeader {
+    char magic[4];              // "\0PSF"
+    uint32_t version;
+    uint32_t keyTableOffset;
+    uint32_t dataTableOffset;
+    uint32_t numEntries;
+};
+
+struct SfoEntry {
+    uint16_t keyOffset;         // от начала таблицы ключей
+    uint16_t format;
+    uint32_t length;            // использовано байт
+    uint32_t maxLength;         // зарезервировано байт
+    uint32_t dataOffset;        // от начала таблицы данных
+};
+#pragma pack(pop)
+
+constexpr uint16_t FORMAT_UTF8_SPECIAL = 0x0004;   // без завершающего нуля
+constexpr uint16_t FORMAT_UTF8 = 0x0204;
+constexpr uint16_t FORMAT_INT32 = 0x0404;
+
+}  // namespace
+
+bool ParamSfo::Parse(const uint8_t* data, size_t size) {
+    values_.clear();
+    if (size < sizeof(SfoHeader)) return false;
+
+    SfoHeader hdr;
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (std::memcmp(hdr.magic, "\0PSF", 4) != 0) return false;
+
+    const uint64_t entriesEnd = sizeof(SfoHeader) + uint64_t(hdr.numEntries) * sizeof(SfoEntry);
+    if (entriesEnd > size || hdr.keyTableOffset > size || hdr.dataTableOffset > size) return false;
+
+    const char* keys = reinterpret_cast<const char*>(data + hdr.keyTableOffset);
+    const size_t keysSize = size - hdr.keyTableOffset;
+
+    for (uint32_t i = 0; i < hdr.numEntries; ++i) {
+        SfoEntry entry;
+        std::memcpy(&entry, data + sizeof(SfoHeader) + i * sizeof(SfoEntry), sizeof(entry));
+
+        if (entry.keyOffset >= keysSize) return false;
+        const char* key = keys + entry.keyOffset;
+        const void* keyEnd = std::memchr(key, 0, keysSize - entry.keyOffset);
+        if (!keyEnd) return false;
+
+        const uint64_t valueStart = uint64_t(hdr.dataTableOffset) + entry.dataOffset;
+        if (valueStart + entry.length > size) return false;
+        const uint8_t* value = data + valueStart;
+
+        Value parsed;
+        switch (entry.format) {
+        case FORMAT_INT32:
+            if (entry.length < 4) return false;
+            parsed.isInt = true;
+            std::memcpy(&parsed.number, value, 4);
+            break;
+        case FORMAT_UTF8:
+        case FORMAT_UTF8_SPECIAL: {
+            // Строка обрезается по первому нулю: length учитывает терминатор
+            const char* text = reinterpret_cast<const char*>(value);
+            const void* nul = std::memchr(text, 0, entry.length);
+            parsed.text.assign(text, nul ? static_cast<const char*>(nul) - text : entry.length);
+            break;
+        }
+        default:
+            continue;   // неизвестный формат - пропускаем ключ
+        }
+        values_[std::string(key, static_cast<const char*>(keyEnd) - key)] = std::move(parsed);
+    }
+    return true;
+}
+
+const ParamSfo::Value* ParamSfo::Find(std::string_view key) const {
+    auto it = values_.find(std::string(key));
+    return it != values_.end() ? &it->second : nullptr;
+}
+
+bool ParamSfo::Has(std::string_view key) const {
+    return Find(key) != nullptr;
+}
+
+std::string ParamSfo::GetString(std::string_view key, const std::string& fallback) const {
+    const Value* value = Find(key);
+    return (value && !value->isInt) ? value->text : fallback;
+}
+
+bool ParamSfo::GetInt(std::string_view key, uint32_t& out) const {
+    const Value* value = Find(key);
+    if (!value || !value->isInt) return false;
+    out = value->number;
+    return true;
+}
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,43 @@
+// Loader/param_sfo.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ppsspp {
+namespace loader {
+
+// PARAM.SFO: таблица ключ -> значение (строка UTF-8 или 32-битное целое)
+class ParamSfo {
+public:
+    // Разбирает образ SFO; false - неверный заголовок или таблица за пределами size
+    bool Parse(const uint8_t* data, size_t size);
+
+    bool Has(std::string_view key) const;
+
+    // Строковое значение; для целого или отсутствующего ключа - fallback
+    std::string GetString(std::string_view key, const std::string& fallback = "") const;
+
+    // Целое значение; false - ключа нет или он строковый
+    bool GetInt(std::string_view key, uint32_t& out) const;
+
+    size_t GetCount() const { return values_.size(); }
+
+private:
+    struct Value {
+        bool isInt = false;
+        uint32_t number = 0;
+        std::string text;
+    };
+
+    const Value* Find(std::string_view key) const;
+
+    std::unordered_map<std::string, Value> values_;
+};
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,106 @@
+// Loader/relocation.cpp
+
+#include "relocation.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+struct PendingHi16 {
+    uint8_t* word;
+    uint32_t relocateTo;
+};
+
+uint32_t ReadWord(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void WriteWord(uint8_t* p, uint32_t value) {
+    std::memcpy(p, &value, sizeof(value));
+}
+
+// HI16 с учётом знака младшей половины: lui + addiu дают full
+void PatchHi16(const PendingHi16& hi, int16_t lo) {
+    const uint32_t op = ReadWord(hi.word);
+    const uint32_t full = (op << 16) + static_cast<int32_t>(lo) + hi.relocateTo;
+    WriteWord(hi.word, (op & 0xFFFF0000) | (((full + 0x8000) >> 16) & 0xFFFF));
+}
+
+}  // namespace
+
+RelocStats ApplyRelocations(const RelocTarget& target, const uint8_t* rel, size_t count) {
+    RelocStats stats;
+    std::vector<PendingHi16> pending;
+
+    for (size_t i = 0; i < count; ++i) {
+        Elf32_Rel entry;
+        std::memcpy(&entry, rel + i * sizeof(Elf32_Rel), sizeof(entry));
+
+        const uint8_t type = entry.r_info & 0xFF;
+        const size_t offsetBase = (entry.r_info >> 8) & 0xFF;
+        const size_t addrBase = (entry.r_info >> 16) & 0xFF;
+        if (type == R_MIPS_NONE) continue;
+        if (offsetBase >= target.numSegments || addrBase >= target.numSegments) {
+            ++stats.skipped;
+            continue;
+        }
+
+        const uint32_t addr = target.segmentAddrs[offsetBase] + entry.r_offset;
+        const uint32_t relocateTo = target.segmentAddrs[addrBase];
+        const uint64_t offset = uint64_t(addr) - target.imageAddr;
+        if (addr < target.imageAddr || offset + 4 > target.image.size()) {
+            ++stats.skipped;
+            continue;
+        }
+
+        uint8_t* word = target.image.data() + offset;
+        const uint32_t op = ReadWord(word);
+        switch (type) {
+        case R_MIPS_16:
+            WriteWord(word, (op & 0xFFFF0000) | ((op + relocateTo) & 0xFFFF));
+            break;
+        case R_MIPS_32:
+            WriteWord(word, op + relocateTo);
+            break;
+        case R_MIPS_26:
+        case R_MIPS_X_J26:
+        case R_MIPS_X_JAL26:
+            WriteWord(word, (op & 0xFC000000) | ((op + (relocateTo >> 2)) & 0x03FFFFFF));
+            break;
+        case R_MIPS_HI16:
+        case R_MIPS_X_HI16:
+            // Значение зависит от парного LO16 - откладываем
+            pending.push_back({ word, relocateTo });
+            break;
+        case R_MIPS_LO16:
+            for (const PendingHi16& hi : pending) {
+                PatchHi16(hi, static_cast<int16_t>(op & 0xFFFF));
+            }
+            pending.clear();
+            WriteWord(word, (op & 0xFFFF0000) | ((op + relocateTo) & 0xFFFF));
+            break;
+        case R_MIPS_GPREL16:
+            // gp задаётся модулем и перемещается вместе с ним
+            break;
+        default:
+            ++stats.skipped;
+            continue;
+        }
+        ++stats.applied;
+    }
+
+    // HI16 без пары: младшая половина считается нулевой
+    for (const PendingHi16& hi : pending) {
+        PatchHi16(hi, 0);
+    }
+    return stats;
+}
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,53 @@
+// Loader/relocation.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+namespace ppsspp {
+namespace loader {
+
+// Типы перемещений MIPS и расширения PSP
+enum RelocType : uint8_t {
+    R_MIPS_NONE = 0,
+    R_MIPS_16 = 1,
+    R_MIPS_32 = 2,
+    R_MIPS_26 = 4,
+    R_MIPS_HI16 = 5,
+    R_MIPS_LO16 = 6,
+    R_MIPS_GPREL16 = 7,
+    R_MIPS_X_HI16 = 13,     // HI16, парный следующему LO16
+    R_MIPS_X_J26 = 14,      // j с перемещаемой целью
+    R_MIPS_X_JAL26 = 15,    // jal с перемещаемой целью
+};
+
+// Запись таблицы SHT_PSP_REL / PT_PSP_REL. r_info: биты 0-7 - тип,
+// 8-15 - сегмент, относительно которого задан r_offset,
+// 16-23 - сегмент, на адрес которого перемещается значение
+struct Elf32_Rel {
+    uint32_t r_offset;
+    uint32_t r_info;
+};
+
+struct RelocStats {
+    uint32_t applied = 0;
+    uint32_t skipped = 0;   // неизвестный тип или адрес вне образа
+};
+
+// Образ модуля в памяти гостя и адреса его сегментов после загрузки
+struct RelocTarget {
+    std::span<uint8_t> image;
+    uint32_t imageAddr;
+    const uint32_t* segmentAddrs;
+    size_t numSegments;
+};
+
+// Применяет count записей из rel (данные файла, выравнивание не требуется).
+// Один проход в порядке таблицы: линкер выдаёт её отсортированной, а HI16
+// ждут ближайшего LO16 в коротком списке.
+RelocStats ApplyRelocations(const RelocTarget& target, const uint8_t* rel, size_t count);
+
+}  // namespace loader
+}  // namespace ppsspp
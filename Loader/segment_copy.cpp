@@ -0,0 +1,177 @@
+// Loader/segment_copy.cpp
+
+#include "segment_copy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PPSSPP_LOADER_STREAM 1
+#endif
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ppsspp {
+namespace loader {
+
+namespace {
+
+constexpr size_t CHUNK_SIZE = 256 * 1024;
+// Меньше этого объёма потоки не окупаются
+constexpr size_t PARALLEL_THRESHOLD = 1024 * 1024;
+// Сегменты больше кэша L2 пишутся в обход кэша
+constexpr size_t STREAM_THRESHOLD = 1024 * 1024;
+constexpr unsigned MAX_THREADS = 8;
+// На сколько кусков вперёд просить систему подкачать источник
+constexpr size_t PREFETCH_CHUNKS = 4;
+
+struct Chunk {
+    uint8_t* dst;
+    const uint8_t* src;
+    size_t size;
+    bool stream;
+};
+
+void Prefetch(const uint8_t* data, size_t size) {
+#ifndef _WIN32
+    static const uintptr_t pageMask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~pageMask;
+    const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+    // Только подсказка: для памяти не из файла вызов ничего не делает
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+#else
+    // Отображение Windows подкачивается по обращению; подсказка не нужна
+    (void)data;
+    (void)size;
+#endif
+}
+
+#ifdef PPSSPP_LOADER_STREAM
+// Выравниваем приёмник по 16 байт обычной записью, середину пишем movntdq
+void StreamCopy(uint8_t* dst, const uint8_t* src, size_t size) {
+    const size_t head = std::min(size, (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15);
+    std::memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, dst += 64, src += 64) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+    }
+    std::memcpy(dst, src, size);
+}
+
+void StreamZero(uint8_t* dst, size_t size) {
+    const size_t head = std::min(size, (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15);
+    std::memset(dst, 0, head);
+    dst += head;
+    size -= head;
+
+    const __m128i zero = _mm_setzero_si128();
+    for (; size >= 64; size -= 64, dst += 64) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), zero);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), zero);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), zero);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), zero);
+    }
+    std::memset(dst, 0, size);
+}
+#endif
+
+void RunChunk(const Chunk& chunk) {
+#ifdef PPSSPP_LOADER_STREAM
+    if (chunk.stream) {
+        if (chunk.src) {
+            StreamCopy(chunk.dst, chunk.src, chunk.size);
+        } else {
+            StreamZero(chunk.dst, chunk.size);
+        }
+        return;
+    }
+#endif
+    if (chunk.src) {
+        std::memcpy(chunk.dst, chunk.src, chunk.size);
+    } else {
+        std::memset(chunk.dst, 0, chunk.size);
+    }
+}
+
+}  // namespace
+
+void CopySegments(const std::vector<SegmentCopy>& segments) {
+    std::vector<Chunk> chunks;
+    size_t total = 0;
+    for (const SegmentCopy& segment : segments) {
+        const bool stream = segment.size >= STREAM_THRESHOLD;
+        for (size_t offset = 0; offset < segment.size; offset += CHUNK_SIZE) {
+            const size_t size = std::min(CHUNK_SIZE, segment.size - offset);
+            chunks.push_back({ segment.dst + offset,
+                               segment.src ? segment.src + offset : nullptr, size, stream });
+        }
+        total += segment.size;
+    }
+    if (chunks.empty()) return;
+
+    // Куски раздаются по порядку; взяв кусок i, поток просит подкачать
+    // источник куска i + PREFETCH_CHUNKS, пока сам копирует
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next++; i < chunks.size(); i = next++) {
+            const size_t ahead = i + PREFETCH_CHUNKS;
+            if (ahead < chunks.size() && chunks[ahead].src) {
+                Prefetch(chunks[ahead].src, chunks[ahead].size);
+            }
+            RunChunk(chunks[i]);
+        }
+#ifdef PPSSPP_LOADER_STREAM
+        // Потоковые записи должны стать видимы до того, как join отдаст память
+        _mm_sfence();
+#endif
+    };
+
+    // Перекрывающиеся сегменты должны писаться строго по порядку
+    std::vector<std::pair<uint8_t*, uint8_t*>> ranges;
+    for (const SegmentCopy& segment : segments) {
+        if (segment.size) ranges.emplace_back(segment.dst, segment.dst + segment.size);
+    }
+    std::sort(ranges.begin(), ranges.end());
+    bool overlap = false;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        overlap |= ranges[i].first < ranges[i - 1].second;
+    }
+
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned numThreads = (total < PARALLEL_THRESHOLD || overlap) ? 1 :
+        static_cast<unsigned>(std::min<size_t>({ hardware, MAX_THREADS, chunks.size() }));
+
+    for (size_t i = 0; i < std::min(PREFETCH_CHUNKS, chunks.size()); ++i) {
+        if (chunks[i].src) Prefetch(chunks[i].src, chunks[i].size);
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (unsigned t = 1; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace loader
+}  // namespace ppsspp
@@ -0,0 +1,27 @@
+// Loader/segment_copy.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace ppsspp {
+namespace loader {
+
+// Одна операция загрузки сегмента: копирование src -> dst или,
+// если src == nullptr, обнуление dst (BSS)
+struct SegmentCopy {
+    uint8_t* dst;
+    const uint8_t* src;
+    size_t size;
+};
+
+// Выполняет операции, разбивая их на куски между потоками. Большие сегменты
+// пишутся потоковыми (non-temporal) записями, чтобы не вытеснять кэш.
+// Источник, отображённый из файла, подкачивается заранее: чтение следующих
+// кусков с диска идёт одновременно с копированием текущих.
+void CopySegments(const std::vector<SegmentCopy>& segments);
+
+}  // namespace loader
+}  // namespace ppsspp
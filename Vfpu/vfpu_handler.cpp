@@ -9,24 +9,24 @@ namespace vfpu {
 
 void VFPUHandler::Execute(CPUState* st, const Decoded& d) {
     // Пример: VFPU MOV.s (опкод = 0x6C), fmt = 0b000000 (MOV)
-    if (d.opcode == 0x6C && d.fmt == 0x00) {
+    if (d.Opcode() == 0x6C && d.Fmt() == 0x00) {
         // MOV.s: vD = vS
-        float value = st->GetVFPU(d.rs, 0);
-        st->SetVFPU(d.rd, 0, value);
+        float value = st->GetVFPU(VfpuRegIndex(d.Rs()), VfpuLaneIndex(0));
+        st->SetVFPU(VfpuRegIndex(d.Rd()), VfpuLaneIndex(0), value);
         return;
     }
 
     // Пример: VFPU NEG.s
-    if (d.opcode == 0x6C && d.fmt == 0x01) {
-        float value = st->GetVFPU(d.rs, 0);
-        st->SetVFPU(d.rd, 0, -value);
+    if (d.Opcode() == 0x6C && d.Fmt() == 0x01) {
+        float value = st->GetVFPU(VfpuRegIndex(d.Rs()), VfpuLaneIndex(0));
+        st->SetVFPU(VfpuRegIndex(d.Rd()), VfpuLaneIndex(0), -value);
         return;
     }
 
     // Пример: VFPU ABS.s
-    if (d.opcode == 0x6C && d.fmt == 0x02) {
-        float value = st->GetVFPU(d.rs, 0);
-        st->SetVFPU(d.rd, 0, std::abs(value));
+    if (d.Opcode() == 0x6C && d.Fmt() == 0x02) {
+        float value = st->GetVFPU(VfpuRegIndex(d.Rs()), VfpuLaneIndex(0));
+        st->SetVFPU(VfpuRegIndex(d.Rd()), VfpuLaneIndex(0), std::abs(value));
         return;
     }
 
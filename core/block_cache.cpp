@@ -0,0 +1,189 @@
+// core/block_cache.cpp
+
+#include "block_cache.h"
+#include "memory.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace ppsspp {
+namespace core {
+
+BlockCache::BlockCache(Memory& memory)
+    : memory_(memory), decoder_(true) {
+    // Арена не перераспределяется, поэтому указатели на инструкции стабильны до Clear()
+    arena_.reserve(MAX_ARENA_INSTS);
+    ir_.reserve(MAX_ARENA_INSTS);
+    scratch_.reserve(MAX_BLOCK_INSTS + 1);
+    memory_.SetCodeWriteCallback([this](uint32_t addr, size_t size) {
+        InvalidateRange(addr, size);
+    });
+}
+
+BlockCache::~BlockCache() {
+    memory_.SetCodeWriteCallback(nullptr);
+    memory_.ClearCodePages();
+}
+
+const Block* BlockCache::Lookup(uint32_t pc) const {
+    auto it = blockMap_.find(pc);
+    return it != blockMap_.end() ? &blocks_[it->second] : nullptr;
+}
+
+const Block& BlockCache::GetOrCompile(uint32_t pc) {
+    LookupEntry& entry = lookupCache_[(pc >> 2) & (LOOKUP_CACHE_SIZE - 1)];
+    if (entry.pc == pc && blocks_[entry.index].valid) {
+        return blocks_[entry.index];
+    }
+
+    auto it = blockMap_.find(pc);
+    const Block& block = it != blockMap_.end() ? blocks_[it->second] : Compile(pc);
+    entry.pc = pc;
+    entry.index = static_cast<uint32_t>(&block - blocks_.data());
+    return block;
+}
+
+const Block& BlockCache::Compile(uint32_t pc) {
+    if (arena_.size() + MAX_BLOCK_INSTS + 1 > MAX_ARENA_INSTS) {
+        LogInfo("Block cache arena full, flushing");
+        Clear();
+    }
+
+    Block block;
+    block.startPC = pc;
+    block.firstInst = static_cast<uint32_t>(arena_.size());
+
+    scratch_.clear();
+    uint32_t decoded = 0;
+    auto fetch = [&](uint32_t n) -> const Decoded& {
+        if (n == decoded) {
+            // Слова читаются пачками; у границы RAM и на невыровненном адресе
+            // по одному через Read32, который и сообщит об ошибке
+            const uint32_t addr = pc + n * 4;
+            const size_t count = decoder_.DecodeRange(memory_, addr, DECODE_BATCH, &decoded_[n]);
+            if (count == 0) {
+                decoded_[n] = decoder_.Decode(memory_.Read32(addr));
+            }
+            decoded += count != 0 ? static_cast<uint32_t>(count) : 1;
+        }
+        return decoded_[n];
+    };
+
+    uint32_t addr = pc;
+    for (uint32_t n = 0; n < MAX_BLOCK_INSTS; ++n) {
+        const Decoded d = fetch(n);
+        scratch_.push_back(LowerToIR(addr, d));
+        addr += 4;
+
+        if (d.IsBranch()) {
+            // Delay slot всегда принадлежит блоку перехода
+            IRInst slot = LowerToIR(addr, fetch(n + 1));
+            slot.flags |= IR_DELAY_SLOT;
+            scratch_.push_back(slot);
+            addr += 4;
+            break;
+        }
+        // После syscall/break/eret PC может измениться вне блока
+        if (d.Flags() & IF_TERMINATOR) break;
+    }
+    decodedCount_ += scratch_.size();
+
+    // Анализ до оптимизации: удалённые записи не должны скрыть перенос состояния
+    block.idleLoop = IsIdleLoop(scratch_, pc);
+    if (block.idleLoop) {
+        ++idleLoopCount_;
+    }
+
+    if (optimizeIR_) {
+        OptimizeIR(scratch_, irStats_);
+    }
+    for (const IRInst& ir : scratch_) {
+        ir_.push_back(ir);
+        arena_.push_back(Interpreter::Lower(ir));
+    }
+
+    block.endPC = addr;
+    block.numInsts = static_cast<uint32_t>(arena_.size()) - block.firstInst;
+    block.valid = true;
+
+    const uint32_t index = static_cast<uint32_t>(blocks_.size());
+    blocks_.push_back(block);
+    blockMap_[pc] = index;
+
+    // Страницы учитываются по физическому адресу, чтобы запись через зеркало
+    // инвалидировала код, исполняемый по другому адресу
+    const uint32_t physStart = Memory::PhysicalAddress(pc);
+    const uint32_t physEnd = physStart + (block.endPC - pc);
+    for (uint32_t page = physStart >> PAGE_SHIFT; page <= ((physEnd - 1) >> PAGE_SHIFT); ++page) {
+        pageBlocks_[page].push_back(index);
+        memory_.MarkCodePage(page << PAGE_SHIFT);
+    }
+
+    return blocks_[index];
+}
+
+void BlockCache::InvalidateBlock(uint32_t index) {
+    Block& block = blocks_[index];
+    if (!block.valid) return;
+    block.valid = false;
+
+    auto it = blockMap_.find(block.startPC);
+    if (it != blockMap_.end() && it->second == index) {
+        blockMap_.erase(it);
+    }
+    ++invalidationCount_;
+
+    if (invalidateCallback_) {
+        invalidateCallback_(block.startPC);
+    }
+}
+
+void BlockCache::InvalidateRange(uint32_t addr, size_t size) {
+    if (size == 0) return;
+    addr = Memory::PhysicalAddress(addr);
+    const uint32_t end = static_cast<uint32_t>(addr + size);
+    const uint32_t firstPage = addr >> PAGE_SHIFT;
+    const uint32_t lastPage = (end - 1) >> PAGE_SHIFT;
+
+    for (uint32_t page = firstPage; page <= lastPage; ++page) {
+        auto it = pageBlocks_.find(page);
+        if (it == pageBlocks_.end()) continue;
+
+        std::vector<uint32_t>& indices = it->second;
+        indices.erase(std::remove_if(indices.begin(), indices.end(), [&](uint32_t index) {
+            const Block& block = blocks_[index];
+            if (!block.valid) return true;
+            const uint32_t start = Memory::PhysicalAddress(block.startPC);
+            if (start < end && addr < start + (block.endPC - block.startPC)) {
+                InvalidateBlock(index);
+                return true;
+            }
+            return false;
+        }), indices.end());
+
+        // Страница больше не содержит кода - записи в неё снова бесплатны
+        if (indices.empty()) {
+            pageBlocks_.erase(it);
+            memory_.UnmarkCodePage(page << PAGE_SHIFT);
+        }
+    }
+}
+
+void BlockCache::Clear() {
+    // Арена освобождается, поэтому подписчик должен забыть все блоки
+    if (invalidateCallback_) {
+        for (const Block& block : blocks_) {
+            if (block.valid) invalidateCallback_(block.startPC);
+        }
+    }
+    lookupCache_.fill(LookupEntry{});
+    arena_.clear();
+    ir_.clear();
+    blocks_.clear();
+    blockMap_.clear();
+    pageBlocks_.clear();
+    memory_.ClearCodePages();
+}
+
+}  // namespace core
+}  // namespace ppsspp
@@ -0,0 +1,116 @@
+// core/block_cache.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "decoder.h"
+#include "interpreter.h"
+#include "ir.h"
+
+namespace ppsspp {
+namespace core {
+
+class Memory;
+
+// Базовый блок гостевого кода: от точки входа до перехода и его delay slot
+struct Block {
+    uint32_t startPC = 0;
+    uint32_t endPC = 0;       // Адрес сразу после последней инструкции блока
+    uint32_t firstInst = 0;   // Индекс первой инструкции в арене
+    uint32_t numInsts = 0;    // Инструкций после оптимизации IR
+    bool valid = false;
+    bool idleLoop = false;    // Цикл ожидания, см. IsIdleLoop()
+};
+
+class BlockCache {
+public:
+    static constexpr uint32_t PAGE_SHIFT = 12;
+    static constexpr uint32_t MAX_BLOCK_INSTS = 256;
+    static constexpr size_t MAX_ARENA_INSTS = 1u << 20;
+    static constexpr uint32_t LOOKUP_CACHE_SIZE = 4096;
+    static constexpr uint32_t DECODE_BATCH = 16;
+
+    // Вызывается для каждого инвалидированного блока (например, чтобы JIT сбросил его код)
+    using InvalidateCallback = std::function<void(uint32_t startPC)>;
+
+    explicit BlockCache(Memory& memory);
+    ~BlockCache();
+
+    // Запрещаем копирование
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    // Возвращает блок, начинающийся с pc, декодируя его при первом обращении
+    const Block& GetOrCompile(uint32_t pc);
+
+    // Поиск без декодирования; nullptr, если блока нет
+    const Block* Lookup(uint32_t pc) const;
+
+    const Inst* GetInsts(const Block& block) const { return arena_.data() + block.firstInst; }
+
+    // IR блока; i-я запись соответствует i-й инструкции из GetInsts()
+    const IRInst* GetIR(const Block& block) const { return ir_.data() + block.firstInst; }
+
+    // Оптимизация IR при компиляции новых блоков (по умолчанию включена)
+    void SetIROptimization(bool enabled) { optimizeIR_ = enabled; }
+
+    // Инвалидация всех блоков, пересекающихся с диапазоном (адрес в любом зеркале)
+    void InvalidateRange(uint32_t addr, size_t size);
+
+    // Полный сброс кэша
+    void Clear();
+
+    void SetInvalidateCallback(InvalidateCallback callback) { invalidateCallback_ = std::move(callback); }
+
+    // Статистика
+    uint64_t GetDecodedCount() const { return decodedCount_; }
+    uint64_t GetInvalidationCount() const { return invalidationCount_; }
+    size_t GetBlockCount() const { return blockMap_.size(); }
+    const IRStats& GetIRStats() const { return irStats_; }
+    uint64_t GetIdleLoopCount() const { return idleLoopCount_; }
+
+private:
+    const Block& Compile(uint32_t pc);
+    void InvalidateBlock(uint32_t index);
+
+    Memory& memory_;
+    Decoder decoder_;
+
+    // Плоская арена инструкций, параллельная ей арена IR и дескрипторы блоков
+    std::vector<Inst> arena_;
+    std::vector<IRInst> ir_;
+    std::vector<Block> blocks_;
+
+    // Точка входа -> индекс блока
+    std::unordered_map<uint32_t, uint32_t> blockMap_;
+    // Страница -> блоки, содержащие код с этой страницы
+    std::unordered_map<uint32_t, std::vector<uint32_t>> pageBlocks_;
+
+    // Прямо отображаемый кэш поиска перед хеш-таблицей
+    struct LookupEntry {
+        uint32_t pc = 0xFFFFFFFF;
+        uint32_t index = 0;
+    };
+    std::array<LookupEntry, LOOKUP_CACHE_SIZE> lookupCache_;
+
+    InvalidateCallback invalidateCallback_;
+
+    // Инструкции компилируемого блока, декодированные пачками по DECODE_BATCH
+    std::array<Decoded, MAX_BLOCK_INSTS + 1 + DECODE_BATCH> decoded_;
+    std::vector<IRInst> scratch_;
+    bool optimizeIR_ = true;
+    IRStats irStats_;
+
+    uint64_t decodedCount_ = 0;
+    uint64_t invalidationCount_ = 0;
+    uint64_t idleLoopCount_ = 0;
+};
+
+}  // namespace core
+}  // namespace ppsspp
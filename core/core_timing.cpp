@@ -0,0 +1,99 @@
+// core/core_timing.cpp
+
+#include "core_timing.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace ppsspp {
+namespace core {
+
+namespace {
+
+// Событий в очереди обычно единицы: vblank, таймеры потоков, ввод-вывод
+constexpr size_t INITIAL_QUEUE_CAPACITY = 64;
+
+}  // namespace
+
+CoreTiming::CoreTiming() {
+    queue_.reserve(INITIAL_QUEUE_CAPACITY);
+    ResetHostBase();
+}
+
+CoreTiming::EventType CoreTiming::RegisterEvent(const char* name, EventCallback callback, void* userdata) {
+    types_.push_back({ name, callback, userdata });
+    return static_cast<EventType>(types_.size() - 1);
+}
+
+void CoreTiming::ScheduleEvent(int64_t cycles, EventType type, uint64_t param) {
+    const uint64_t time = GetTicks() + static_cast<uint64_t>(std::max<int64_t>(cycles, 0));
+    queue_.push_back({ time, nextOrder_++, type, param });
+    std::push_heap(queue_.begin(), queue_.end(), Later);
+}
+
+void CoreTiming::UnscheduleEvent(EventType type, uint64_t param) {
+    auto it = std::remove_if(queue_.begin(), queue_.end(), [&](const Event& event) {
+        return event.type == type && event.param == param;
+    });
+    if (it == queue_.end()) return;
+    queue_.erase(it, queue_.end());
+    std::make_heap(queue_.begin(), queue_.end(), Later);
+}
+
+int64_t CoreTiming::GetSliceLength() const {
+    if (queue_.empty()) return MAX_SLICE;
+    const uint64_t next = queue_.front().time;
+    if (next <= ticks_) return 0;
+    return std::min<int64_t>(static_cast<int64_t>(next - ticks_), MAX_SLICE);
+}
+
+void CoreTiming::BeginSlice(int64_t slice, const int64_t* downcount) {
+    slice_ = slice;
+    downcount_ = downcount;
+}
+
+uint64_t CoreTiming::GetTicks() const {
+    if (!downcount_) return ticks_;
+    return ticks_ + static_cast<uint64_t>(std::clamp<int64_t>(slice_ - *downcount_, 0, slice_));
+}
+
+void CoreTiming::Advance(int64_t cycles) {
+    downcount_ = nullptr;
+    ticks_ += static_cast<uint64_t>(std::max<int64_t>(cycles, 0));
+
+    while (!queue_.empty() && queue_.front().time <= ticks_) {
+        std::pop_heap(queue_.begin(), queue_.end(), Later);
+        const Event event = queue_.back();
+        queue_.pop_back();
+
+        // Обработчик может планировать новые события: событие уже снято с очереди
+        const EventTypeInfo& info = types_[event.type];
+        info.callback(info.userdata, event.param, static_cast<int64_t>(ticks_ - event.time));
+    }
+}
+
+void CoreTiming::SetThrottle(bool enabled) {
+    if (enabled && !throttle_) ResetHostBase();
+    throttle_ = enabled;
+}
+
+void CoreTiming::ResetHostBase() {
+    hostBase_ = std::chrono::steady_clock::now();
+    guestBaseUs_ = GetMicroseconds();
+}
+
+void CoreTiming::SyncHost() {
+    if (!throttle_) return;
+
+    const auto target = hostBase_ + std::chrono::microseconds(GetMicroseconds() - guestBaseUs_);
+    const auto now = std::chrono::steady_clock::now();
+    if (now > target + MAX_HOST_LAG) {
+        // Хост не успевает: продолжаем от текущего момента, не ускоряясь
+        ResetHostBase();
+        return;
+    }
+    if (target > now) std::this_thread::sleep_until(target);
+}
+
+}  // namespace core
+}  // namespace ppsspp
@@ -0,0 +1,108 @@
+// core/core_timing.h
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace ppsspp {
+namespace core {
+
+// Эмулируемое время гостя в циклах CPU и очередь событий по нему.
+//
+// Главный цикл (core::System::RunSlice) исполняет CPU отрезками до
+// ближайшего события:
+//     const int64_t slice = timing.GetSliceLength();
+//     timing.Advance(interpreter.Run(slice));
+// Advance() вызывает все наступившие события (vblank, пробуждение потоков,
+// завершение ввода-вывода). Внутри отрезка текущее время - начало отрезка
+// плюс уже исполненное: его исполнитель сообщает через BeginSlice(). Хостовое время влияет только на SyncHost():
+// без ограничения скорости эмуляция идёт так быстро, как может.
+class CoreTiming {
+public:
+    static constexpr int64_t CPU_HZ = 222000000;
+    static constexpr int64_t CYCLES_PER_US = CPU_HZ / 1000000;
+    // Наибольший отрезок без событий: чтобы ввод и хост не ждали долго
+    static constexpr int64_t MAX_SLICE = CPU_HZ / 1000;
+    // Отставание от хоста, после которого время не догоняется рывком
+    static constexpr std::chrono::milliseconds MAX_HOST_LAG{100};
+
+    using EventType = int;
+    // cyclesLate - на сколько циклов позже срока вызвано событие
+    using EventCallback = void (*)(void* userdata, uint64_t param, int64_t cyclesLate);
+
+    CoreTiming();
+
+    // Запрещаем копирование
+    CoreTiming(const CoreTiming&) = delete;
+    CoreTiming& operator=(const CoreTiming&) = delete;
+
+    EventType RegisterEvent(const char* name, EventCallback callback, void* userdata);
+
+    // Событие через cycles циклов; события с одним сроком вызываются
+    // в порядке планирования
+    void ScheduleEvent(int64_t cycles, EventType type, uint64_t param = 0);
+    // Снимает все запланированные события type с данным param
+    void UnscheduleEvent(EventType type, uint64_t param);
+
+    // Циклов до ближайшего события, но не больше MAX_SLICE
+    int64_t GetSliceLength() const;
+
+    // Начало отрезка длиной slice. downcount - остаток бюджета исполнителя,
+    // который тот уменьшает по мере исполнения блоков
+    void BeginSlice(int64_t slice, const int64_t* downcount);
+    // Засчитывает исполненные циклы, завершает отрезок и вызывает
+    // наступившие события
+    void Advance(int64_t cycles);
+
+    // Текущее время с точностью до блока: внутри отрезка учитываются уже
+    // исполненные блоки. Событие, запланированное внутри отрезка, наступает
+    // не раньше его конца, опоздание сообщает cyclesLate
+    uint64_t GetTicks() const;
+    uint64_t GetMicroseconds() const { return GetTicks() / CYCLES_PER_US; }
+    static constexpr int64_t UsToCycles(uint64_t usec) { return static_cast<int64_t>(usec) * CYCLES_PER_US; }
+
+    // Ограничение скорости: SyncHost() ждёт, пока хост не догонит гостя.
+    // Срок абсолютный, поэтому пересып одного кадра компенсируется в следующем
+    void SetThrottle(bool enabled);
+    bool IsThrottled() const { return throttle_; }
+    void SyncHost();
+
+private:
+    struct EventTypeInfo {
+        const char* name;
+        EventCallback callback;
+        void* userdata;
+    };
+
+    struct Event {
+        uint64_t time;
+        uint64_t order;     // порядок планирования при равном сроке
+        EventType type;
+        uint64_t param;
+    };
+
+    // Компаратор кучи: наверху самое раннее событие
+    static bool Later(const Event& a, const Event& b) {
+        return a.time != b.time ? a.time > b.time : a.order > b.order;
+    }
+
+    void ResetHostBase();
+
+    std::vector<EventTypeInfo> types_;
+    std::vector<Event> queue_;
+    uint64_t ticks_ = 0;             // начало текущего отрезка
+    uint64_t nextOrder_ = 0;
+
+    int64_t slice_ = 0;
+    const int64_t* downcount_ = nullptr;    // nullptr - вне отрезка
+
+    bool throttle_ = true;
+    std::chrono::steady_clock::time_point hostBase_;
+    uint64_t guestBaseUs_ = 0;
+};
+
+}  // namespace core
+}  // namespace ppsspp
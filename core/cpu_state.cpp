@@ -23,6 +23,8 @@ void CPUState::Reset() {
     hi = 0;
     pc = 0;
     gp = 0;
+    std::memset(fpr, 0, sizeof(fpr));
+    fcr31 = 0;
     memory = nullptr;
     LogInfo("CPU state reset to default values");
 }
@@ -33,11 +35,36 @@ void CPUState::Reset(uint32_t pc, uint32_t gp) {
     hi = 0;
     SetPC(pc);
     SetGP(gp);
+    std::memset(fpr, 0, sizeof(fpr));
+    fcr31 = 0;
     memory = nullptr;
     LogInfo("CPU state reset with PC=" + std::to_string(pc) + 
             ", GP=" + std::to_string(gp));
 }
 
+void CPUState::SaveContext(Context& ctx) const {
+    std::memcpy(ctx.gpr, gpr, sizeof(gpr));
+    ctx.lo = lo;
+    ctx.hi = hi;
+    ctx.pc = pc;
+    ctx.gp = gp;
+    std::memcpy(ctx.fpr, fpr, sizeof(fpr));
+    ctx.fcr31 = fcr31;
+    std::memcpy(ctx.vpr, vpr, sizeof(vpr));
+}
+
+void CPUState::LoadContext(const Context& ctx) {
+    std::memcpy(gpr, ctx.gpr, sizeof(gpr));
+    gpr[0] = 0;
+    lo = ctx.lo;
+    hi = ctx.hi;
+    pc = ctx.pc;
+    gp = ctx.gp;
+    std::memcpy(fpr, ctx.fpr, sizeof(fpr));
+    fcr31 = ctx.fcr31;
+    std::memcpy(vpr, ctx.vpr, sizeof(vpr));
+}
+
 void CPUState::ValidateRegisterIndex(size_t index) const {
     if (index >= 32) {
         throw CPUError("Invalid register index: " + std::to_string(index));
@@ -75,6 +102,7 @@ uint32_t CPUState::GetGPR(size_t index) const {
 
 void CPUState::SetGPR(size_t index, uint32_t value) {
     ValidateRegisterIndex(index);
+    if (index == 0) return;  // $zero аппаратно равен нулю
     gpr[index] = value;
 }
 
@@ -18,12 +18,62 @@ public:
 
 class Memory;
 
+// Индекс регистра фиксированной разрядности. Значение берётся из битового
+// поля инструкции и маскируется, поэтому всегда лежит в диапазоне.
+template <unsigned Bits, typename Tag>
+class RegIndex {
+public:
+    static constexpr uint32_t COUNT = 1u << Bits;
+
+    constexpr explicit RegIndex(uint32_t field) : value_(static_cast<uint8_t>(field & (COUNT - 1))) {}
+    constexpr uint8_t Value() const { return value_; }
+
+private:
+    uint8_t value_;
+};
+
+struct GprTag;
+struct VfpuRegTag;
+struct VfpuLaneTag;
+
+using GprIndex = RegIndex<5, GprTag>;
+using VfpuRegIndex = RegIndex<7, VfpuRegTag>;
+using VfpuLaneIndex = RegIndex<2, VfpuLaneTag>;
+
+// Именованные GPR по соглашению о вызовах MIPS
+namespace reg {
+constexpr GprIndex ZERO{0};
+constexpr GprIndex V0{2};
+constexpr GprIndex V1{3};
+constexpr GprIndex A0{4};
+constexpr GprIndex A1{5};
+constexpr GprIndex A2{6};
+constexpr GprIndex A3{7};
+constexpr GprIndex SP{29};
+constexpr GprIndex RA{31};
+}  // namespace reg
+
 class CPUState {
 public:
     static constexpr uint32_t MAX_MEMORY = 0x10000000; // 256MB
     static constexpr uint32_t INVALID_PC = 0xFFFFFFFF;
     static constexpr size_t VFPU_REG_COUNT = 128;      // Количество регистров VFPU
     static constexpr size_t VFPU_VECTOR_SIZE = 4;      // Размер вектора VFPU
+    static constexpr size_t FPR_COUNT = 32;            // Регистры FPU (COP1)
+    static constexpr uint32_t FCR31_CONDITION = 1u << 23;  // Флаг c.cond.s для bc1x
+
+    // Регистры, принадлежащие потоку гостя: сохраняются и восстанавливаются
+    // при переключении потоков
+    struct Context {
+        uint32_t gpr[32];
+        uint32_t lo;
+        uint32_t hi;
+        uint32_t pc;
+        uint32_t gp;
+        float fpr[FPR_COUNT];
+        uint32_t fcr31;
+        float vpr[VFPU_REG_COUNT][VFPU_VECTOR_SIZE];
+    };
 
     CPUState();                             // Конструктор по умолчанию
     CPUState(uint32_t pc, uint32_t gp);     // Конструктор с инициализацией
@@ -40,9 +90,21 @@ public:
     void Reset();                           // Сброс в 0
     void Reset(uint32_t pc, uint32_t gp);   // Сброс с установкой PC и GP
 
-    // Безопасные методы доступа к регистрам
+    // Переключение потоков: копирование без проверок и выделения памяти
+    void SaveContext(Context& ctx) const;
+    void LoadContext(const Context& ctx);
+
+    // Безопасные методы доступа к регистрам (для отладчика и инструментов)
     uint32_t GetGPR(size_t index) const;
     void SetGPR(size_t index, uint32_t value);
+
+    // Быстрый доступ для горячего пути: индекс корректен по построению,
+    // исключений нет. Запись в $zero игнорируется.
+    uint32_t GetGPR(GprIndex r) const noexcept { return gpr[r.Value()]; }
+    void SetGPR(GprIndex r, uint32_t value) noexcept {
+        gpr[r.Value()] = value;
+        gpr[0] = 0;
+    }
     
     // Безопасные методы для специальных регистров
     uint32_t GetPC() const { return pc; }
@@ -63,6 +125,11 @@ public:
     const float* GetVFPUVector(size_t reg) const;
     void SetVFPUVector(size_t reg, const float* values);
 
+    // Быстрый доступ к VFPU без проверок
+    float GetVFPU(VfpuRegIndex r, VfpuLaneIndex lane) const noexcept { return vpr[r.Value()][lane.Value()]; }
+    void SetVFPU(VfpuRegIndex r, VfpuLaneIndex lane, float value) noexcept { vpr[r.Value()][lane.Value()] = value; }
+    const float* GetVFPUVector(VfpuRegIndex r) const noexcept { return vpr[r.Value()]; }
+
     // Методы для работы с scratch регистрами
     uint32_t GetScratchPC() const { return scratchPC; }
     void SetScratchPC(uint32_t new_pc) { scratchPC = new_pc; }
@@ -78,6 +145,8 @@ public:
     uint32_t* GetLOPtr() { return &lo; }
     uint32_t* GetHIPtr() { return &hi; }
     uint32_t* GetPCPtr() { return &pc; }
+    float* GetFPRPtr() { return fpr; }
+    uint32_t* GetFCR31Ptr() { return &fcr31; }
     uint32_t* GetScratchPCPtr() { return &scratchPC; }
     uint32_t* GetScratchInstPtr() { return &scratchInst; }
 
@@ -90,6 +159,8 @@ private:
     uint32_t scratchPC = 0;    // Временный PC для интерпретатора
     uint32_t scratchInst = 0;  // Текущая инструкция
     Memory* memory = nullptr;
+    float fpr[FPR_COUNT] = {0.0f};   // Регистры FPU
+    uint32_t fcr31 = 0;              // Управление и флаг условия FPU
     float vpr[VFPU_REG_COUNT][VFPU_VECTOR_SIZE] = {{0.0f}};  // Регистры VFPU
 
     void ValidateRegisterIndex(size_t index) const;
@@ -99,5 +170,9 @@ private:
     void ValidateVFPUIndex(size_t index) const;
 };
 
+static_assert(GprIndex::COUNT == 32, "GPR index covers the register file");
+static_assert(VfpuRegIndex::COUNT == CPUState::VFPU_REG_COUNT, "VFPU index covers the register file");
+static_assert(VfpuLaneIndex::COUNT == CPUState::VFPU_VECTOR_SIZE, "VFPU lane index covers a vector");
+
 }  // namespace core
 }  // namespace ppsspp
@@ -1,49 +1,80 @@
 #include "decoder.h"
+#include "memory.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PPSSPP_DECODE_SSE2 1
+#endif
 
 namespace ppsspp {
 namespace core {
 
-static uint8_t GetBits(uint32_t value, int hi, int lo) {
-    return (value >> lo) & ((1u << (hi - lo + 1)) - 1);
+namespace {
+
+// Упакованная классификация для каждого InstId
+constexpr std::array<uint32_t, NUM_INST_IDS> BuildPackedInfo() {
+    std::array<uint32_t, NUM_INST_IDS> info{};
+    for (size_t n = 0; n < NUM_INST_IDS; ++n) {
+        const InstId id = static_cast<InstId>(n);
+        info[n] = Decoded::Pack(id, GetInstInfo(id).flags);
+    }
+    return info;
 }
 
-Decoded Decoder::Decode(uint32_t pc, uint32_t word) {
+constexpr std::array<uint32_t, NUM_INST_IDS> kPackedInfo = BuildPackedInfo();
+constexpr uint32_t kInvalidInfo = Decoded::Pack(InstId::Invalid, 0);
+
+}  // namespace
+
+Decoded Decoder::Decode(uint32_t word) const {
     Decoded d;
-    d.pc = pc;
-    d.instrWord = word;
-
-    d.opcode = GetBits(word, 31, 26);
-    d.rs     = GetBits(word, 25, 21);
-    d.rt     = GetBits(word, 20, 16);
-    d.rd     = GetBits(word, 15, 11);
-    d.shamt  = GetBits(word, 10, 6);
-    d.funct  = GetBits(word, 5, 0);
-    d.immediate = word & 0xFFFF;
-    d.target    = ((pc + 4) & 0xF0000000) | ((word & 0x03FFFFFF) << 2);
-    d.delayPC   = pc + 4;
-
-    // VFPU fmt
-    d.fmt = GetBits(word, 5, 0);
-
-    // Delay slot определение
-    switch (d.opcode) {
-        case 0x01: case 0x04: case 0x05:
-        case 0x06: case 0x07: case 0x02:
-        case 0x03: case 0x14: case 0x15:
-            d.isBranch = true;
-            d.isDelaySlot = false;
-            break;
-        default:
-            d.isBranch = false;
-            d.isDelaySlot = false;
-            break;
+    d.word = word;
+
+    // Классификация по таблице декодирования
+    d.info = kPackedInfo[static_cast<size_t>(LookupInstId(word))];
+    if (!enableVFPU_ && (d.info & IF_VFPU)) {
+        d.info = kInvalidInfo;
     }
+    return d;
+}
 
-    if (d.opcode == 0x10) d.cop = COP0;
-    else if (d.opcode == 0x12) d.cop = COP2;
-    else d.cop = NONE;
+void Decoder::DecodeRange(const uint32_t* words, size_t count, Decoded* out) const {
+    size_t n = 0;
+#ifdef PPSSPP_DECODE_SSE2
+    // Классификация остаётся скалярной (переход по уровням таблицы), а
+    // загрузка слов и перемежение слово/info в выходной массив - по 4 за раз
+    for (; n + 4 <= count; n += 4) {
+        const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + n));
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), w);
 
-    return d;
+        alignas(16) uint32_t info[4];
+        for (int k = 0; k < 4; ++k) {
+            info[k] = kPackedInfo[static_cast<size_t>(LookupInstId(lanes[k]))];
+            if (!enableVFPU_ && (info[k] & IF_VFPU)) info[k] = kInvalidInfo;
+        }
+        const __m128i i = _mm_load_si128(reinterpret_cast<const __m128i*>(info));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n), _mm_unpacklo_epi32(w, i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n + 2), _mm_unpackhi_epi32(w, i));
+    }
+#endif
+    for (; n < count; ++n) {
+        uint32_t word;
+        std::memcpy(&word, words + n, sizeof(word));
+        out[n] = Decode(word);
+    }
+}
+
+size_t Decoder::DecodeRange(const Memory& memory, uint32_t pc, size_t count, Decoded* out) const {
+    // Невыровненный pc и адрес вне карты памяти обрабатывает вызывающий через Read32
+    const size_t available = memory.GetContiguousSize(pc, count * 4) / 4;
+    if ((pc & 3) != 0 || available == 0) return 0;
+    if (count > available) count = available;
+    DecodeRange(reinterpret_cast<const uint32_t*>(memory.GetPointer(pc)), count, out);
+    return count;
 }
 
 } // namespace core
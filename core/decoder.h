@@ -1,9 +1,13 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include "opcode_table.h"
 
 namespace ppsspp {
 namespace core {
 
+class Memory;
+
 // COP блоки
 enum Coprocessor {
     NONE = 0,
@@ -13,40 +17,68 @@ enum Coprocessor {
     COP3 = 4,
 };
 
-// Распознанная инструкция PSP (MIPS32)
+// Распознанная инструкция PSP (MIPS32), упакованная в 8 байт:
+// исходное слово и результат классификации. Поля операндов извлекаются
+// из слова по запросу. Адрес не хранится - в массиве из DecodeRange он
+// определяется индексом, поэтому цели переходов вычисляются от переданного pc.
 struct Decoded {
-    uint32_t pc;
-    uint32_t instrWord;
-    uint8_t opcode;
-    uint8_t rs, rt, rd;
-    uint8_t shamt;
-    uint8_t funct;
-    uint16_t immediate;
-    uint32_t target;
-    Coprocessor cop;
-
-    bool isBranch;
-    bool isDelaySlot;
-    uint32_t delayPC;
-
-    uint8_t fmt; // для VFPU
-
-    Decoded() {
-        pc = 0; instrWord = 0;
-        opcode = rs = rt = rd = shamt = funct = 0;
-        immediate = 0; target = 0;
-        isBranch = isDelaySlot = false;
-        delayPC = 0;
-        cop = NONE;
-        fmt = 0;
+    static constexpr uint32_t ID_SHIFT = 20;
+    static constexpr uint32_t FLAGS_MASK = (1u << ID_SHIFT) - 1;
+
+    uint32_t word = 0;
+    uint32_t info = 0;  // InstFlags в младших битах, InstId - в старших
+
+    static constexpr uint32_t Pack(InstId id, uint32_t flags) {
+        return (static_cast<uint32_t>(id) << ID_SHIFT) | flags;
+    }
+
+    constexpr InstId Id() const { return static_cast<InstId>(info >> ID_SHIFT); }
+    constexpr uint32_t Flags() const { return info & FLAGS_MASK; }
+    constexpr bool IsBranch() const { return (info & IF_BRANCH) != 0; }
+
+    constexpr Coprocessor Cop() const {
+        if (info & IF_COP0) return COP0;
+        if (info & IF_FPU) return COP1;
+        if (info & IF_VFPU) return COP2;
+        return NONE;
+    }
+
+    constexpr uint8_t Opcode() const { return static_cast<uint8_t>(word >> 26); }
+    constexpr uint8_t Rs() const { return (word >> 21) & 31; }
+    constexpr uint8_t Rt() const { return (word >> 16) & 31; }
+    constexpr uint8_t Rd() const { return (word >> 11) & 31; }
+    constexpr uint8_t Shamt() const { return (word >> 6) & 31; }
+    constexpr uint8_t Funct() const { return word & 63; }
+    constexpr uint8_t Fmt() const { return word & 63; }  // для VFPU
+    constexpr uint16_t Imm() const { return static_cast<uint16_t>(word); }
+    constexpr uint32_t SImm() const { return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(word))); }
+
+    // Цель j/jal
+    constexpr uint32_t JumpTarget(uint32_t pc) const {
+        return ((pc + 4) & 0xF0000000) | ((word & 0x03FFFFFF) << 2);
+    }
+    // Цель относительного перехода
+    constexpr uint32_t BranchTarget(uint32_t pc) const {
+        return pc + 4 + (SImm() << 2);
     }
 };
 
+static_assert(sizeof(Decoded) == 8, "Decoded must stay packed");
+static_assert(NUM_INST_IDS <= (1u << (32 - Decoded::ID_SHIFT)), "InstId does not fit Decoded::info");
+static_assert(IF_OUT_HILO <= Decoded::FLAGS_MASK, "InstFlags do not fit Decoded::info");
+
 class Decoder {
 public:
     Decoder(bool enableVFPU) : enableVFPU_(enableVFPU) {}
 
-    Decoded Decode(uint32_t pc, uint32_t word);
+    Decoded Decode(uint32_t word) const;
+
+    // Декодирование подряд идущих слов в непрерывный массив
+    void DecodeRange(const uint32_t* words, size_t count, Decoded* out) const;
+
+    // То же для кода в памяти гостя начиная с pc. Возвращает число
+    // декодированных инструкций: меньше count, если диапазон выходит за область памяти.
+    size_t DecodeRange(const Memory& memory, uint32_t pc, size_t count, Decoded* out) const;
 
 private:
     bool enableVFPU_;
@@ -119,33 +119,28 @@ bool InputSystem::IsButtonHeld(PSPButton button) const {
     return buttonState_[button];
 }
 
-void InputSystem::SetMemory(core::Memory* memory) {
-    memory_ = memory;
-}
-
 void InputSystem::WriteToMemory() {
-    if (!memory_) return;
-    // Структура SceCtrlData PSP (упрощённо)
-    struct SceCtrlData {
-        uint32_t buttons;
-        uint8_t lx;
-        uint8_t ly;
-        uint8_t reserved[6];
-    } data{};
+    if (!controller_) return;
+
+    // Биты PSP_CTRL_* в SceCtrlData.Buttons, в порядке PSPButton
+    static constexpr uint32_t CTRL_BITS[PSP_BUTTON_COUNT] = {
+        0x0000001, 0x0000008, 0x0000010, 0x0000020, 0x0000040, 0x0000080,    // SELECT START UP RIGHT DOWN LEFT
+        0x0000100, 0x0000200, 0x0001000, 0x0002000, 0x0004000, 0x0008000,    // L R TRIANGLE CIRCLE CROSS SQUARE
+        0x0010000, 0x0020000, 0x0800000, 0x0400000, 0x0100000, 0x0200000,    // HOME HOLD NOTE SCREEN VOLUP VOLDOWN
+        0x0040000, 0x0080000, 0x1000000, 0x2000000,                          // WLAN_UP REMOTE DISC MS
+    };
+
     // Маппинг PSP кнопок в битовую маску
+    uint32_t buttons = 0;
     for (int i = 0; i < PSP_BUTTON_COUNT; ++i) {
         if (buttonState_[i])
-            data.buttons |= (1 << i);
+            buttons |= CTRL_BITS[i];
     }
     // Аналоговые стики (0-255)
-    data.lx = static_cast<uint8_t>((analogX_ * 127.0f) + 128.0f);
-    data.ly = static_cast<uint8_t>((analogY_ * 127.0f) + 128.0f);
-    memory_->Write32(0x88000000, data.buttons);
-    memory_->Write8(0x88000004, data.lx);
-    memory_->Write8(0x88000005, data.ly);
-    // Остальные байты обнуляем
-    for (int i = 0; i < 6; ++i)
-        memory_->Write8(0x88000006 + i, 0);
+    const uint8_t lx = static_cast<uint8_t>((analogX_ * 127.0f) + 128.0f);
+    const uint8_t ly = static_cast<uint8_t>((analogY_ * 127.0f) + 128.0f);
+    // Блок контроллера отображён через MMIO, в RAM ничего не пишется
+    controller_->SetState(buttons, lx, ly);
 }
 
 } // namespace core
@@ -5,6 +5,7 @@
 #include <xinput.h>
 #include <array>
 #include "memory.h"
+#include "mmio.h"
 
 namespace ppsspp {
 namespace core {
@@ -48,7 +49,10 @@ public:
     float GetAnalogX() const { return analogX_; }
     float GetAnalogY() const { return analogY_; }
     bool IsInitialized() const { return isInitialized_; }
-    void SetMemory(core::Memory* memory);
+    // Блок контроллера системы, в который публикуется состояние;
+    // nullptr - не публиковать
+    void SetController(ControllerMmio* controller) { controller_ = controller; }
+    // Публикует текущее состояние в блок контроллера
     void WriteToMemory();
 
 private:
@@ -67,7 +71,7 @@ private:
     // XInput состояние
     XINPUT_STATE xInputState_;
     bool isInitialized_;
-    core::Memory* memory_ = nullptr;
+    ControllerMmio* controller_ = nullptr;
 };
 
 // Глобальные функции для совместимости
@@ -0,0 +1,752 @@
+// core/interpreter.cpp
+
+#include "interpreter.h"
+#include "block_cache.h"
+#include "ir.h"
+#include "memory.h"
+#include "syscall.h"
+#include "logger.h"
+
+#include <bit>
+#include <cmath>
+#include <string>
+
+namespace ppsspp {
+namespace core {
+
+namespace {
+
+// Регистры с особым назначением
+constexpr int REG_RA = 31;
+
+inline uint32_t& R(ExecContext& ctx, uint8_t index) { return ctx.gpr[index]; }
+
+// Запись в GPR с сохранением $zero
+inline void W(ExecContext& ctx, uint8_t index, uint32_t value) {
+    ctx.gpr[index] = value;
+    ctx.gpr[0] = 0;
+}
+
+inline void TakeBranch(ExecContext& ctx, uint32_t target) {
+    ctx.branchTarget = target;
+    ctx.branchPending = true;
+}
+
+// Обычный переход: delay slot исполняется всегда
+inline void Branch(ExecContext& ctx, bool taken, uint32_t target) {
+    TakeBranch(ctx, taken ? target : ctx.pc + 8);
+}
+
+// Likely-переход: при невыполненном условии delay slot пропускается
+inline void BranchLikely(ExecContext& ctx, bool taken, uint32_t target) {
+    if (taken) {
+        TakeBranch(ctx, target);
+    } else {
+        ctx.nextPC = ctx.pc + 8;
+    }
+}
+
+// --- ALU (R-type) ---
+
+void Op_Sll(ExecContext& ctx, const Inst& i)  { W(ctx, i.rd, R(ctx, i.rt) << i.sa); }
+void Op_Srl(ExecContext& ctx, const Inst& i)  { W(ctx, i.rd, R(ctx, i.rt) >> i.sa); }
+void Op_Sra(ExecContext& ctx, const Inst& i)  { W(ctx, i.rd, uint32_t(int32_t(R(ctx, i.rt)) >> i.sa)); }
+void Op_Rotr(ExecContext& ctx, const Inst& i) {
+    uint32_t v = R(ctx, i.rt);
+    W(ctx, i.rd, i.sa ? (v >> i.sa) | (v << (32 - i.sa)) : v);
+}
+void Op_Sllv(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, R(ctx, i.rt) << (R(ctx, i.rs) & 31)); }
+void Op_Srlv(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, R(ctx, i.rt) >> (R(ctx, i.rs) & 31)); }
+void Op_Srav(ExecContext& ctx, const Inst& i) {
+    W(ctx, i.rd, uint32_t(int32_t(R(ctx, i.rt)) >> (R(ctx, i.rs) & 31)));
+}
+void Op_Rotrv(ExecContext& ctx, const Inst& i) {
+    uint32_t v = R(ctx, i.rt);
+    uint32_t s = R(ctx, i.rs) & 31;
+    W(ctx, i.rd, s ? (v >> s) | (v << (32 - s)) : v);
+}
+
+void Op_Movz(ExecContext& ctx, const Inst& i) { if (R(ctx, i.rt) == 0) W(ctx, i.rd, R(ctx, i.rs)); }
+void Op_Movn(ExecContext& ctx, const Inst& i) { if (R(ctx, i.rt) != 0) W(ctx, i.rd, R(ctx, i.rs)); }
+
+void Op_Mfhi(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, *ctx.cpu->GetHIPtr()); }
+void Op_Mthi(ExecContext& ctx, const Inst& i) { *ctx.cpu->GetHIPtr() = R(ctx, i.rs); }
+void Op_Mflo(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, *ctx.cpu->GetLOPtr()); }
+void Op_Mtlo(ExecContext& ctx, const Inst& i) { *ctx.cpu->GetLOPtr() = R(ctx, i.rs); }
+
+void Op_Clz(ExecContext& ctx, const Inst& i) {
+    uint32_t v = R(ctx, i.rs);
+    uint32_t n = 0;
+    while (n < 32 && !(v & (0x80000000u >> n))) ++n;
+    W(ctx, i.rd, n);
+}
+void Op_Clo(ExecContext& ctx, const Inst& i) {
+    uint32_t v = ~R(ctx, i.rs);
+    uint32_t n = 0;
+    while (n < 32 && !(v & (0x80000000u >> n))) ++n;
+    W(ctx, i.rd, n);
+}
+
+inline void SetHILO(ExecContext& ctx, uint64_t value) {
+    *ctx.cpu->GetLOPtr() = uint32_t(value);
+    *ctx.cpu->GetHIPtr() = uint32_t(value >> 32);
+}
+inline uint64_t GetHILO(ExecContext& ctx) {
+    return (uint64_t(*ctx.cpu->GetHIPtr()) << 32) | *ctx.cpu->GetLOPtr();
+}
+
+void Op_Mult(ExecContext& ctx, const Inst& i) {
+    SetHILO(ctx, uint64_t(int64_t(int32_t(R(ctx, i.rs))) * int64_t(int32_t(R(ctx, i.rt)))));
+}
+void Op_Multu(ExecContext& ctx, const Inst& i) {
+    SetHILO(ctx, uint64_t(R(ctx, i.rs)) * uint64_t(R(ctx, i.rt)));
+}
+void Op_Madd(ExecContext& ctx, const Inst& i) {
+    SetHILO(ctx, GetHILO(ctx) + uint64_t(int64_t(int32_t(R(ctx, i.rs))) * int64_t(int32_t(R(ctx, i.rt)))));
+}
+void Op_Maddu(ExecContext& ctx, const Inst& i) {
+    SetHILO(ctx, GetHILO(ctx) + uint64_t(R(ctx, i.rs)) * uint64_t(R(ctx, i.rt)));
+}
+void Op_Msub(ExecContext& ctx, const Inst& i) {
+    SetHILO(ctx, GetHILO(ctx) - uint64_t(int64_t(int32_t(R(ctx, i.rs))) * int64_t(int32_t(R(ctx, i.rt)))));
+}
+void Op_Msubu(ExecContext& ctx, const Inst& i) {
+    SetHILO(ctx, GetHILO(ctx) - uint64_t(R(ctx, i.rs)) * uint64_t(R(ctx, i.rt)));
+}
+
+// Деление на ноль и переполнение ведут себя как на реальной PSP
+void Op_Div(ExecContext& ctx, const Inst& i) {
+    int32_t a = int32_t(R(ctx, i.rs));
+    int32_t b = int32_t(R(ctx, i.rt));
+    uint32_t* lo = ctx.cpu->GetLOPtr();
+    uint32_t* hi = ctx.cpu->GetHIPtr();
+    if (b == 0) {
+        *lo = a < 0 ? 1 : 0xFFFFFFFF;
+        *hi = uint32_t(a);
+    } else if (a == INT32_MIN && b == -1) {
+        *lo = 0x80000000;
+        *hi = 0xFFFFFFFF;
+    } else {
+        *lo = uint32_t(a / b);
+        *hi = uint32_t(a % b);
+    }
+}
+void Op_Divu(ExecContext& ctx, const Inst& i) {
+    uint32_t a = R(ctx, i.rs);
+    uint32_t b = R(ctx, i.rt);
+    uint32_t* lo = ctx.cpu->GetLOPtr();
+    uint32_t* hi = ctx.cpu->GetHIPtr();
+    if (b == 0) {
+        *lo = a <= 0xFFFF ? 0xFFFF : 0xFFFFFFFF;
+        *hi = a;
+    } else {
+        *lo = a / b;
+        *hi = a % b;
+    }
+}
+
+void Op_Addu(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, R(ctx, i.rs) + R(ctx, i.rt)); }
+void Op_Subu(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, R(ctx, i.rs) - R(ctx, i.rt)); }
+void Op_And(ExecContext& ctx, const Inst& i)  { W(ctx, i.rd, R(ctx, i.rs) & R(ctx, i.rt)); }
+void Op_Or(ExecContext& ctx, const Inst& i)   { W(ctx, i.rd, R(ctx, i.rs) | R(ctx, i.rt)); }
+void Op_Xor(ExecContext& ctx, const Inst& i)  { W(ctx, i.rd, R(ctx, i.rs) ^ R(ctx, i.rt)); }
+void Op_Nor(ExecContext& ctx, const Inst& i)  { W(ctx, i.rd, ~(R(ctx, i.rs) | R(ctx, i.rt))); }
+void Op_Slt(ExecContext& ctx, const Inst& i)  {
+    W(ctx, i.rd, int32_t(R(ctx, i.rs)) < int32_t(R(ctx, i.rt)) ? 1 : 0);
+}
+void Op_Sltu(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, R(ctx, i.rs) < R(ctx, i.rt) ? 1 : 0); }
+void Op_Max(ExecContext& ctx, const Inst& i)  {
+    int32_t a = int32_t(R(ctx, i.rs)), b = int32_t(R(ctx, i.rt));
+    W(ctx, i.rd, uint32_t(a > b ? a : b));
+}
+void Op_Min(ExecContext& ctx, const Inst& i)  {
+    int32_t a = int32_t(R(ctx, i.rs)), b = int32_t(R(ctx, i.rt));
+    W(ctx, i.rd, uint32_t(a < b ? a : b));
+}
+
+// --- ALU (I-type) ---
+
+void Op_Addiu(ExecContext& ctx, const Inst& i) { W(ctx, i.rt, R(ctx, i.rs) + i.imm); }
+void Op_Slti(ExecContext& ctx, const Inst& i)  { W(ctx, i.rt, int32_t(R(ctx, i.rs)) < int32_t(i.imm) ? 1 : 0); }
+void Op_Sltiu(ExecContext& ctx, const Inst& i) { W(ctx, i.rt, R(ctx, i.rs) < i.imm ? 1 : 0); }
+void Op_Andi(ExecContext& ctx, const Inst& i)  { W(ctx, i.rt, R(ctx, i.rs) & i.imm); }
+void Op_Ori(ExecContext& ctx, const Inst& i)   { W(ctx, i.rt, R(ctx, i.rs) | i.imm); }
+void Op_Xori(ExecContext& ctx, const Inst& i)  { W(ctx, i.rt, R(ctx, i.rs) ^ i.imm); }
+void Op_Lui(ExecContext& ctx, const Inst& i)   { W(ctx, i.rt, i.imm); }
+
+// --- Allegrex: ext/ins и bshfl ---
+
+void Op_Ext(ExecContext& ctx, const Inst& i) {
+    uint32_t size = uint32_t(i.rd) + 1;
+    uint32_t mask = size >= 32 ? 0xFFFFFFFF : ((1u << size) - 1);
+    W(ctx, i.rt, (R(ctx, i.rs) >> i.sa) & mask);
+}
+void Op_Ins(ExecContext& ctx, const Inst& i) {
+    uint32_t size = uint32_t(i.rd) + 1 - i.sa;
+    uint32_t mask = (size >= 32 ? 0xFFFFFFFF : ((1u << size) - 1)) << i.sa;
+    W(ctx, i.rt, (R(ctx, i.rt) & ~mask) | ((R(ctx, i.rs) << i.sa) & mask));
+}
+void Op_Seb(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, uint32_t(int32_t(int8_t(R(ctx, i.rt))))); }
+void Op_Seh(ExecContext& ctx, const Inst& i) { W(ctx, i.rd, uint32_t(int32_t(int16_t(R(ctx, i.rt))))); }
+void Op_Wsbh(ExecContext& ctx, const Inst& i) {
+    uint32_t v = R(ctx, i.rt);
+    W(ctx, i.rd, ((v & 0x00FF00FF) << 8) | ((v & 0xFF00FF00) >> 8));
+}
+void Op_Wsbw(ExecContext& ctx, const Inst& i) {
+    uint32_t v = R(ctx, i.rt);
+    W(ctx, i.rd, (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24));
+}
+void Op_Bitrev(ExecContext& ctx, const Inst& i) {
+    uint32_t v = R(ctx, i.rt);
+    uint32_t r = 0;
+    for (int b = 0; b < 32; ++b) r |= ((v >> b) & 1) << (31 - b);
+    W(ctx, i.rd, r);
+}
+
+// --- Переходы ---
+
+void Op_J(ExecContext& ctx, const Inst& i)   { TakeBranch(ctx, i.imm); }
+void Op_Jal(ExecContext& ctx, const Inst& i) { ctx.gpr[REG_RA] = ctx.pc + 8; TakeBranch(ctx, i.imm); }
+void Op_Jr(ExecContext& ctx, const Inst& i)  { TakeBranch(ctx, R(ctx, i.rs)); }
+void Op_Jalr(ExecContext& ctx, const Inst& i) {
+    uint32_t target = R(ctx, i.rs);
+    W(ctx, i.rd, ctx.pc + 8);
+    TakeBranch(ctx, target);
+}
+
+void Op_Beq(ExecContext& ctx, const Inst& i)  { Branch(ctx, R(ctx, i.rs) == R(ctx, i.rt), i.imm); }
+void Op_Bne(ExecContext& ctx, const Inst& i)  { Branch(ctx, R(ctx, i.rs) != R(ctx, i.rt), i.imm); }
+void Op_Blez(ExecContext& ctx, const Inst& i) { Branch(ctx, int32_t(R(ctx, i.rs)) <= 0, i.imm); }
+void Op_Bgtz(ExecContext& ctx, const Inst& i) { Branch(ctx, int32_t(R(ctx, i.rs)) > 0, i.imm); }
+void Op_Bltz(ExecContext& ctx, const Inst& i) { Branch(ctx, int32_t(R(ctx, i.rs)) < 0, i.imm); }
+void Op_Bgez(ExecContext& ctx, const Inst& i) { Branch(ctx, int32_t(R(ctx, i.rs)) >= 0, i.imm); }
+void Op_Bltzal(ExecContext& ctx, const Inst& i) {
+    bool taken = int32_t(R(ctx, i.rs)) < 0;
+    ctx.gpr[REG_RA] = ctx.pc + 8;
+    Branch(ctx, taken, i.imm);
+}
+void Op_Bgezal(ExecContext& ctx, const Inst& i) {
+    bool taken = int32_t(R(ctx, i.rs)) >= 0;
+    ctx.gpr[REG_RA] = ctx.pc + 8;
+    Branch(ctx, taken, i.imm);
+}
+
+void Op_Beql(ExecContext& ctx, const Inst& i)  { BranchLikely(ctx, R(ctx, i.rs) == R(ctx, i.rt), i.imm); }
+void Op_Bnel(ExecContext& ctx, const Inst& i)  { BranchLikely(ctx, R(ctx, i.rs) != R(ctx, i.rt), i.imm); }
+void Op_Blezl(ExecContext& ctx, const Inst& i) { BranchLikely(ctx, int32_t(R(ctx, i.rs)) <= 0, i.imm); }
+void Op_Bgtzl(ExecContext& ctx, const Inst& i) { BranchLikely(ctx, int32_t(R(ctx, i.rs)) > 0, i.imm); }
+void Op_Bltzl(ExecContext& ctx, const Inst& i) { BranchLikely(ctx, int32_t(R(ctx, i.rs)) < 0, i.imm); }
+void Op_Bgezl(ExecContext& ctx, const Inst& i) { BranchLikely(ctx, int32_t(R(ctx, i.rs)) >= 0, i.imm); }
+void Op_Bltzall(ExecContext& ctx, const Inst& i) {
+    bool taken = int32_t(R(ctx, i.rs)) < 0;
+    ctx.gpr[REG_RA] = ctx.pc + 8;
+    BranchLikely(ctx, taken, i.imm);
+}
+void Op_Bgezall(ExecContext& ctx, const Inst& i) {
+    bool taken = int32_t(R(ctx, i.rs)) >= 0;
+    ctx.gpr[REG_RA] = ctx.pc + 8;
+    BranchLikely(ctx, taken, i.imm);
+}
+
+// --- Загрузка/сохранение ---
+
+inline uint32_t Addr(ExecContext& ctx, const Inst& i) { return R(ctx, i.rs) + i.imm; }
+
+// Ошибка доступа записывается Memory без исключения; здесь она доставляется
+// вызывающему Run() на холодном пути
+template <typename T>
+inline T Load(ExecContext& ctx, uint32_t addr) {
+    const T value = ctx.mem->Load<T, GuestAccess>(addr);
+    if (ctx.mem->HasFault()) [[unlikely]] ctx.mem->RaiseFault();
+    return value;
+}
+
+template <typename T>
+inline void Store(ExecContext& ctx, uint32_t addr, T value) {
+    ctx.mem->Store<T, GuestAccess>(addr, value);
+    if (ctx.mem->HasFault()) [[unlikely]] ctx.mem->RaiseFault();
+}
+
+void Op_Lb(ExecContext& ctx, const Inst& i)  { W(ctx, i.rt, uint32_t(int32_t(int8_t(Load<uint8_t>(ctx, Addr(ctx, i)))))); }
+void Op_Lbu(ExecContext& ctx, const Inst& i) { W(ctx, i.rt, Load<uint8_t>(ctx, Addr(ctx, i))); }
+void Op_Lh(ExecContext& ctx, const Inst& i)  { W(ctx, i.rt, uint32_t(int32_t(int16_t(Load<uint16_t>(ctx, Addr(ctx, i)))))); }
+void Op_Lhu(ExecContext& ctx, const Inst& i) { W(ctx, i.rt, Load<uint16_t>(ctx, Addr(ctx, i))); }
+void Op_Lw(ExecContext& ctx, const Inst& i)  { W(ctx, i.rt, Load<uint32_t>(ctx, Addr(ctx, i))); }
+void Op_Sb(ExecContext& ctx, const Inst& i)  { Store<uint8_t>(ctx, Addr(ctx, i), uint8_t(R(ctx, i.rt))); }
+void Op_Sh(ExecContext& ctx, const Inst& i)  { Store<uint16_t>(ctx, Addr(ctx, i), uint16_t(R(ctx, i.rt))); }
+void Op_Sw(ExecContext& ctx, const Inst& i)  { Store<uint32_t>(ctx, Addr(ctx, i), R(ctx, i.rt)); }
+
+// Невыровненные обращения (little-endian)
+void Op_Lwl(ExecContext& ctx, const Inst& i) {
+    uint32_t addr = Addr(ctx, i);
+    uint32_t shift = (addr & 3) * 8;
+    uint32_t mem = Load<uint32_t>(ctx, addr & ~3u);
+    W(ctx, i.rt, (R(ctx, i.rt) & (0x00FFFFFFu >> shift)) | (mem << (24 - shift)));
+}
+void Op_Lwr(ExecContext& ctx, const Inst& i) {
+    uint32_t addr = Addr(ctx, i);
+    uint32_t shift = (addr & 3) * 8;
+    uint32_t mem = Load<uint32_t>(ctx, addr & ~3u);
+    W(ctx, i.rt, (R(ctx, i.rt) & (0xFFFFFF00u << (24 - shift))) | (mem >> shift));
+}
+void Op_Swl(ExecContext& ctx, const Inst& i) {
+    uint32_t addr = Addr(ctx, i);
+    uint32_t shift = (addr & 3) * 8;
+    uint32_t mem = Load<uint32_t>(ctx, addr & ~3u);
+    Store<uint32_t>(ctx, addr & ~3u, (mem & (0xFFFFFF00u << shift)) | (R(ctx, i.rt) >> (24 - shift)));
+}
+void Op_Swr(ExecContext& ctx, const Inst& i) {
+    uint32_t addr = Addr(ctx, i);
+    uint32_t shift = (addr & 3) * 8;
+    uint32_t mem = Load<uint32_t>(ctx, addr & ~3u);
+    Store<uint32_t>(ctx, addr & ~3u, (mem & (0x00FFFFFFu >> (24 - shift))) | (R(ctx, i.rt) << shift));
+}
+void Op_Sc(ExecContext& ctx, const Inst& i) {
+    Store<uint32_t>(ctx, Addr(ctx, i), R(ctx, i.rt));
+    W(ctx, i.rt, 1);
+}
+
+// --- FPU (COP1): fs - в rd, ft - в rt, fd - в sa ---
+
+// FIR, как его видит cfc1 на PSP
+constexpr uint32_t FPU_FIR = 0x00003351;
+// Записываемые биты FCR31: режим округления, флаги, условие, FS
+constexpr uint32_t FCR31_MASK = 0x0181FFFF;
+
+inline float& F(ExecContext& ctx, uint8_t index) { return ctx.cpu->GetFPRPtr()[index]; }
+inline uint32_t& Fcr31(ExecContext& ctx) { return *ctx.cpu->GetFCR31Ptr(); }
+inline bool FpuCondition(ExecContext& ctx) { return (Fcr31(ctx) & CPUState::FCR31_CONDITION) != 0; }
+
+// Целое в регистре FPU; вне диапазона int32 и NaN дают 0x7FFFFFFF, как на PSP
+inline void SetFpuWord(ExecContext& ctx, uint8_t fd, float rounded) {
+    const bool inRange = rounded >= -2147483648.0f && rounded < 2147483648.0f;
+    F(ctx, fd) = std::bit_cast<float>(inRange ? uint32_t(int32_t(rounded)) : 0x7FFFFFFFu);
+}
+
+void Op_Lwc1(ExecContext& ctx, const Inst& i) { F(ctx, i.rt) = std::bit_cast<float>(Load<uint32_t>(ctx, Addr(ctx, i))); }
+void Op_Swc1(ExecContext& ctx, const Inst& i) { Store<uint32_t>(ctx, Addr(ctx, i), std::bit_cast<uint32_t>(F(ctx, i.rt))); }
+void Op_Mfc1(ExecContext& ctx, const Inst& i) { W(ctx, i.rt, std::bit_cast<uint32_t>(F(ctx, i.rd))); }
+void Op_Mtc1(ExecContext& ctx, const Inst& i) { F(ctx, i.rd) = std::bit_cast<float>(R(ctx, i.rt)); }
+void Op_Cfc1(ExecContext& ctx, const Inst& i) {
+    W(ctx, i.rt, i.rd == 31 ? Fcr31(ctx) : i.rd == 0 ? FPU_FIR : 0);
+}
+void Op_Ctc1(ExecContext& ctx, const Inst& i) {
+    if (i.rd == 31) Fcr31(ctx) = R(ctx, i.rt) & FCR31_MASK;
+}
+
+void Op_AddS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = F(ctx, i.rd) + F(ctx, i.rt); }
+void Op_SubS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = F(ctx, i.rd) - F(ctx, i.rt); }
+void Op_MulS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = F(ctx, i.rd) * F(ctx, i.rt); }
+void Op_DivS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = F(ctx, i.rd) / F(ctx, i.rt); }
+void Op_SqrtS(ExecContext& ctx, const Inst& i) { F(ctx, i.sa) = std::sqrt(F(ctx, i.rd)); }
+void Op_AbsS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = std::fabs(F(ctx, i.rd)); }
+void Op_MovS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = F(ctx, i.rd); }
+void Op_NegS(ExecContext& ctx, const Inst& i)  { F(ctx, i.sa) = -F(ctx, i.rd); }
+
+// round.w.s - к ближайшему чётному (режим хоста по умолчанию)
+void Op_RoundWS(ExecContext& ctx, const Inst& i) { SetFpuWord(ctx, i.sa, std::nearbyint(F(ctx, i.rd))); }
+void Op_TruncWS(ExecContext& ctx, const Inst& i) { SetFpuWord(ctx, i.sa, std::trunc(F(ctx, i.rd))); }
+void Op_CeilWS(ExecContext& ctx, const Inst& i)  { SetFpuWord(ctx, i.sa, std::ceil(F(ctx, i.rd))); }
+void Op_FloorWS(ExecContext& ctx, const Inst& i) { SetFpuWord(ctx, i.sa, std::floor(F(ctx, i.rd))); }
+// cvt.w.s - по режиму округления из FCR31
+void Op_CvtWS(ExecContext& ctx, const Inst& i) {
+    const float v = F(ctx, i.rd);
+    switch (Fcr31(ctx) & 3) {
+        case 0:  SetFpuWord(ctx, i.sa, std::nearbyint(v)); break;
+        case 1:  SetFpuWord(ctx, i.sa, std::trunc(v)); break;
+        case 2:  SetFpuWord(ctx, i.sa, std::ceil(v)); break;
+        default: SetFpuWord(ctx, i.sa, std::floor(v)); break;
+    }
+}
+void Op_CvtSW(ExecContext& ctx, const Inst& i) {
+    F(ctx, i.sa) = float(int32_t(std::bit_cast<uint32_t>(F(ctx, i.rd))));
+}
+
+// c.cond.s: imm - младшие биты funct (неупорядочено, равно, меньше)
+void Op_CmpS(ExecContext& ctx, const Inst& i) {
+    const float s = F(ctx, i.rd);
+    const float t = F(ctx, i.rt);
+    const bool unordered = std::isnan(s) || std::isnan(t);
+    const bool result = ((i.imm & 1) && unordered) || ((i.imm & 2) && s == t) || ((i.imm & 4) && s < t);
+    if (result) {
+        Fcr31(ctx) |= CPUState::FCR31_CONDITION;
+    } else {
+        Fcr31(ctx) &= ~CPUState::FCR31_CONDITION;
+    }
+}
+
+void Op_Bc1f(ExecContext& ctx, const Inst& i)  { Branch(ctx, !FpuCondition(ctx), i.imm); }
+void Op_Bc1t(ExecContext& ctx, const Inst& i)  { Branch(ctx, FpuCondition(ctx), i.imm); }
+void Op_Bc1fl(ExecContext& ctx, const Inst& i) { BranchLikely(ctx, !FpuCondition(ctx), i.imm); }
+void Op_Bc1tl(ExecContext& ctx, const Inst& i) { BranchLikely(ctx, FpuCondition(ctx), i.imm); }
+
+// --- Системные ---
+
+void Op_Nop(ExecContext&, const Inst&) {}
+
+void Op_Syscall(ExecContext& ctx, const Inst& i) {
+    // HLE видит PC возврата и может его изменить (например, выход из игры или
+    // переключение потока). В delay slot это цель перехода, уже в ctx.nextPC
+    *ctx.cpu->GetPCPtr() = ctx.nextPC;
+    if (ctx.syscall) {
+        ctx.syscall(ctx.cpu, i.imm);
+    }
+    ctx.nextPC = *ctx.cpu->GetPCPtr();
+}
+
+void Op_Break(ExecContext& ctx, const Inst&) {
+    throw CPUError("BREAK at PC=" + std::to_string(ctx.pc));
+}
+
+void Op_Unknown(ExecContext& ctx, const Inst& i) {
+    throw CPUError("Unimplemented instruction " + std::to_string(i.imm) +
+                   " at PC=" + std::to_string(ctx.pc));
+}
+
+InstHandler HandlerFor(InstId id) {
+    switch (id) {
+        case InstId::Sll:     return Op_Sll;
+        case InstId::Srl:     return Op_Srl;
+        case InstId::Rotr:    return Op_Rotr;
+        case InstId::Sra:     return Op_Sra;
+        case InstId::Sllv:    return Op_Sllv;
+        case InstId::Srlv:    return Op_Srlv;
+        case InstId::Rotrv:   return Op_Rotrv;
+        case InstId::Srav:    return Op_Srav;
+        case InstId::Jr:      return Op_Jr;
+        case InstId::Jalr:    return Op_Jalr;
+        case InstId::Movz:    return Op_Movz;
+        case InstId::Movn:    return Op_Movn;
+        case InstId::Syscall: return Op_Syscall;
+        case InstId::Break:   return Op_Break;
+        case InstId::Sync:    return Op_Nop;
+        case InstId::Mfhi:    return Op_Mfhi;
+        case InstId::Mthi:    return Op_Mthi;
+        case InstId::Mflo:    return Op_Mflo;
+        case InstId::Mtlo:    return Op_Mtlo;
+        case InstId::Clz:     return Op_Clz;
+        case InstId::Clo:     return Op_Clo;
+        case InstId::Mult:    return Op_Mult;
+        case InstId::Multu:   return Op_Multu;
+        case InstId::Div:     return Op_Div;
+        case InstId::Divu:    return Op_Divu;
+        case InstId::Madd:    return Op_Madd;
+        case InstId::Maddu:   return Op_Maddu;
+        case InstId::Msub:    return Op_Msub;
+        case InstId::Msubu:   return Op_Msubu;
+        case InstId::Add:     return Op_Addu;  // исключение переполнения не эмулируется
+        case InstId::Addu:    return Op_Addu;
+        case InstId::Sub:     return Op_Subu;
+        case InstId::Subu:    return Op_Subu;
+        case InstId::And:     return Op_And;
+        case InstId::Or:      return Op_Or;
+        case InstId::Xor:     return Op_Xor;
+        case InstId::Nor:     return Op_Nor;
+        case InstId::Slt:     return Op_Slt;
+        case InstId::Sltu:    return Op_Sltu;
+        case InstId::Max:     return Op_Max;
+        case InstId::Min:     return Op_Min;
+
+        case InstId::Bltz:    return Op_Bltz;
+        case InstId::Bgez:    return Op_Bgez;
+        case InstId::Bltzl:   return Op_Bltzl;
+        case InstId::Bgezl:   return Op_Bgezl;
+        case InstId::Bltzal:  return Op_Bltzal;
+        case InstId::Bgezal:  return Op_Bgezal;
+        case InstId::Bltzall: return Op_Bltzall;
+        case InstId::Bgezall: return Op_Bgezall;
+
+        case InstId::J:       return Op_J;
+        case InstId::Jal:     return Op_Jal;
+        case InstId::Beq:     return Op_Beq;
+        case InstId::Bne:     return Op_Bne;
+        case InstId::Blez:    return Op_Blez;
+        case InstId::Bgtz:    return Op_Bgtz;
+        case InstId::Beql:    return Op_Beql;
+        case InstId::Bnel:    return Op_Bnel;
+        case InstId::Blezl:   return Op_Blezl;
+        case InstId::Bgtzl:   return Op_Bgtzl;
+        case InstId::Addi:    return Op_Addiu;  // без исключения переполнения
+        case InstId::Addiu:   return Op_Addiu;
+        case InstId::Slti:    return Op_Slti;
+        case InstId::Sltiu:   return Op_Sltiu;
+        case InstId::Andi:    return Op_Andi;
+        case InstId::Ori:     return Op_Ori;
+        case InstId::Xori:    return Op_Xori;
+        case InstId::Lui:     return Op_Lui;
+
+        case InstId::Lb:      return Op_Lb;
+        case InstId::Lh:      return Op_Lh;
+        case InstId::Lwl:     return Op_Lwl;
+        case InstId::Lw:      return Op_Lw;
+        case InstId::Lbu:     return Op_Lbu;
+        case InstId::Lhu:     return Op_Lhu;
+        case InstId::Lwr:     return Op_Lwr;
+        case InstId::Sb:      return Op_Sb;
+        case InstId::Sh:      return Op_Sh;
+        case InstId::Swl:     return Op_Swl;
+        case InstId::Sw:      return Op_Sw;
+        case InstId::Swr:     return Op_Swr;
+        case InstId::Cache:   return Op_Nop;
+        case InstId::Ll:      return Op_Lw;
+        case InstId::Sc:      return Op_Sc;
+
+        case InstId::Ext:     return Op_Ext;
+        case InstId::Ins:     return Op_Ins;
+        case InstId::Wsbh:    return Op_Wsbh;
+        case InstId::Wsbw:    return Op_Wsbw;
+        case InstId::Seb:     return Op_Seb;
+        case InstId::Seh:     return Op_Seh;
+        case InstId::Bitrev:  return Op_Bitrev;
+
+        case InstId::Mfc1:    return Op_Mfc1;
+        case InstId::Cfc1:    return Op_Cfc1;
+        case InstId::Mtc1:    return Op_Mtc1;
+        case InstId::Ctc1:    return Op_Ctc1;
+        case InstId::Bc1f:    return Op_Bc1f;
+        case InstId::Bc1t:    return Op_Bc1t;
+        case InstId::Bc1fl:   return Op_Bc1fl;
+        case InstId::Bc1tl:   return Op_Bc1tl;
+        case InstId::AddS:    return Op_AddS;
+        case InstId::SubS:    return Op_SubS;
+        case InstId::MulS:    return Op_MulS;
+        case InstId::DivS:    return Op_DivS;
+        case InstId::SqrtS:   return Op_SqrtS;
+        case InstId::AbsS:    return Op_AbsS;
+        case InstId::MovS:    return Op_MovS;
+        case InstId::NegS:    return Op_NegS;
+        case InstId::RoundWS: return Op_RoundWS;
+        case InstId::TruncWS: return Op_TruncWS;
+        case InstId::CeilWS:  return Op_CeilWS;
+        case InstId::FloorWS: return Op_FloorWS;
+        case InstId::CvtWS:   return Op_CvtWS;
+        case InstId::CvtSW:   return Op_CvtSW;
+        case InstId::CmpS:    return Op_CmpS;
+        case InstId::Lwc1:    return Op_Lwc1;
+        case InstId::Swc1:    return Op_Swc1;
+
+        // COP0 и VFPU не эмулируются: Op_Unknown с исходным словом
+        default:              return Op_Unknown;
+    }
+}
+
+}  // namespace
+
+Inst Interpreter::Predecode(uint32_t pc, const Decoded& d) {
+    Inst inst;
+    inst.handler = HandlerFor(d.Id());
+    inst.rs = d.Rs();
+    inst.rt = d.Rt();
+    inst.rd = d.Rd();
+    inst.sa = d.Shamt();
+    inst.imm = d.SImm();
+
+    switch (d.Id()) {
+        case InstId::J:
+        case InstId::Jal:
+            inst.imm = d.JumpTarget(pc);
+            break;
+        case InstId::Andi:
+        case InstId::Ori:
+        case InstId::Xori:
+            inst.imm = d.Imm();
+            break;
+        case InstId::Lui:
+            inst.imm = uint32_t(d.Imm()) << 16;
+            break;
+        case InstId::Syscall:
+            inst.imm = (d.word >> 6) & 0xFFFFF;
+            break;
+        case InstId::CmpS:
+            inst.imm = d.Funct() & 15;
+            break;
+        default:
+            // Условные переходы: абсолютный адрес цели
+            if ((d.Flags() & IF_BRANCH) && !(d.Flags() & IF_JUMP_REG)) {
+                inst.imm = d.BranchTarget(pc);
+            }
+            break;
+    }
+
+    // Для нереализованных инструкций сохраняем слово для диагностики
+    if (inst.handler == Op_Unknown) {
+        inst.imm = d.word;
+    }
+    return inst;
+}
+
+Inst Interpreter::Lower(const IRInst& ir) {
+    Inst inst = {};
+    inst.handler = Op_Nop;
+    inst.imm = ir.imm;
+
+    // Трёхоперандная форма rd = rs op rt
+    auto rrr = [&](InstHandler h) {
+        inst.handler = h;
+        inst.rd = ir.dst;
+        inst.rs = ir.src1;
+        inst.rt = ir.src2;
+    };
+    // Непосредственная форма rt = rs op imm (также загрузки)
+    auto rri = [&](InstHandler h) {
+        inst.handler = h;
+        inst.rt = ir.dst;
+        inst.rs = ir.src1;
+    };
+    // Сдвиги: значение в rt, величина в sa или rs
+    auto shift = [&](InstHandler h) {
+        inst.handler = h;
+        inst.rd = ir.dst;
+        inst.rt = ir.src1;
+        inst.rs = ir.src2;
+        inst.sa = uint8_t(ir.imm & 31);
+    };
+    // Сохранения и переходы: rs, rt - источники
+    auto src = [&](InstHandler h) {
+        inst.handler = h;
+        inst.rs = ir.src1;
+        inst.rt = ir.src2;
+    };
+    const bool likely = (ir.flags & IR_LIKELY) != 0;
+    const bool link = (ir.flags & IR_LINK) != 0;
+
+    switch (ir.op) {
+        case IROp::Nop: break;
+        case IROp::SetConst: rri(Op_Lui); break;
+        case IROp::Mov: rrr(Op_Or); inst.rt = 0; break;
+
+        case IROp::Add:  rrr(Op_Addu); break;
+        case IROp::Sub:  rrr(Op_Subu); break;
+        case IROp::And:  rrr(Op_And); break;
+        case IROp::Or:   rrr(Op_Or); break;
+        case IROp::Xor:  rrr(Op_Xor); break;
+        case IROp::Nor:  rrr(Op_Nor); break;
+        case IROp::Slt:  rrr(Op_Slt); break;
+        case IROp::Sltu: rrr(Op_Sltu); break;
+
+        case IROp::AddI:  rri(Op_Addiu); break;
+        case IROp::AndI:  rri(Op_Andi); break;
+        case IROp::OrI:   rri(Op_Ori); break;
+        case IROp::XorI:  rri(Op_Xori); break;
+        case IROp::SltI:  rri(Op_Slti); break;
+        case IROp::SltuI: rri(Op_Sltiu); break;
+
+        case IROp::ShlI: shift(Op_Sll); break;
+        case IROp::ShrI: shift(Op_Srl); break;
+        case IROp::SarI: shift(Op_Sra); break;
+        case IROp::RorI: shift(Op_Rotr); break;
+        case IROp::Shl:  shift(Op_Sllv); break;
+        case IROp::Shr:  shift(Op_Srlv); break;
+        case IROp::Sar:  shift(Op_Srav); break;
+        case IROp::Ror:  shift(Op_Rotrv); break;
+
+        case IROp::MfHi: rrr(Op_Mfhi); break;
+        case IROp::MfLo: rrr(Op_Mflo); break;
+        case IROp::MtHi: src(Op_Mthi); break;
+        case IROp::MtLo: src(Op_Mtlo); break;
+        case IROp::Mult:  src(Op_Mult); break;
+        case IROp::Multu: src(Op_Multu); break;
+
+        case IROp::Load8S:  rri(Op_Lb); break;
+        case IROp::Load8U:  rri(Op_Lbu); break;
+        case IROp::Load16S: rri(Op_Lh); break;
+        case IROp::Load16U: rri(Op_Lhu); break;
+        case IROp::Load32:  rri(Op_Lw); break;
+        case IROp::Store8:  src(Op_Sb); break;
+        case IROp::Store16: src(Op_Sh); break;
+        case IROp::Store32: src(Op_Sw); break;
+
+        case IROp::Jump: inst.handler = link ? Op_Jal : Op_J; break;
+        case IROp::JumpReg:
+            src(ir.dst != 0 ? Op_Jalr : Op_Jr);
+            inst.rd = ir.dst;
+            break;
+        case IROp::Beq:  src(likely ? Op_Beql : Op_Beq); break;
+        case IROp::Bne:  src(likely ? Op_Bnel : Op_Bne); break;
+        case IROp::Blez: src(likely ? Op_Blezl : Op_Blez); break;
+        case IROp::Bgtz: src(likely ? Op_Bgtzl : Op_Bgtz); break;
+        case IROp::Bltz:
+            src(link ? (likely ? Op_Bltzall : Op_Bltzal) : (likely ? Op_Bltzl : Op_Bltz));
+            break;
+        case IROp::Bgez:
+            src(link ? (likely ? Op_Bgezall : Op_Bgezal) : (likely ? Op_Bgezl : Op_Bgez));
+            break;
+
+        case IROp::Syscall: inst.handler = Op_Syscall; break;
+        case IROp::Interp: return Predecode(ir.pc, Decoder(true).Decode(ir.imm));
+    }
+    return inst;
+}
+
+Interpreter::Interpreter(CPUState& cpu, Memory& memory, BlockCache& blocks)
+    : cpu_(cpu), memory_(memory), blocks_(blocks) {
+    ctx_.cpu = &cpu_;
+    ctx_.gpr = cpu_.GetGPRPtr();
+    ctx_.mem = &memory_;
+    ctx_.syscall = &syscall::HandleSyscall;
+}
+
+uint32_t Interpreter::ExecuteBlock(const Block& block, int64_t& executed) {
+    const Inst* insts = blocks_.GetInsts(block);
+    const IRInst* ir = blocks_.GetIR(block);
+
+    // После оптимизации IR инструкции не идут подряд, поэтому PC берётся из IR,
+    // а счёт инструкций гостя - по адресу точки выхода
+    for (uint32_t n = 0; n < block.numInsts; ++n) {
+        const Inst& inst = insts[n];
+        const uint32_t pc = ir[n].pc;
+        ctx_.pc = pc;
+        ctx_.nextPC = pc + 4;
+        inst.handler(ctx_, inst);
+
+        if (ctx_.branchPending) {
+            // Delay slot - следующая инструкция того же блока; syscall в нём
+            // может сменить цель перехода
+            ctx_.branchPending = false;
+            const Inst& slot = insts[n + 1];
+            ctx_.pc = pc + 4;
+            ctx_.nextPC = ctx_.branchTarget;
+            slot.handler(ctx_, slot);
+            executed += (pc - block.startPC) / 4 + 2;
+            return ctx_.nextPC;
+        }
+        if (ctx_.nextPC != pc + 4) {
+            // Невыполненный likely-переход или syscall сменил PC
+            executed += (pc - block.startPC) / 4 + 1;
+            return ctx_.nextPC;
+        }
+    }
+    executed += (block.endPC - block.startPC) / 4;
+    return block.endPC;
+}
+
+void Interpreter::Step() {
+    Run(1);
+}
+
+int64_t Interpreter::Run(int64_t cycles) {
+    ctx_.gpr = cpu_.GetGPRPtr();
+    uint32_t pc = cpu_.GetPC();
+    int64_t executed = 0;
+
+    while (executed < cycles && pc != CPUState::INVALID_PC) {
+        const Block& block = blocks_.GetOrCompile(pc);
+        ctx_.downcount = cycles - executed;
+        pc = ExecuteBlock(block, executed);
+
+        // Цикл ожидания не завершится до внешнего события: остаток бюджета
+        // засчитывается как прошедшее время гостя
+        if (block.idleLoop && pc == block.startPC && executed < cycles) {
+            executed = cycles;
+            ++idleSkipCount_;
+        }
+    }
+
+    ctx_.downcount = cycles - executed;
+    *cpu_.GetPCPtr() = pc;
+    instructionCount_ += uint64_t(executed);
+    return executed;
+}
+
+}  // namespace core
+}  // namespace ppsspp
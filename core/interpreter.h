@@ -0,0 +1,97 @@
+// core/interpreter.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "cpu_state.h"
+#include "decoder.h"
+
+namespace ppsspp {
+namespace core {
+
+class Memory;
+class BlockCache;
+struct Block;
+struct Inst;
+struct IRInst;
+struct ExecContext;
+
+// Обработчик предекодированной инструкции
+using InstHandler = void (*)(ExecContext& ctx, const Inst& inst);
+
+// Точка выхода в HLE при инструкции syscall
+using SyscallHook = void (*)(CPUState* st, uint32_t code);
+
+// Компактная запись предекодированной инструкции: обработчик + операнды.
+// imm уже расширен (знаково или нулями) либо содержит абсолютный адрес перехода,
+// поэтому обработчику не нужно ничего извлекать из исходного слова.
+struct Inst {
+    InstHandler handler;
+    uint8_t rs, rt, rd, sa;
+    uint32_t imm;
+};
+
+// Состояние исполнения, общее для всех обработчиков
+struct ExecContext {
+    uint32_t* gpr = nullptr;
+    CPUState* cpu = nullptr;
+    Memory* mem = nullptr;
+    SyscallHook syscall = nullptr;
+
+    uint32_t pc = 0;            // PC текущей инструкции
+    uint32_t nextPC = 0;        // PC следующей инструкции
+    uint32_t branchTarget = 0;  // Цель перехода после delay slot
+    bool branchPending = false; // Выполнен переход, следующий - delay slot
+    int64_t downcount = 0;      // Остаток бюджета циклов
+};
+
+class Interpreter {
+public:
+    Interpreter(CPUState& cpu, Memory& memory, BlockCache& blocks);
+    ~Interpreter() = default;
+
+    // Запрещаем копирование
+    Interpreter(const Interpreter&) = delete;
+    Interpreter& operator=(const Interpreter&) = delete;
+
+    // Исполняет инструкции, пока не исчерпан бюджет циклов или PC не стал INVALID_PC.
+    // Возвращает количество исполненных инструкций.
+    int64_t Run(int64_t cycles);
+
+    // Исполняет один базовый блок
+    void Step();
+
+    void SetSyscallHook(SyscallHook hook) { ctx_.syscall = hook; }
+
+    // Остаток бюджета Run(), обновляется перед каждым блоком
+    const int64_t* GetDowncountPtr() const { return &ctx_.downcount; }
+
+    // Количество исполненных инструкций с момента создания
+    uint64_t GetInstructionCount() const { return instructionCount_; }
+
+    // Сколько раз остаток бюджета был пропущен в цикле ожидания
+    uint64_t GetIdleSkipCount() const { return idleSkipCount_; }
+
+    // Превращает декодированную инструкцию по адресу pc в запись для диспетчеризации
+    static Inst Predecode(uint32_t pc, const Decoded& d);
+
+    // Превращает инструкцию IR в запись для диспетчеризации
+    static Inst Lower(const IRInst& ir);
+
+private:
+    // Исполняет блок, возвращает PC следующего блока
+    uint32_t ExecuteBlock(const Block& block, int64_t& executed);
+
+    CPUState& cpu_;
+    Memory& memory_;
+    BlockCache& blocks_;
+    ExecContext ctx_;
+
+    uint64_t instructionCount_ = 0;
+    uint64_t idleSkipCount_ = 0;
+};
+
+}  // namespace core
+}  // namespace ppsspp
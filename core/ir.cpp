@@ -0,0 +1,604 @@
+// core/ir.cpp
+
+#include "ir.h"
+#include "memory.h"
+
+#include <bit>
+
+namespace ppsspp {
+namespace core {
+
+namespace {
+
+constexpr uint8_t REG_RA = 31;
+constexpr uint32_t ALL_REGS = 0xFFFFFFFF;
+
+inline uint32_t Bit(uint8_t reg) { return 1u << reg; }
+
+IRInst Make(IROp op, uint32_t pc, uint8_t dst, uint8_t src1, uint8_t src2, uint32_t imm) {
+    IRInst ir;
+    ir.op = op;
+    ir.dst = dst;
+    ir.src1 = src1;
+    ir.src2 = src2;
+    ir.imm = imm;
+    ir.pc = pc;
+    return ir;
+}
+
+// Операции без побочных эффектов, единственный результат которых - dst
+bool IsPure(IROp op) {
+    switch (op) {
+        case IROp::SetConst: case IROp::Mov:
+        case IROp::Add: case IROp::Sub: case IROp::And: case IROp::Or:
+        case IROp::Xor: case IROp::Nor: case IROp::Slt: case IROp::Sltu:
+        case IROp::AddI: case IROp::AndI: case IROp::OrI: case IROp::XorI:
+        case IROp::SltI: case IROp::SltuI:
+        case IROp::ShlI: case IROp::ShrI: case IROp::SarI: case IROp::RorI:
+        case IROp::Shl: case IROp::Shr: case IROp::Sar: case IROp::Ror:
+        case IROp::MfHi: case IROp::MfLo:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool IsLoad(IROp op) {
+    return op >= IROp::Load8S && op <= IROp::Load32;
+}
+
+bool IsStore(IROp op) {
+    return op >= IROp::Store8 && op <= IROp::Store32;
+}
+
+// Флаги классификации исходной инструкции для Interp
+uint32_t InterpFlags(const IRInst& ir) {
+    return GetInstInfo(LookupInstId(ir.imm)).flags;
+}
+
+// Инструкции, которые могут читать и писать любые регистры или менять поток
+// управления. Остальные Interp имеют точные маски чтения/записи из таблицы декодера.
+bool IsBarrier(const IRInst& ir) {
+    if (ir.op == IROp::Syscall) return true;
+    if (ir.op != IROp::Interp) return false;
+    const InstId id = LookupInstId(ir.imm);
+    return id == InstId::Invalid ||
+           (GetInstInfo(id).flags & (IF_TERMINATOR | IF_BRANCH | IF_COP0)) != 0;
+}
+
+bool HasTwoSources(IROp op) {
+    switch (op) {
+        case IROp::Add: case IROp::Sub: case IROp::And: case IROp::Or:
+        case IROp::Xor: case IROp::Nor: case IROp::Slt: case IROp::Sltu:
+        case IROp::Shl: case IROp::Shr: case IROp::Sar: case IROp::Ror:
+        case IROp::Mult: case IROp::Multu:
+        case IROp::Store8: case IROp::Store16: case IROp::Store32:
+        case IROp::Beq: case IROp::Bne:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool HasSource1(IROp op) {
+    switch (op) {
+        case IROp::Nop: case IROp::SetConst: case IROp::MfHi: case IROp::MfLo:
+        case IROp::Jump: case IROp::Syscall: case IROp::Interp:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// Регистры, читаемые инструкцией (без учёта барьеров)
+uint32_t UseMask(const IRInst& ir) {
+    if (ir.op == IROp::Interp) return GprReadMask(ir.imm, InterpFlags(ir));
+    uint32_t mask = 0;
+    if (HasSource1(ir.op)) mask |= Bit(ir.src1);
+    if (HasTwoSources(ir.op)) mask |= Bit(ir.src2);
+    return mask & ~1u;
+}
+
+// Регистр, записываемый инструкцией; 0 - нет записи
+uint8_t DefReg(const IRInst& ir) {
+    if (IsPure(ir.op) || IsLoad(ir.op) || ir.op == IROp::JumpReg) return ir.dst;
+    if (ir.flags & IR_LINK) return REG_RA;
+    return 0;
+}
+
+// Все регистры, которые инструкция может записать
+uint32_t DefMask(const IRInst& ir) {
+    if (ir.op == IROp::Interp) return GprWriteMask(ir.imm, InterpFlags(ir));
+    return Bit(DefReg(ir)) & ~1u;
+}
+
+uint32_t Rotr(uint32_t v, uint32_t s) {
+    s &= 31;
+    return s ? (v >> s) | (v << (32 - s)) : v;
+}
+
+// Вычисление чистой операции над известными операндами
+uint32_t Evaluate(IROp op, uint32_t a, uint32_t b, uint32_t imm) {
+    switch (op) {
+        case IROp::SetConst: return imm;
+        case IROp::Mov:  return a;
+        case IROp::Add:  return a + b;
+        case IROp::Sub:  return a - b;
+        case IROp::And:  return a & b;
+        case IROp::Or:   return a | b;
+        case IROp::Xor:  return a ^ b;
+        case IROp::Nor:  return ~(a | b);
+        case IROp::Slt:  return int32_t(a) < int32_t(b) ? 1 : 0;
+        case IROp::Sltu: return a < b ? 1 : 0;
+        case IROp::AddI: return a + imm;
+        case IROp::AndI: return a & imm;
+        case IROp::OrI:  return a | imm;
+        case IROp::XorI: return a ^ imm;
+        case IROp::SltI: return int32_t(a) < int32_t(imm) ? 1 : 0;
+        case IROp::SltuI: return a < imm ? 1 : 0;
+        case IROp::ShlI: return a << (imm & 31);
+        case IROp::ShrI: return a >> (imm & 31);
+        case IROp::SarI: return uint32_t(int32_t(a) >> (imm & 31));
+        case IROp::RorI: return Rotr(a, imm);
+        case IROp::Shl:  return a << (b & 31);
+        case IROp::Shr:  return a >> (b & 31);
+        case IROp::Sar:  return uint32_t(int32_t(a) >> (b & 31));
+        case IROp::Ror:  return Rotr(a, b);
+        default:         return 0;
+    }
+}
+
+enum class Simplified { None, Folded, Removed };
+
+void MakeNop(IRInst& ir) {
+    ir.op = IROp::Nop;
+    ir.dst = ir.src1 = ir.src2 = 0;
+    ir.imm = 0;
+}
+
+void MakeConst(IRInst& ir, uint32_t value) {
+    ir.op = IROp::SetConst;
+    ir.src1 = ir.src2 = 0;
+    ir.imm = value;
+}
+
+void MakeMov(IRInst& ir, uint8_t src) {
+    ir.op = IROp::Mov;
+    ir.src1 = src;
+    ir.src2 = 0;
+    ir.imm = 0;
+}
+
+// Тождественные формы: op x, 0 и пересылка регистра в себя
+Simplified SimplifyIdentity(IRInst& ir) {
+    switch (ir.op) {
+        case IROp::AddI: case IROp::OrI: case IROp::XorI:
+        case IROp::ShlI: case IROp::ShrI: case IROp::SarI: case IROp::RorI:
+            if ((ir.imm & (ir.op >= IROp::ShlI ? 31u : ALL_REGS)) != 0) return Simplified::None;
+            break;
+        case IROp::Mov:
+            break;
+        default:
+            return Simplified::None;
+    }
+    if (ir.dst == ir.src1) {
+        MakeNop(ir);
+        return Simplified::Removed;
+    }
+    if (ir.op == IROp::Mov) return Simplified::None;
+    MakeMov(ir, ir.src1);
+    return Simplified::Folded;
+}
+
+// Замена на пересылку; пересылка регистра в себя удаляется
+Simplified FoldToMov(IRInst& ir, uint8_t src) {
+    if (ir.dst == src) {
+        MakeNop(ir);
+        return Simplified::Removed;
+    }
+    MakeMov(ir, src);
+    return Simplified::Folded;
+}
+
+void Count(IRPassStats& stats, Simplified result) {
+    if (result == Simplified::Folded) ++stats.folded;
+    if (result == Simplified::Removed) ++stats.removed;
+}
+
+}  // namespace
+
+bool IsIRBranch(IROp op) {
+    return op >= IROp::Jump && op <= IROp::Bgez;
+}
+
+IRInst LowerToIR(uint32_t pc, const Decoded& d) {
+    const uint32_t target = d.BranchTarget(pc);
+    const uint32_t simm = d.SImm();
+    const uint8_t rs = d.Rs(), rt = d.Rt(), rd = d.Rd();
+
+    IRInst ir;
+    switch (d.Id()) {
+        case InstId::Sll:   return Make(IROp::ShlI, pc, rd, rt, 0, d.Shamt());
+        case InstId::Srl:   return Make(IROp::ShrI, pc, rd, rt, 0, d.Shamt());
+        case InstId::Rotr:  return Make(IROp::RorI, pc, rd, rt, 0, d.Shamt());
+        case InstId::Sra:   return Make(IROp::SarI, pc, rd, rt, 0, d.Shamt());
+        case InstId::Sllv:  return Make(IROp::Shl, pc, rd, rt, rs, 0);
+        case InstId::Srlv:  return Make(IROp::Shr, pc, rd, rt, rs, 0);
+        case InstId::Rotrv: return Make(IROp::Ror, pc, rd, rt, rs, 0);
+        case InstId::Srav:  return Make(IROp::Sar, pc, rd, rt, rs, 0);
+        case InstId::Jr:    return Make(IROp::JumpReg, pc, 0, rs, 0, 0);
+        case InstId::Jalr:  return Make(IROp::JumpReg, pc, rd, rs, 0, 0);
+        case InstId::Syscall: return Make(IROp::Syscall, pc, 0, 0, 0, (d.word >> 6) & 0xFFFFF);
+        case InstId::Sync:  return Make(IROp::Nop, pc, 0, 0, 0, 0);
+        case InstId::Cache: return Make(IROp::Nop, pc, 0, 0, 0, 0);
+        case InstId::Mfhi:  return Make(IROp::MfHi, pc, rd, 0, 0, 0);
+        case InstId::Mthi:  return Make(IROp::MtHi, pc, 0, rs, 0, 0);
+        case InstId::Mflo:  return Make(IROp::MfLo, pc, rd, 0, 0, 0);
+        case InstId::Mtlo:  return Make(IROp::MtLo, pc, 0, rs, 0, 0);
+        case InstId::Mult:  return Make(IROp::Mult, pc, 0, rs, rt, 0);
+        case InstId::Multu: return Make(IROp::Multu, pc, 0, rs, rt, 0);
+        case InstId::Add: case InstId::Addu: return Make(IROp::Add, pc, rd, rs, rt, 0);
+        case InstId::Sub: case InstId::Subu: return Make(IROp::Sub, pc, rd, rs, rt, 0);
+        case InstId::And:   return Make(IROp::And, pc, rd, rs, rt, 0);
+        case InstId::Or:    return Make(IROp::Or, pc, rd, rs, rt, 0);
+        case InstId::Xor:   return Make(IROp::Xor, pc, rd, rs, rt, 0);
+        case InstId::Nor:   return Make(IROp::Nor, pc, rd, rs, rt, 0);
+        case InstId::Slt:   return Make(IROp::Slt, pc, rd, rs, rt, 0);
+        case InstId::Sltu:  return Make(IROp::Sltu, pc, rd, rs, rt, 0);
+
+        case InstId::Bltz: case InstId::Bltzl: case InstId::Bltzal: case InstId::Bltzall:
+            ir = Make(IROp::Bltz, pc, 0, rs, 0, target);
+            break;
+        case InstId::Bgez: case InstId::Bgezl: case InstId::Bgezal: case InstId::Bgezall:
+            ir = Make(IROp::Bgez, pc, 0, rs, 0, target);
+            break;
+        case InstId::J: case InstId::Jal:
+            ir = Make(IROp::Jump, pc, 0, 0, 0, d.JumpTarget(pc));
+            break;
+        case InstId::Beq: case InstId::Beql:   ir = Make(IROp::Beq, pc, 0, rs, rt, target); break;
+        case InstId::Bne: case InstId::Bnel:   ir = Make(IROp::Bne, pc, 0, rs, rt, target); break;
+        case InstId::Blez: case InstId::Blezl: ir = Make(IROp::Blez, pc, 0, rs, 0, target); break;
+        case InstId::Bgtz: case InstId::Bgtzl: ir = Make(IROp::Bgtz, pc, 0, rs, 0, target); break;
+
+        case InstId::Addi: case InstId::Addiu: return Make(IROp::AddI, pc, rt, rs, 0, simm);
+        case InstId::Slti:  return Make(IROp::SltI, pc, rt, rs, 0, simm);
+        case InstId::Sltiu: return Make(IROp::SltuI, pc, rt, rs, 0, simm);
+        case InstId::Andi:  return Make(IROp::AndI, pc, rt, rs, 0, d.Imm());
+        case InstId::Ori:   return Make(IROp::OrI, pc, rt, rs, 0, d.Imm());
+        case InstId::Xori:  return Make(IROp::XorI, pc, rt, rs, 0, d.Imm());
+        case InstId::Lui:   return Make(IROp::SetConst, pc, rt, 0, 0, uint32_t(d.Imm()) << 16);
+
+        case InstId::Lb:  return Make(IROp::Load8S, pc, rt, rs, 0, simm);
+        case InstId::Lh:  return Make(IROp::Load16S, pc, rt, rs, 0, simm);
+        case InstId::Lw:  return Make(IROp::Load32, pc, rt, rs, 0, simm);
+        case InstId::Ll:  return Make(IROp::Load32, pc, rt, rs, 0, simm);
+        case InstId::Lbu: return Make(IROp::Load8U, pc, rt, rs, 0, simm);
+        case InstId::Lhu: return Make(IROp::Load16U, pc, rt, rs, 0, simm);
+        case InstId::Sb:  return Make(IROp::Store8, pc, 0, rs, rt, simm);
+        case InstId::Sh:  return Make(IROp::Store16, pc, 0, rs, rt, simm);
+        case InstId::Sw:  return Make(IROp::Store32, pc, 0, rs, rt, simm);
+
+        default: return Make(IROp::Interp, pc, 0, 0, 0, d.word);
+    }
+
+    // Переходы: флаги берутся из таблицы декодирования
+    if (d.Flags() & IF_LIKELY) ir.flags |= IR_LIKELY;
+    if (d.Flags() & IF_LINK) ir.flags |= IR_LINK;
+    return ir;
+}
+
+// Запись в $zero не имеет эффекта, чтение $zero даёт константу 0
+IRPassStats FoldZeroRegister(std::vector<IRInst>& block) {
+    IRPassStats stats;
+    for (IRInst& ir : block) {
+        if (IsPure(ir.op) && ir.dst == 0) {
+            MakeNop(ir);
+            ++stats.removed;
+            continue;
+        }
+
+        const bool zero1 = HasSource1(ir.op) && ir.src1 == 0;
+        const bool zero2 = HasTwoSources(ir.op) && ir.src2 == 0;
+        switch (ir.op) {
+            case IROp::Add: case IROp::Or: case IROp::Xor:
+                if (zero1 && zero2) {
+                    MakeConst(ir, 0);
+                    ++stats.folded;
+                } else if (zero1 || zero2) {
+                    Count(stats, FoldToMov(ir, zero1 ? ir.src2 : ir.src1));
+                }
+                break;
+            case IROp::Sub: case IROp::Shl: case IROp::Shr: case IROp::Sar: case IROp::Ror:
+                if (zero2) {
+                    Count(stats, FoldToMov(ir, ir.src1));
+                }
+                break;
+            case IROp::And:
+                if (zero1 || zero2) {
+                    MakeConst(ir, 0);
+                    ++stats.folded;
+                }
+                break;
+            case IROp::AddI: case IROp::OrI: case IROp::XorI:
+                if (zero1) {
+                    MakeConst(ir, ir.imm);
+                    ++stats.folded;
+                    break;
+                }
+                Count(stats, SimplifyIdentity(ir));
+                break;
+            case IROp::Mov:
+                if (zero1) {
+                    MakeConst(ir, 0);
+                    ++stats.folded;
+                    break;
+                }
+                Count(stats, SimplifyIdentity(ir));
+                break;
+            default:
+                Count(stats, SimplifyIdentity(ir));
+                break;
+        }
+    }
+    return stats;
+}
+
+// Прямой проход с известными значениями регистров: lui/ori и подобные цепочки
+// сворачиваются в SetConst, операнды-константы переносятся в непосредственные формы
+IRPassStats PropagateConstants(std::vector<IRInst>& block) {
+    IRPassStats stats;
+    uint32_t known = 1;     // $zero всегда известен
+    uint32_t values[32] = {};
+
+    for (IRInst& ir : block) {
+        if (IsBarrier(ir)) {
+            known = 1;
+            continue;
+        }
+
+        if (IsPure(ir.op) && ir.op != IROp::SetConst && ir.op != IROp::MfHi && ir.op != IROp::MfLo) {
+            const bool k1 = (known & Bit(ir.src1)) != 0;
+            const bool k2 = !HasTwoSources(ir.op) || (known & Bit(ir.src2)) != 0;
+            if (k1 && k2) {
+                MakeConst(ir, Evaluate(ir.op, values[ir.src1], values[ir.src2], ir.imm));
+                ++stats.folded;
+            } else if (HasTwoSources(ir.op) && (known & Bit(ir.src2))) {
+                const uint32_t c = values[ir.src2];
+                IROp immOp = IROp::Nop;
+                uint32_t imm = c;
+                switch (ir.op) {
+                    case IROp::Add: immOp = IROp::AddI; break;
+                    case IROp::Sub: immOp = IROp::AddI; imm = 0u - c; break;
+                    case IROp::And: immOp = IROp::AndI; break;
+                    case IROp::Or:  immOp = IROp::OrI; break;
+                    case IROp::Xor: immOp = IROp::XorI; break;
+                    case IROp::Slt: immOp = IROp::SltI; break;
+                    case IROp::Sltu: immOp = IROp::SltuI; break;
+                    case IROp::Shl: immOp = IROp::ShlI; imm = c & 31; break;
+                    case IROp::Shr: immOp = IROp::ShrI; imm = c & 31; break;
+                    case IROp::Sar: immOp = IROp::SarI; imm = c & 31; break;
+                    case IROp::Ror: immOp = IROp::RorI; imm = c & 31; break;
+                    default: break;
+                }
+                if (immOp != IROp::Nop) {
+                    ir.op = immOp;
+                    ir.src2 = 0;
+                    ir.imm = imm;
+                    ++stats.folded;
+                    Count(stats, SimplifyIdentity(ir));
+                }
+            } else if (known & Bit(ir.src1)) {
+                // Коммутативные операции с известным первым операндом
+                const uint32_t c = values[ir.src1];
+                IROp immOp = IROp::Nop;
+                switch (ir.op) {
+                    case IROp::Add: immOp = IROp::AddI; break;
+                    case IROp::And: immOp = IROp::AndI; break;
+                    case IROp::Or:  immOp = IROp::OrI; break;
+                    case IROp::Xor: immOp = IROp::XorI; break;
+                    default: break;
+                }
+                if (immOp != IROp::Nop) {
+                    ir.op = immOp;
+                    ir.src1 = ir.src2;
+                    ir.src2 = 0;
+                    ir.imm = c;
+                    ++stats.folded;
+                    Count(stats, SimplifyIdentity(ir));
+                }
+            }
+        }
+
+        if (ir.op == IROp::Interp) {
+            known &= ~DefMask(ir);
+            continue;
+        }
+
+        const uint8_t def = DefReg(ir);
+        if (def == 0) continue;
+        if (ir.op == IROp::SetConst) {
+            known |= Bit(def);
+            values[def] = ir.imm;
+        } else if (IsIRBranch(ir.op)) {
+            // Адрес возврата известен при компиляции
+            known |= Bit(def);
+            values[def] = ir.pc + 8;
+        } else {
+            known &= ~Bit(def);
+        }
+    }
+    return stats;
+}
+
+// Обратный проход по живости: запись в GPR, перекрытая до любого чтения, удаляется.
+// На выходе из блока живы все регистры.
+IRPassStats EliminateDeadStores(std::vector<IRInst>& block) {
+    IRPassStats stats;
+    uint32_t live = ALL_REGS;
+
+    for (size_t n = block.size(); n-- > 0;) {
+        IRInst& ir = block[n];
+        if (IsBarrier(ir)) {
+            live = ALL_REGS;
+            continue;
+        }
+
+        const uint8_t def = DefReg(ir);
+        if (IsPure(ir.op) && def != 0 && !(live & Bit(def))) {
+            MakeNop(ir);
+            ++stats.removed;
+            continue;
+        }
+
+        // Delay slot likely-перехода исполняется не всегда и не перекрывает
+        // более ранние записи
+        const bool conditional = (ir.flags & IR_DELAY_SLOT) && n > 0 && (block[n - 1].flags & IR_LIKELY);
+        if (!conditional) {
+            live &= ~DefMask(ir);
+        }
+        live |= UseMask(ir);
+    }
+    return stats;
+}
+
+// Повторная загрузка по тому же адресу заменяется пересылкой из регистра,
+// куда значение было загружено ранее. Версии регистров отслеживают, что ни база,
+// ни регистр-хранитель не были перезаписаны. Любая запись в память сбрасывает
+// известные значения; sw сам становится источником для следующего lw.
+// Участвуют только обращения, адрес которых известен из констант блока и лежит
+// ниже окна устройств: чтение регистра MMIO может вернуть новое значение или
+// иметь побочный эффект, поэтому остальные загрузки работают как барьер.
+// removed - количество устранённых обращений к памяти.
+IRPassStats EliminateRedundantLoads(std::vector<IRInst>& block) {
+    struct Available {
+        IROp op;
+        uint8_t base;
+        uint8_t holder;
+        uint32_t baseVersion;
+        uint32_t holderVersion;
+        uint32_t offset;
+    };
+
+    IRPassStats stats;
+    uint32_t versions[32] = {};
+    uint32_t values[32] = {};
+    uint32_t known = 1;     // $zero всегда известен
+    std::vector<Available> available;
+
+    auto bump = [&](uint8_t reg) {
+        if (reg != 0) ++versions[reg];
+    };
+    auto isPlainMemory = [&](const IRInst& ir) {
+        return (known & Bit(ir.src1)) && values[ir.src1] + ir.imm < Memory::MMIO_WINDOW_BASE;
+    };
+
+    for (IRInst& ir : block) {
+        if (IsBarrier(ir)) {
+            available.clear();
+            for (uint32_t& v : versions) ++v;
+            known = 1;
+            continue;
+        }
+
+        const bool plain = (IsLoad(ir.op) || IsStore(ir.op)) && isPlainMemory(ir);
+        if (IsLoad(ir.op) && !plain) {
+            available.clear();
+        }
+
+        if (IsLoad(ir.op) && plain) {
+            for (const Available& a : available) {
+                if (a.op == ir.op && a.base == ir.src1 && a.offset == ir.imm &&
+                    a.baseVersion == versions[a.base] && a.holderVersion == versions[a.holder]) {
+                    if (a.holder == ir.dst) {
+                        MakeNop(ir);
+                    } else {
+                        MakeMov(ir, a.holder);
+                    }
+                    ++stats.removed;
+                    break;
+                }
+            }
+        }
+
+        if (IsStore(ir.op) || (ir.op == IROp::Interp && (InterpFlags(ir) & IF_STORE))) {
+            available.clear();
+        }
+
+        const uint8_t def = DefReg(ir);
+        for (uint32_t mask = DefMask(ir); mask != 0; mask &= mask - 1) {
+            bump(uint8_t(std::countr_zero(mask)));
+        }
+        known &= ~DefMask(ir);
+        if (ir.op == IROp::SetConst && def != 0) {
+            known |= Bit(def);
+            values[def] = ir.imm;
+        }
+
+        if (!plain) continue;
+        if (IsLoad(ir.op) && def != 0 && def != ir.src1) {
+            available.push_back({ ir.op, ir.src1, def, versions[ir.src1], versions[def], ir.imm });
+        } else if (ir.op == IROp::Store32 && ir.src2 != 0) {
+            available.push_back({ IROp::Load32, ir.src1, ir.src2, versions[ir.src1], versions[ir.src2], ir.imm });
+        }
+    }
+    return stats;
+}
+
+void Compact(std::vector<IRInst>& block) {
+    size_t out = 0;
+    for (size_t n = 0; n < block.size(); ++n) {
+        // Delay slot остаётся на месте: исполнители берут его следом за переходом
+        if (block[n].op == IROp::Nop && !(block[n].flags & IR_DELAY_SLOT)) continue;
+        block[out++] = block[n];
+    }
+    block.resize(out);
+}
+
+bool IsIdleLoop(const std::vector<IRInst>& block, uint32_t startPC) {
+    if (block.size() < 2) return false;
+    const IRInst& branch = block[block.size() - 2];
+    if (!IsIRBranch(branch.op) || branch.op == IROp::JumpReg || branch.imm != startPC) {
+        return false;
+    }
+
+    uint32_t written = 0;
+    uint32_t readBeforeWrite = 0;
+    for (const IRInst& ir : block) {
+        switch (ir.op) {
+            case IROp::MfHi: case IROp::MfLo: case IROp::MtHi: case IROp::MtLo:
+            case IROp::Mult: case IROp::Multu:
+                return false;   // HI/LO могут переносить состояние между итерациями
+            default:
+                break;
+        }
+        if (IsStore(ir.op) || IsBarrier(ir)) return false;
+        if (ir.op == IROp::Interp &&
+            (InterpFlags(ir) & (IF_STORE | IF_IN_HILO | IF_OUT_HILO | IF_FPU | IF_VFPU))) {
+            return false;   // состояние вне GPR, которое анализ не отслеживает
+        }
+
+        readBeforeWrite |= UseMask(ir) & ~written;
+        written |= DefMask(ir);
+    }
+    // Регистр, прочитанный до записи и перезаписанный в теле, - счётчик цикла
+    return (readBeforeWrite & written) == 0;
+}
+
+void OptimizeIR(std::vector<IRInst>& block, IRStats& stats) {
+    stats.inputInsts += block.size();
+
+    auto add = [](IRPassStats& total, const IRPassStats& pass) {
+        total.removed += pass.removed;
+        total.folded += pass.folded;
+    };
+    add(stats.zeroFold, FoldZeroRegister(block));
+    add(stats.constProp, PropagateConstants(block));
+    add(stats.redundantLoad, EliminateRedundantLoads(block));
+    add(stats.deadStore, EliminateDeadStores(block));
+    Compact(block);
+
+    stats.outputInsts += block.size();
+}
+
+}  // namespace core
+}  // namespace ppsspp
@@ -0,0 +1,105 @@
+// core/ir.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "decoder.h"
+
+namespace ppsspp {
+namespace core {
+
+// Операции промежуточного представления.
+// Операнды - регистры гостя, поэтому блок IR напрямую исполним интерпретатором
+// и транслируем рекомпилятором без распределения регистров.
+enum class IROp : uint8_t {
+    Nop,
+    SetConst,   // dst = imm
+    Mov,        // dst = src1
+
+    // dst = src1 op src2
+    Add, Sub, And, Or, Xor, Nor, Slt, Sltu,
+    // dst = src1 op imm
+    AddI, AndI, OrI, XorI, SltI, SltuI,
+    // dst = src1 shift imm
+    ShlI, ShrI, SarI, RorI,
+    // dst = src1 shift (src2 & 31)
+    Shl, Shr, Sar, Ror,
+
+    MfHi, MfLo,     // dst = HI/LO
+    MtHi, MtLo,     // HI/LO = src1
+    Mult, Multu,    // HI:LO = src1 * src2
+
+    // dst = mem[src1 + imm]
+    Load8S, Load8U, Load16S, Load16U, Load32,
+    // mem[src1 + imm] = src2
+    Store8, Store16, Store32,
+
+    // Переходы: imm - абсолютная цель, флаги IR_LIKELY/IR_LINK
+    Jump,           // безусловный
+    JumpReg,        // цель в src1, dst - регистр связи (0 - без связи)
+    Beq, Bne,       // src1 ? src2
+    Blez, Bgtz, Bltz, Bgez,
+
+    Syscall,        // imm - код вызова
+    Interp,         // нет собственной операции: imm - исходное слово инструкции
+};
+
+enum IRFlags : uint8_t {
+    IR_LIKELY = 1 << 0,     // delay slot исполняется только при переходе
+    IR_LINK = 1 << 1,       // $ra = pc + 8
+    IR_DELAY_SLOT = 1 << 2, // инструкция в delay slot
+};
+
+struct IRInst {
+    IROp op = IROp::Nop;
+    uint8_t dst = 0;
+    uint8_t src1 = 0;
+    uint8_t src2 = 0;
+    uint32_t imm = 0;
+    uint32_t pc = 0;        // адрес исходной инструкции гостя
+    uint8_t flags = 0;
+};
+
+bool IsIRBranch(IROp op);
+
+// Переводит декодированную инструкцию по адресу pc в IR
+IRInst LowerToIR(uint32_t pc, const Decoded& d);
+
+// Результат одного прохода оптимизации
+struct IRPassStats {
+    uint32_t removed = 0;   // инструкции, удалённые из блока
+    uint32_t folded = 0;    // инструкции, заменённые более дешёвой формой
+};
+
+// Проходы оптимизации над одним базовым блоком.
+// Удалённые инструкции превращаются в Nop; Compact() убирает их,
+// сохраняя delay slot на своём месте.
+IRPassStats FoldZeroRegister(std::vector<IRInst>& block);
+IRPassStats PropagateConstants(std::vector<IRInst>& block);
+IRPassStats EliminateDeadStores(std::vector<IRInst>& block);
+IRPassStats EliminateRedundantLoads(std::vector<IRInst>& block);
+void Compact(std::vector<IRInst>& block);
+
+// Накопленная статистика проходов
+struct IRStats {
+    uint64_t inputInsts = 0;
+    uint64_t outputInsts = 0;
+    IRPassStats zeroFold;
+    IRPassStats constProp;
+    IRPassStats deadStore;
+    IRPassStats redundantLoad;
+};
+
+// Полный конвейер оптимизации; статистика добавляется к stats
+void OptimizeIR(std::vector<IRInst>& block, IRStats& stats);
+
+// Цикл ожидания: блок переходит сам на себя, ничего не пишет в память и не
+// переносит значения регистров между итерациями. Каждая итерация зависит только
+// от памяти, поэтому до внешнего события (прерывание, vblank) цикл не завершится.
+bool IsIdleLoop(const std::vector<IRInst>& block, uint32_t startPC);
+
+}  // namespace core
+}  // namespace ppsspp
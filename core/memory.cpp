@@ -1,15 +1,179 @@
 #include "memory.h"
+#include "mmio.h"
 #include "logger.h"
+#include <algorithm>
+#include <bit>
+#include <atomic>
 #include <cstring>
+#include <mutex>
 #include <stdexcept>
 
+#if (defined(__linux__) || defined(__APPLE__)) && UINTPTR_MAX > 0xFFFFFFFFu
+#define PPSSPP_FASTMEM 1
+#include <cstdio>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace ppsspp {
 namespace core {
 
-Memory::Memory() : ramSize_(0) {
+namespace {
+
+// Смещение области в общем буфере, который отображается во все зеркала
+constexpr uint32_t BackingOffset(size_t region) {
+    uint32_t offset = 0;
+    for (size_t n = 0; n < region; ++n) offset += Memory::REGIONS[n].size;
+    return offset;
+}
+
+constexpr size_t NUM_REGIONS = sizeof(Memory::REGIONS) / sizeof(Memory::REGIONS[0]);
+constexpr uint32_t BACKING_SIZE = BackingOffset(NUM_REGIONS);
+
+#ifdef PPSSPP_FASTMEM
+
+// 4GB гостевого пространства и защитная зона для обращений через его конец
+constexpr size_t FASTMEM_RESERVE = 0x100000000ull + 0x10000;
+constexpr size_t MAX_FASTMEM_ARENAS = 16;
+
+// Арены, чьи ошибки доступа перехватывает обработчик. Обработчик сигнала
+// работает только с этими слотами, поэтому они - атомарные значения, а не контейнер.
+struct FaultSlot {
+    std::atomic<uint8_t*> base{ nullptr };
+    std::atomic<uint64_t> faults{ 0 };
+    std::atomic<uint32_t> faultAddr{ 0 };               // гостевой адрес последней ошибки
+    std::atomic<sigjmp_buf*> recovery{ nullptr };       // см. Memory::RunFastmemGuarded
+};
+
+FaultSlot g_faultSlots[MAX_FASTMEM_ARENAS];
+struct sigaction g_prevSegv;
+struct sigaction g_prevBus;
+std::once_flag g_handlerOnce;
+
+void FaultHandler(int sig, siginfo_t* info, void* context) {
+    uint8_t* addr = static_cast<uint8_t*>(info->si_addr);
+    for (FaultSlot& slot : g_faultSlots) {
+        uint8_t* base = slot.base.load(std::memory_order_acquire);
+        if (!base || addr < base || addr >= base + FASTMEM_RESERVE) continue;
+
+        // Резерв вне карты памяти доступен только для чтения (нулевая страница),
+        // поэтому сюда приходят записи. Запись не выполняется: возвращаемся в
+        // RunFastmemGuarded, который запишет MemoryFault. Без неё - падение.
+        slot.faultAddr.store(static_cast<uint32_t>(addr - base), std::memory_order_relaxed);
+        slot.faults.fetch_add(1, std::memory_order_relaxed);
+        sigjmp_buf* recovery = slot.recovery.load(std::memory_order_acquire);
+        if (recovery) siglongjmp(*recovery, 1);
+        break;
+    }
+
+    // Ошибка не в гостевой памяти - передаём предыдущему обработчику
+    const struct sigaction& prev = sig == SIGBUS ? g_prevBus : g_prevSegv;
+    if (prev.sa_flags & SA_SIGINFO) {
+        prev.sa_sigaction(sig, info, context);
+    } else if (prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN) {
+        prev.sa_handler(sig);
+    } else {
+        // Повторная ошибка завершит процесс стандартным образом
+        signal(sig, SIG_DFL);
+    }
+}
+
+void InstallFaultHandler() {
+    struct sigaction sa = {};
+    sa.sa_sigaction = FaultHandler;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &g_prevSegv);
+    sigaction(SIGBUS, &sa, &g_prevBus);
+}
+
+#endif  // PPSSPP_FASTMEM
+
+}  // namespace
+
+// Зарезервированное адресное пространство, в котором области PSP отображены
+// по своим адресам во всех зеркалах
+struct Memory::FastmemArena {
+    uint8_t* base = nullptr;
+    int fd = -1;
+    size_t slot = SIZE_MAX;
+
+    FastmemArena() = default;
+    FastmemArena(const FastmemArena&) = delete;
+    FastmemArena& operator=(const FastmemArena&) = delete;
+
+#ifdef PPSSPP_FASTMEM
+    ~FastmemArena() {
+        if (slot != SIZE_MAX) {
+            g_faultSlots[slot].base.store(nullptr, std::memory_order_release);
+        }
+        if (base) munmap(base, FASTMEM_RESERVE);
+        if (fd >= 0) close(fd);
+    }
+
+    bool Create() {
+        std::call_once(g_handlerOnce, InstallFaultHandler);
+
+#ifdef __linux__
+        fd = memfd_create("ppsspp-fastmem", MFD_CLOEXEC);
+#else
+        char name[64];
+        std::snprintf(name, sizeof(name), "/ppsspp-fastmem-%d-%p", static_cast<int>(getpid()), static_cast<void*>(this));
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) shm_unlink(name);
+#endif
+        if (fd < 0 || ftruncate(fd, BACKING_SIZE) != 0) return false;
+
+        // Весь резерв читается как общая нулевая страница ядра: чтение вне карты
+        // памяти даёт 0 без ошибки, запись вызывает SIGSEGV
+        void* reserved = mmap(nullptr, FASTMEM_RESERVE, PROT_READ,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (reserved == MAP_FAILED) return false;
+        base = static_cast<uint8_t*>(reserved);
+
+        for (uint32_t mirror : MIRROR_BASES) {
+            for (size_t n = 0; n < NUM_REGIONS; ++n) {
+                void* view = mmap(base + mirror + REGIONS[n].start, REGIONS[n].size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_FIXED, fd, BackingOffset(n));
+                if (view == MAP_FAILED) return false;
+            }
+        }
+
+        for (size_t n = 0; n < MAX_FASTMEM_ARENAS; ++n) {
+            uint8_t* expected = nullptr;
+            if (g_faultSlots[n].base.compare_exchange_strong(expected, base)) {
+                g_faultSlots[n].faults.store(0, std::memory_order_relaxed);
+                slot = n;
+                return true;
+            }
+        }
+        return false;
+    }
+#else
+    bool Create() { return false; }
+#endif
+};
+
+static_assert(alignof(MmioHandler) > 1, "page table tags handler pointers with the low bit");
+
+Memory::Memory() : ramSize_(0), pageTable_(std::make_unique<uintptr_t[]>(NUM_PAGES)) {
     InitializeMemory();
 }
 
+Memory::Memory(bool fastmem) : ramSize_(0), pageTable_(std::make_unique<uintptr_t[]>(NUM_PAGES)) {
+    if (fastmem && !InitializeFastmem()) {
+        LogWarning("Fastmem is unavailable, using flat memory");
+    }
+    InitializeMemory();
+}
+
+Memory::~Memory() = default;
+Memory::Memory(Memory&&) noexcept = default;
+Memory& Memory::operator=(Memory&&) noexcept = default;
+
 bool Memory::Init() {
     try {
         InitializeMemory();
@@ -20,21 +184,173 @@ bool Memory::Init() {
     }
 }
 
+bool Memory::InitializeFastmem() {
+    auto arena = std::make_unique<FastmemArena>();
+    if (!arena->Create()) {
+        return false;
+    }
+    base_ = arena->base;
+    fastmem_ = std::move(arena);
+    return true;
+}
+
 void Memory::InitializeMemory() {
-    ramSize_ = 32 * 1024 * 1024; // 32MB RAM
+    ramSize_ = RAM_SIZE; // 32MB RAM
+    if (fastmem_) {
+        for (const MemoryRegion& region : REGIONS) {
+            std::memset(base_ + region.start, 0, region.size);
+        }
+        pageFlags_.assign((size_t(PHYSICAL_MASK) + 1) >> PAGE_SHIFT, 0);
+        dirtyPages_.assign((pageFlags_.size() + 63) / 64, 0);
+        BuildPageTable();
+        LogInfo("Fastmem initialized at PSP addresses, " + std::to_string(BACKING_SIZE) + " bytes");
+        return;
+    }
+
     ram_ = std::make_unique<uint8_t[]>(ramSize_);
     if (!ram_) {
         throw MemoryError("Failed to allocate memory");
     }
+    base_ = ram_.get();
     std::memset(ram_.get(), 0, ramSize_);
+    pageFlags_.assign(ramSize_ >> PAGE_SHIFT, 0);
+    dirtyPages_.assign((pageFlags_.size() + 63) / 64, 0);
+    BuildPageTable();
     LogInfo("Memory initialized with " + std::to_string(ramSize_) + " bytes");
 }
 
+void Memory::BuildPageTable() {
+    std::fill(pageTable_.get(), pageTable_.get() + NUM_PAGES, uintptr_t(0));
+    auto mapHost = [&](uint32_t addr, uint32_t size, uint8_t* host) {
+        for (uint32_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            pageTable_[(addr + offset) >> PAGE_SHIFT] = reinterpret_cast<uintptr_t>(host + offset);
+        }
+    };
+
+    if (fastmem_) {
+        for (uint32_t mirror : MIRROR_BASES) {
+            for (const MemoryRegion& region : REGIONS) {
+                mapHost(mirror + region.start, region.size, base_ + mirror + region.start);
+            }
+        }
+    } else {
+        mapHost(0, static_cast<uint32_t>(ramSize_), ram_.get());
+    }
+
+    for (const MmioMapping& mapping : mmio_) {
+        const uint64_t last = (uint64_t(mapping.addr) + mapping.size - 1) >> PAGE_SHIFT;
+        for (uint64_t page = mapping.addr >> PAGE_SHIFT; page <= last; ++page) {
+            pageTable_[page] = reinterpret_cast<uintptr_t>(mapping.handler) | PAGE_MMIO;
+        }
+    }
+}
+
+void Memory::MapMmio(uint32_t addr, uint32_t size, MmioHandler* handler) {
+    if (!handler || size == 0 || addr < MMIO_WINDOW_BASE) {
+        throw MemoryError("Invalid MMIO mapping at addr=" + std::to_string(addr));
+    }
+    const uint64_t first = addr & ~uint64_t(PAGE_MASK);
+    const uint64_t end = ((uint64_t(addr) + size + PAGE_MASK) & ~uint64_t(PAGE_MASK));
+    for (uint32_t mirror : MIRROR_BASES) {
+        for (const MemoryRegion& region : REGIONS) {
+            const uint64_t start = uint64_t(mirror) + region.start;
+            if (first < start + region.size && start < end) {
+                throw MemoryError("MMIO mapping at addr=" + std::to_string(addr) + " hides " + region.name);
+            }
+        }
+    }
+    mmio_.push_back({ addr, size, handler });
+    BuildPageTable();
+}
+
+void Memory::UnmapMmio(MmioHandler* handler) {
+    mmio_.erase(std::remove_if(mmio_.begin(), mmio_.end(), [&](const MmioMapping& mapping) {
+        return mapping.handler == handler;
+    }), mmio_.end());
+    BuildPageTable();
+}
+
+size_t Memory::GetContiguousSize(uint32_t addr, size_t limit) const {
+    uintptr_t entry = pageTable_[addr >> PAGE_SHIFT];
+    if (!IsHostPage(entry)) return 0;
+
+    // Страницы должны идти подряд и в памяти хоста
+    size_t size = PAGE_SIZE - (addr & PAGE_MASK);
+    for (size_t page = (addr >> PAGE_SHIFT) + 1; size < limit && page < NUM_PAGES; ++page) {
+        const uintptr_t next = pageTable_[page];
+        if (!IsHostPage(next) || next != entry + PAGE_SIZE) break;
+        entry = next;
+        size += PAGE_SIZE;
+    }
+    return size;
+}
+
+// Страница MMIO, неотображённый адрес или обращение через границу страницы
+uint32_t Memory::LoadSlow(uint32_t addr, uint8_t size) const {
+    const uintptr_t entry = pageTable_[addr >> PAGE_SHIFT];
+    if (entry & PAGE_MMIO) {
+        return reinterpret_cast<MmioHandler*>(entry & ~PAGE_MMIO)->Read(addr, size);
+    }
+    if (GetContiguousSize(addr, size) < size) {
+        RecordFault(addr, size, false);
+        return 0;
+    }
+    uint32_t value = 0;
+    std::memcpy(&value, HostPointer(addr), size);
+    return value;
+}
+
+void Memory::StoreSlow(uint32_t addr, uint8_t size, uint32_t value) {
+    const uintptr_t entry = pageTable_[addr >> PAGE_SHIFT];
+    if (entry & PAGE_MMIO) {
+        reinterpret_cast<MmioHandler*>(entry & ~PAGE_MMIO)->Write(addr, size, value);
+        return;
+    }
+    if (GetContiguousSize(addr, size) < size) {
+        RecordFault(addr, size, true);
+        return;
+    }
+    ++unalignedCount_;
+    BeginWrite(addr, size);
+    std::memcpy(HostPointer(addr), &value, size);
+    EndWrite(addr, size);
+}
+
+bool Memory::RunFastmemGuarded(void (*fn)(void*), void* arg) {
+#ifdef PPSSPP_FASTMEM
+    if (fastmem_ && fastmem_->slot != SIZE_MAX) {
+        FaultSlot& slot = g_faultSlots[fastmem_->slot];
+        sigjmp_buf* const outer = slot.recovery.load(std::memory_order_relaxed);
+        sigjmp_buf recovery;
+        if (sigsetjmp(recovery, 1) != 0) {
+            slot.recovery.store(outer, std::memory_order_release);
+            RecordFault(slot.faultAddr.load(std::memory_order_relaxed), 0, true);
+            return false;
+        }
+        slot.recovery.store(&recovery, std::memory_order_release);
+        fn(arg);
+        slot.recovery.store(outer, std::memory_order_release);
+        return true;
+    }
+#endif
+    fn(arg);
+    return true;
+}
+
+uint64_t Memory::GetFastmemFaultCount() const {
+#ifdef PPSSPP_FASTMEM
+    if (fastmem_ && fastmem_->slot != SIZE_MAX) {
+        return g_faultSlots[fastmem_->slot].faults.load(std::memory_order_relaxed);
+    }
+#endif
+    return 0;
+}
+
 void Memory::CheckBounds(uint32_t addr, size_t size) const {
-    if (!ram_) {
+    if (!base_) {
         throw MemoryError("Memory not initialized");
     }
-    if (addr + size > ramSize_) {
+    if (GetContiguousSize(addr, size) < size) {
         throw MemoryError("Memory access out of bounds: addr=" + 
             std::to_string(addr) + ", size=" + std::to_string(size));
     }
@@ -44,46 +360,288 @@ bool Memory::IsAligned(uint32_t addr, size_t alignment) const {
     return (addr % alignment) == 0;
 }
 
+void Memory::RecordFault(uint32_t addr, uint8_t size, bool write) const {
+    fault_.addr = addr;
+    fault_.size = size;
+    fault_.write = write;
+    faultPending_ = true;
+}
+
+void Memory::RaiseFault() const {
+    faultPending_ = false;
+    throw MemoryError(std::string(fault_.write ? "Guest write" : "Guest read") +
+        " out of bounds: addr=" + std::to_string(fault_.addr) +
+        ", size=" + std::to_string(fault_.size));
+}
+
+// Невыровненные обращения считает Load/Store; в лог попадают только 1-е, 2-е,
+// 4-е, 8-е..., чтобы цикл с плохим выравниванием не упирался в ввод-вывод лога
+void Memory::LogUnaligned(uint32_t addr, int bits, bool write) const {
+    const uint64_t count = unalignedCount_;
+    if ((count & (count - 1)) == 0) {
+        LogWarning("Unaligned " + std::to_string(bits) + "-bit " + (write ? "write" : "read") +
+                   " at address " + std::to_string(addr) + " (" + std::to_string(count) + " total)");
+    }
+}
+
+void Memory::EnableTrace(size_t entries) {
+    if (entries == 0) {
+        trace_.reset();
+        traceMask_ = 0;
+        traceHead_ = 0;
+        return;
+    }
+    size_t size = 1;
+    while (size < entries) size <<= 1;
+    trace_ = std::make_unique<MemoryTraceEntry[]>(size);
+    traceMask_ = size - 1;
+    traceHead_ = 0;
+}
+
+std::vector<MemoryTraceEntry> Memory::GetTrace() const {
+    std::vector<MemoryTraceEntry> result;
+    if (!trace_) return result;
+    const size_t capacity = traceMask_ + 1;
+    const size_t count = std::min(traceHead_, capacity);
+    result.reserve(count);
+    for (size_t n = traceHead_ - count; n < traceHead_; ++n) {
+        result.push_back(trace_[n & traceMask_]);
+    }
+    return result;
+}
+
+void Memory::MarkCodePage(uint32_t addr) {
+    const size_t page = PhysicalAddress(addr) >> PAGE_SHIFT;
+    if (page < pageFlags_.size()) {
+        pageFlags_[page] |= PAGE_FLAG_CODE;
+    }
+}
+
+void Memory::UnmarkCodePage(uint32_t addr) {
+    const size_t page = PhysicalAddress(addr) >> PAGE_SHIFT;
+    if (page < pageFlags_.size()) {
+        pageFlags_[page] &= ~PAGE_FLAG_CODE;
+    }
+}
+
+void Memory::ClearCodePages() {
+    for (uint8_t& flags : pageFlags_) flags &= ~PAGE_FLAG_CODE;
+}
+
+void Memory::MarkDirty(uint32_t addr, size_t size) {
+    if (size == 0) return;
+    const size_t first = PhysicalAddress(addr) >> PAGE_SHIFT;
+    const size_t last = std::min((PhysicalAddress(addr) + size - 1) >> PAGE_SHIFT, pageFlags_.size() - 1);
+    for (size_t page = first; page <= last; ++page) {
+        dirtyPages_[page >> 6] |= uint64_t(1) << (page & 63);
+    }
+}
+
+bool Memory::IsDirty(uint32_t addr, size_t size) const {
+    if (size == 0) return false;
+    const size_t first = PhysicalAddress(addr) >> PAGE_SHIFT;
+    const size_t last = std::min((PhysicalAddress(addr) + size - 1) >> PAGE_SHIFT, pageFlags_.size() - 1);
+    for (size_t page = first; page <= last; ++page) {
+        if (dirtyPages_[page >> 6] & (uint64_t(1) << (page & 63))) return true;
+    }
+    return false;
+}
+
+std::vector<uint32_t> Memory::GetDirtyPages() const {
+    std::vector<uint32_t> pages;
+    // Пустые слова по 64 страницы пропускаются целиком
+    for (size_t word = 0; word < dirtyPages_.size(); ++word) {
+        for (uint64_t bits = dirtyPages_[word]; bits != 0; bits &= bits - 1) {
+            const size_t page = word * 64 + std::countr_zero(bits);
+            pages.push_back(static_cast<uint32_t>(page << PAGE_SHIFT));
+        }
+    }
+    return pages;
+}
+
+std::vector<uint32_t> Memory::TakeDirtyPages() {
+    std::vector<uint32_t> pages = GetDirtyPages();
+    ClearDirty();
+    return pages;
+}
+
+void Memory::ClearDirty() {
+    std::fill(dirtyPages_.begin(), dirtyPages_.end(), 0);
+}
+
+void Memory::ClearDirty(uint32_t addr, size_t size) {
+    if (size == 0) return;
+    const size_t first = PhysicalAddress(addr) >> PAGE_SHIFT;
+    const size_t last = std::min((PhysicalAddress(addr) + size - 1) >> PAGE_SHIFT, pageFlags_.size() - 1);
+    for (size_t page = first; page <= last; ++page) {
+        dirtyPages_[page >> 6] &= ~(uint64_t(1) << (page & 63));
+    }
+}
+
+// Страницы считаются по физическому адресу: запись через любое зеркало
+// видит код, исполняемый через другое
+bool Memory::TouchesCode(uint32_t addr, size_t size) const {
+    if (size == 0) return false;
+    const size_t first = PhysicalAddress(addr) >> PAGE_SHIFT;
+    const size_t last = std::min((PhysicalAddress(addr) + size - 1) >> PAGE_SHIFT, pageFlags_.size() - 1);
+    for (size_t page = first; page <= last; ++page) {
+        if (pageFlags_[page] & PAGE_FLAG_CODE) return true;
+    }
+    return false;
+}
+
+void Memory::NotifyCodeWrite(uint32_t addr, size_t size) {
+    if (codeWriteCallback_) {
+        codeWriteCallback_(PhysicalAddress(addr), size);
+    }
+}
+
+void Memory::BeginWrite(uint32_t addr, size_t size) {
+    if (size == 0) return;
+    MarkDirty(addr, size);
+    const size_t first = PhysicalAddress(addr) >> PAGE_SHIFT;
+    const size_t last = std::min((PhysicalAddress(addr) + size - 1) >> PAGE_SHIFT, pageFlags_.size() - 1);
+    for (size_t page = first; page <= last; ++page) {
+        if (pageFlags_[page] & PAGE_FLAG_COW) CopyOnWrite(page);
+    }
+}
+
+void Memory::EndWrite(uint32_t addr, size_t size) {
+    if (TouchesCode(addr, size)) NotifyCodeWrite(addr, size);
+}
+
+// Первая запись в страницу после снимка: текущее содержимое уходит во все
+// живые снимки, где этой страницы ещё нет, одной общей копией
+void Memory::CopyOnWrite(size_t page) {
+    pageFlags_[page] &= ~PAGE_FLAG_COW;
+    const uint32_t physAddr = static_cast<uint32_t>(page << PAGE_SHIFT);
+    if (!IsHostPage(pageTable_[page])) return;
+
+    std::shared_ptr<const uint8_t[]> copy;
+    for (const std::weak_ptr<MemorySnapshot>& weak : snapshots_) {
+        std::shared_ptr<MemorySnapshot> snapshot = weak.lock();
+        if (!snapshot || snapshot->pages_.count(physAddr)) continue;
+        if (!copy) {
+            std::shared_ptr<uint8_t[]> data(new uint8_t[PAGE_SIZE]);
+            std::memcpy(data.get(), HostPointer(physAddr), PAGE_SIZE);
+            copy = std::move(data);
+        }
+        snapshot->pages_.emplace(physAddr, copy);
+    }
+}
+
+std::shared_ptr<MemorySnapshot> Memory::TakeSnapshot() {
+    snapshots_.erase(std::remove_if(snapshots_.begin(), snapshots_.end(),
+        [](const std::weak_ptr<MemorySnapshot>& weak) { return weak.expired(); }), snapshots_.end());
+
+    auto snapshot = std::make_shared<MemorySnapshot>();
+    snapshots_.push_back(snapshot);
+    ProtectForSnapshot();
+    return snapshot;
+}
+
+void Memory::RestoreSnapshot(MemorySnapshot& snapshot) {
+    // Восстановление - обычная запись: другие снимки получают свои копии,
+    // страницы становятся грязными, код в них инвалидируется
+    for (const auto& [physAddr, data] : snapshot.pages_) {
+        BeginWrite(physAddr, PAGE_SIZE);
+        std::memcpy(HostPointer(physAddr), data.get(), PAGE_SIZE);
+        EndWrite(physAddr, PAGE_SIZE);
+    }
+    // Память снова совпадает со снимком; следим за страницами заново
+    snapshot.pages_.clear();
+    ProtectForSnapshot();
+}
+
+// Помечаются только страницы, за которыми есть память
+void Memory::ProtectForSnapshot() {
+    auto protect = [&](uint32_t start, size_t size) {
+        const size_t first = start >> PAGE_SHIFT;
+        const size_t last = std::min(first + (size >> PAGE_SHIFT), pageFlags_.size());
+        for (size_t page = first; page < last; ++page) {
+            pageFlags_[page] |= PAGE_FLAG_COW;
+        }
+    };
+    if (fastmem_) {
+        for (const MemoryRegion& region : REGIONS) protect(region.start, region.size);
+    } else {
+        protect(0, ramSize_);
+    }
+}
+
+void Memory::ReadSnapshot(const MemorySnapshot& snapshot, uint32_t addr, void* out, size_t size) const {
+    CheckBounds(addr, size);
+    uint8_t* dst = static_cast<uint8_t*>(out);
+    while (size > 0) {
+        const uint32_t offset = addr & PAGE_MASK;
+        const size_t chunk = std::min<size_t>(size, PAGE_SIZE - offset);
+        auto it = snapshot.pages_.find(PhysicalAddress(addr) & ~PAGE_MASK);
+        const uint8_t* src = it != snapshot.pages_.end() ? it->second.get() + offset : HostPointer(addr);
+        std::memcpy(dst, src, chunk);
+        dst += chunk;
+        addr += static_cast<uint32_t>(chunk);
+        size -= chunk;
+    }
+}
+
+// Одиночные обращения с исключением при ошибке - для HLE и инструментов
 uint8_t Memory::Read8(uint32_t addr) const {
-    CheckBounds(addr, sizeof(uint8_t));
-    return ram_[addr];
+    faultPending_ = false;
+    const uint8_t value = Load<uint8_t>(addr);
+    if (faultPending_) RaiseFault();
+    return value;
 }
 
 uint16_t Memory::Read16(uint32_t addr) const {
-    CheckBounds(addr, sizeof(uint16_t));
+    faultPending_ = false;
+    const uint16_t value = Load<uint16_t>(addr);
+    if (faultPending_) RaiseFault();
     if (!IsAligned(addr, sizeof(uint16_t))) {
-        LogWarning("Unaligned 16-bit read at address " + std::to_string(addr));
+        LogUnaligned(addr, 16, false);
     }
-    return *reinterpret_cast<const uint16_t*>(&ram_[addr]);
+    return value;
 }
 
 uint32_t Memory::Read32(uint32_t addr) const {
-    CheckBounds(addr, sizeof(uint32_t));
+    faultPending_ = false;
+    const uint32_t value = Load<uint32_t>(addr);
+    if (faultPending_) RaiseFault();
     if (!IsAligned(addr, sizeof(uint32_t))) {
-        LogWarning("Unaligned 32-bit read at address " + std::to_string(addr));
+        LogUnaligned(addr, 32, false);
     }
-    return *reinterpret_cast<const uint32_t*>(&ram_[addr]);
+    return value;
 }
 
 void Memory::Write8(uint32_t addr, uint8_t value) {
-    CheckBounds(addr, sizeof(uint8_t));
-    ram_[addr] = value;
+    faultPending_ = false;
+    Store<uint8_t>(addr, value);
+    if (faultPending_) RaiseFault();
 }
 
 void Memory::Write16(uint32_t addr, uint16_t value) {
-    CheckBounds(addr, sizeof(uint16_t));
+    faultPending_ = false;
+    Store<uint16_t>(addr, value);
+    if (faultPending_) RaiseFault();
     if (!IsAligned(addr, sizeof(uint16_t))) {
-        LogWarning("Unaligned 16-bit write at address " + std::to_string(addr));
+        LogUnaligned(addr, 16, true);
     }
-    *reinterpret_cast<uint16_t*>(&ram_[addr]) = value;
 }
 
 void Memory::Write32(uint32_t addr, uint32_t value) {
-    CheckBounds(addr, sizeof(uint32_t));
+    faultPending_ = false;
+    Store<uint32_t>(addr, value);
+    if (faultPending_) RaiseFault();
     if (!IsAligned(addr, sizeof(uint32_t))) {
-        LogWarning("Unaligned 32-bit write at address " + std::to_string(addr));
+        LogUnaligned(addr, 32, true);
     }
-    *reinterpret_cast<uint32_t*>(&ram_[addr]) = value;
+}
+
+void Memory::ReadBytes(uint32_t addr, void* out, size_t size) const {
+    if (!out) {
+        throw MemoryError("Null pointer passed to ReadBytes");
+    }
+    CheckBounds(addr, size);
+    std::memcpy(out, HostPointer(addr), size);
 }
 
 void Memory::WriteBytes(uint32_t addr, const void* data, size_t size) {
@@ -91,22 +649,56 @@ void Memory::WriteBytes(uint32_t addr, const void* data, size_t size) {
         throw MemoryError("Null pointer passed to WriteBytes");
     }
     CheckBounds(addr, size);
-    std::memcpy(&ram_[addr], data, size);
+    BeginWrite(addr, size);
+    std::memcpy(HostPointer(addr), data, size);
+    EndWrite(addr, size);
 }
 
 void Memory::Memset(uint32_t addr, uint8_t value, size_t size) {
     CheckBounds(addr, size);
-    std::memset(&ram_[addr], value, size);
+    BeginWrite(addr, size);
+    std::memset(HostPointer(addr), value, size);
+    EndWrite(addr, size);
+}
+
+std::span<const uint8_t> Memory::GetRange(uint32_t addr, size_t size) const {
+    if (size == 0) return {};
+    CheckBounds(addr, size);
+    return { HostPointer(addr), size };
+}
+
+std::span<uint8_t> Memory::GetRange(uint32_t addr, size_t size) {
+    if (size == 0) return {};
+    CheckBounds(addr, size);
+    BeginWrite(addr, size);
+    EndWrite(addr, size);
+    return { HostPointer(addr), size };
+}
+
+std::string Memory::ReadCString(uint32_t addr, size_t maxLen) const {
+    if (maxLen == 0) return {};
+    // Ищем ноль в пределах доступной памяти; строка, упёршаяся в конец
+    // карты памяти раньше maxLen, - ошибка, как и при побайтовом чтении
+    const size_t available = GetContiguousSize(addr, maxLen);
+    const size_t scan = std::min(available, maxLen);
+    const uint8_t* host = scan ? HostPointer(addr) : nullptr;
+    const void* end = scan ? std::memchr(host, 0, scan) : nullptr;
+    if (!end && scan < maxLen) {
+        throw MemoryError("Memory access out of bounds: addr=" +
+            std::to_string(addr + scan) + ", size=1");
+    }
+    const size_t length = end ? static_cast<const uint8_t*>(end) - host : scan;
+    return std::string(reinterpret_cast<const char*>(host), length);
 }
 
 const uint8_t* Memory::GetPointer(uint32_t addr) const {
     CheckBounds(addr, 1);
-    return &ram_[addr];
+    return HostPointer(addr);
 }
 
 uint8_t* Memory::GetPointer(uint32_t addr) {
     CheckBounds(addr, 1);
-    return &ram_[addr];
+    return HostPointer(addr);
 }
 
 } // namespace core
@@ -1,31 +1,119 @@
 #pragma once
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace ppsspp {
 namespace core {
 
+class MmioHandler;
+class MemorySnapshot;
+
 class MemoryError : public std::runtime_error {
 public:
     explicit MemoryError(const std::string& message) : std::runtime_error(message) {}
     virtual ~MemoryError() = default;
 };
 
+// Ошибка доступа гостя. Проверяющие политики записывают её вместо исключения,
+// а исполнитель решает, как доставить её гостю (см. Memory::RaiseFault)
+struct MemoryFault {
+    uint32_t addr = 0;
+    uint8_t size = 0;
+    bool write = false;
+};
+
+// Запись кольцевого буфера трассировки
+struct MemoryTraceEntry {
+    uint32_t addr;
+    uint32_t value;
+    uint8_t size;
+    bool write;
+    bool fault;
+};
+
+// Политики Memory::Load/Store. Ни одна не выделяет память и не берёт
+// блокировок при успешном обращении.
+struct UncheckedAccess {    // адрес заведомо корректен: без проверок
+    static constexpr bool CHECK = false;
+    static constexpr bool TRACE = false;
+};
+struct CheckedAccess {      // адрес вне памяти - запись MemoryFault, чтение даёт 0
+    static constexpr bool CHECK = true;
+    static constexpr bool TRACE = false;
+};
+struct TracedAccess {       // как CheckedAccess + трассировка в кольцевой буфер
+    static constexpr bool CHECK = true;
+    static constexpr bool TRACE = true;
+};
+
+// Политика исполнителей CPU
+#ifdef PPSSPP_TRACE_MEMORY
+using GuestAccess = TracedAccess;
+#else
+using GuestAccess = CheckedAccess;
+#endif
+
+// Область карты памяти PSP (адреса без битов зеркал)
+struct MemoryRegion {
+    uint32_t start;
+    uint32_t size;
+    const char* name;
+};
+
 class Memory {
 public:
-    Memory();
-    ~Memory() = default;
+    static constexpr uint32_t PAGE_SHIFT = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_SHIFT;
+    static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+    static constexpr size_t NUM_PAGES = size_t(1) << (32 - PAGE_SHIFT);
+
+    // Карта памяти PSP
+    static constexpr uint32_t SCRATCHPAD_BASE = 0x00010000;
+    static constexpr uint32_t SCRATCHPAD_SIZE = 0x00004000;  // 16KB
+    static constexpr uint32_t VRAM_BASE = 0x04000000;
+    static constexpr uint32_t VRAM_SIZE = 0x00200000;        // 2MB
+    static constexpr uint32_t RAM_BASE = 0x08000000;
+    static constexpr uint32_t RAM_SIZE = 0x02000000;         // 32MB
+
+    // Старшие биты адреса выбирают зеркало (кэшируемое, некэшируемое, ядро):
+    // 0x0xxxxxxx, 0x4xxxxxxx, 0x8xxxxxxx и 0xAxxxxxxx указывают на одну память
+    static constexpr uint32_t PHYSICAL_MASK = 0x1FFFFFFF;
+    static constexpr uint32_t MIRROR_BASES[] = { 0x00000000, 0x40000000, 0x80000000, 0xA0000000 };
+    // Устройства отображаются только в окна ядра: обращение ниже этого адреса
+    // всегда попадает в обычную память и не имеет побочных эффектов
+    static constexpr uint32_t MMIO_WINDOW_BASE = 0x80000000;
+    static constexpr MemoryRegion REGIONS[] = {
+        { SCRATCHPAD_BASE, SCRATCHPAD_SIZE, "scratchpad" },
+        { VRAM_BASE, VRAM_SIZE, "vram" },
+        { RAM_BASE, RAM_SIZE, "ram" },
+    };
+
+    // Адрес без битов зеркала; страницы кода отслеживаются по нему
+    static constexpr uint32_t PhysicalAddress(uint32_t addr) { return addr & PHYSICAL_MASK; }
+
+    // Вызывается при записи в страницу, содержащую кэшированный код;
+    // addr - физический адрес (см. PhysicalAddress)
+    using CodeWriteCallback = std::function<void(uint32_t addr, size_t size)>;
+
+    Memory();                       // Плоская RAM 32MB с адреса 0
+    explicit Memory(bool fastmem);  // fastmem: карта памяти PSP в зарезервированных 4GB
+    ~Memory();
 
     // Запрещаем копирование
     Memory(const Memory&) = delete;
     Memory& operator=(const Memory&) = delete;
 
     // Разрешаем перемещение
-    Memory(Memory&&) noexcept = default;
-    Memory& operator=(Memory&&) noexcept = default;
+    Memory(Memory&&) noexcept;
+    Memory& operator=(Memory&&) noexcept;
 
     bool Init();
 
@@ -39,10 +127,104 @@ public:
     void Write16(uint32_t addr, uint16_t value);
     void Write32(uint32_t addr, uint32_t value);
 
-    // Блоковые операции
+    // Обращения с политикой доступа. CheckedAccess идёт через таблицу страниц:
+    // для RAM это одна индексированная загрузка записи, а страницы MMIO,
+    // неотображённые адреса и обращения через границу страницы уходят в
+    // медленный путь. UncheckedAccess адресует base + addr напрямую и обходит MMIO.
+    // Невыровненные обращения выполняются и только считаются.
+    template <typename T, typename Policy = CheckedAccess>
+    T Load(uint32_t addr) const {
+        T value;
+        if constexpr (Policy::CHECK) {
+            const uintptr_t entry = pageTable_[addr >> PAGE_SHIFT];
+            const uint32_t offset = addr & PAGE_MASK;
+            if (IsHostPage(entry) && offset <= PAGE_SIZE - sizeof(T)) [[likely]] {
+                std::memcpy(&value, reinterpret_cast<const uint8_t*>(entry) + offset, sizeof(T));
+            } else {
+                value = static_cast<T>(LoadSlow(addr, sizeof(T)));
+            }
+        } else {
+            std::memcpy(&value, base_ + addr, sizeof(T));
+        }
+        if ((addr & (sizeof(T) - 1)) != 0) [[unlikely]] ++unalignedCount_;
+        if constexpr (Policy::TRACE) Trace(addr, value, sizeof(T), false, faultPending_);
+        return value;
+    }
+
+    template <typename T, typename Policy = CheckedAccess>
+    void Store(uint32_t addr, T value) {
+        uint8_t* host;
+        if constexpr (Policy::CHECK) {
+            const uintptr_t entry = pageTable_[addr >> PAGE_SHIFT];
+            const uint32_t offset = addr & PAGE_MASK;
+            if (!IsHostPage(entry) || offset > PAGE_SIZE - sizeof(T)) [[unlikely]] {
+                StoreSlow(addr, sizeof(T), value);
+                if constexpr (Policy::TRACE) Trace(addr, value, sizeof(T), true, faultPending_);
+                return;
+            }
+            host = reinterpret_cast<uint8_t*>(entry) + offset;
+        } else {
+            host = base_ + addr;
+        }
+        if constexpr (Policy::TRACE) Trace(addr, value, sizeof(T), true, false);
+        if ((addr & (sizeof(T) - 1)) != 0) [[unlikely]] {
+            // Невыровненная запись может задеть две страницы
+            ++unalignedCount_;
+            BeginWrite(addr, sizeof(T));
+            std::memcpy(host, &value, sizeof(T));
+            EndWrite(addr, sizeof(T));
+            return;
+        }
+        const size_t page = PhysicalAddress(addr) >> PAGE_SHIFT;
+        dirtyPages_[page >> 6] |= uint64_t(1) << (page & 63);
+        // Страница с кодом или под снимком: копия до записи, инвалидация после
+        if (pageFlags_[page]) [[unlikely]] {
+            if (pageFlags_[page] & PAGE_FLAG_COW) CopyOnWrite(page);
+            std::memcpy(host, &value, sizeof(T));
+            if (pageFlags_[page] & PAGE_FLAG_CODE) NotifyCodeWrite(addr, sizeof(T));
+            return;
+        }
+        std::memcpy(host, &value, sizeof(T));
+    }
+
+    // Закрепляет страницы, пересекающиеся с [addr, addr + size), за обработчиком.
+    // Обработчик принадлежит вызывающему и должен жить, пока отображён;
+    // addr - не ниже MMIO_WINDOW_BASE, и страницы не должны перекрывать
+    // зеркала REGIONS: иначе обработчик скрыл бы целую страницу памяти.
+    void MapMmio(uint32_t addr, uint32_t size, MmioHandler* handler);
+    // Возвращает страницы обработчика памяти, которая была под ними
+    void UnmapMmio(MmioHandler* handler);
+
+    // Ошибка, записанная проверяющей политикой
+    bool HasFault() const { return faultPending_; }
+    const MemoryFault& GetFault() const { return fault_; }
+    void ClearFault() { faultPending_ = false; }
+    // Сбрасывает ошибку и бросает MemoryError с её описанием (холодный путь)
+    [[noreturn]] void RaiseFault() const;
+
+    uint64_t GetUnalignedCount() const { return unalignedCount_; }
+
+    // Трассировка TracedAccess: буфер на entries записей (округляется до степени
+    // двойки) выделяется здесь, а не при обращении; 0 выключает трассировку
+    void EnableTrace(size_t entries);
+    // Последние обращения от старых к новым
+    std::vector<MemoryTraceEntry> GetTrace() const;
+
+    // Блоковые операции: одна проверка границ на весь диапазон и memcpy.
+    // Диапазон должен лежать в непрерывной обычной памяти, иначе MemoryError.
+    void ReadBytes(uint32_t addr, void* out, size_t size) const;
     void WriteBytes(uint32_t addr, const void* data, size_t size);
     void Memset(uint32_t addr, uint8_t value, size_t size);
 
+    // Память гостя [addr, addr + size) без копирования. Изменяемый диапазон
+    // сразу считается записанным: страницы помечаются грязными, а блоки кода
+    // в них инвалидируются до возврата.
+    std::span<const uint8_t> GetRange(uint32_t addr, size_t size) const;
+    std::span<uint8_t> GetRange(uint32_t addr, size_t size);
+
+    // Строка до нуля, но не длиннее maxLen байт
+    std::string ReadCString(uint32_t addr, size_t maxLen) const;
+
     // Получение указателя на память
     const uint8_t* GetPointer(uint32_t addr) const;
     uint8_t* GetPointer(uint32_t addr);
@@ -50,13 +232,130 @@ public:
     // Размер памяти
     size_t GetSize() const { return ramSize_; }
 
+    // Сколько байт обычной памяти подряд доступно начиная с addr (не меньше limit,
+    // если столько есть); 0 - адрес вне карты памяти или страница MMIO
+    size_t GetContiguousSize(uint32_t addr, size_t limit = SIZE_MAX) const;
+
+    // Режим fastmem: UncheckedAccess - base + addr. Чтение вне карты памяти
+    // даёт 0, запись вне карты перехватывает обработчик SIGSEGV.
+    bool IsFastmem() const { return fastmem_ != nullptr; }
+    uint8_t* GetBase() const { return base_; }
+    // Выполняет fn(arg); запись UncheckedAccess вне карты памяти не выполняется,
+    // прерывает fn без раскрутки стека (деструкторы её объектов не вызываются)
+    // и записывается как MemoryFault с size = 0. false - fn прервана ошибкой.
+    bool RunFastmemGuarded(void (*fn)(void*), void* arg);
+    // Перехваченные записи вне карты памяти
+    uint64_t GetFastmemFaultCount() const;
+
+    // Отслеживание страниц с кэшированным кодом (для инвалидации блоков)
+    void SetCodeWriteCallback(CodeWriteCallback callback) { codeWriteCallback_ = std::move(callback); }
+    void MarkCodePage(uint32_t addr);
+    void UnmarkCodePage(uint32_t addr);
+    void ClearCodePages();
+
+    // Грязные страницы: физические страницы, в которые писали после последней
+    // очистки. Отмечают Store/Write*, WriteBytes и Memset; запись через
+    // GetPointer() вызывающий отмечает сам через MarkDirty(). Потребители
+    // (кэш текстур, инкрементальные сохранения) смотрят только на них.
+    void MarkDirty(uint32_t addr, size_t size);
+    bool IsDirty(uint32_t addr, size_t size) const;
+    // Физические адреса грязных страниц по возрастанию
+    std::vector<uint32_t> GetDirtyPages() const;
+    // Снимок с одновременной очисткой
+    std::vector<uint32_t> TakeDirtyPages();
+    void ClearDirty();
+    void ClearDirty(uint32_t addr, size_t size);
+
+    // Мгновенный снимок памяти с копированием при записи: страницы копируются
+    // в снимок только при первой записи после него, поэтому снимок стоит
+    // пометки страниц, а не копии 32MB. Снимок действует, пока на него есть
+    // ссылки; память, перенесённая в другой объект Memory, его теряет.
+    std::shared_ptr<MemorySnapshot> TakeSnapshot();
+    // Возвращает память к снимку; снимок остаётся годным для повторного отката
+    void RestoreSnapshot(MemorySnapshot& snapshot);
+    // Содержимое [addr, addr + size) на момент снимка (для записи сохранения)
+    void ReadSnapshot(const MemorySnapshot& snapshot, uint32_t addr, void* out, size_t size) const;
+
 private:
+    struct FastmemArena;
+
+    // Запись таблицы страниц: адрес страницы в памяти хоста либо
+    // MmioHandler* с установленным PAGE_MMIO; 0 - страница не отображена
+    static constexpr uintptr_t PAGE_MMIO = 1;
+
+    struct MmioMapping {
+        uint32_t addr;
+        uint32_t size;
+        MmioHandler* handler;
+    };
+
+    static bool IsHostPage(uintptr_t entry) { return entry != 0 && (entry & PAGE_MMIO) == 0; }
+
+    // Флаги физических страниц, проверяемые при записи
+    static constexpr uint8_t PAGE_FLAG_CODE = 1 << 0;   // кэшированный код
+    static constexpr uint8_t PAGE_FLAG_COW = 1 << 1;    // не сохранена в живом снимке
+
     std::unique_ptr<uint8_t[]> ram_;
+    std::unique_ptr<FastmemArena> fastmem_;
+    uint8_t* base_ = nullptr;   // гостевой адрес 0
     size_t ramSize_ = 0;
 
+    std::unique_ptr<uintptr_t[]> pageTable_;
+    std::vector<MmioMapping> mmio_;
+
+    std::vector<uint8_t> pageFlags_;
+    CodeWriteCallback codeWriteCallback_;
+    std::vector<uint64_t> dirtyPages_;  // бит на физическую страницу
+    std::vector<std::weak_ptr<MemorySnapshot>> snapshots_;
+
+    // Состояние обращений меняется и при чтении через const Memory
+    mutable MemoryFault fault_;
+    mutable bool faultPending_ = false;
+    mutable uint64_t unalignedCount_ = 0;
+
+    std::unique_ptr<MemoryTraceEntry[]> trace_;
+    size_t traceMask_ = 0;
+    mutable size_t traceHead_ = 0;
+
+    uint32_t LoadSlow(uint32_t addr, uint8_t size) const;
+    void StoreSlow(uint32_t addr, uint8_t size, uint32_t value);
+    void RecordFault(uint32_t addr, uint8_t size, bool write) const;
+    void LogUnaligned(uint32_t addr, int bits, bool write) const;
+    uint8_t* HostPointer(uint32_t addr) const {
+        return reinterpret_cast<uint8_t*>(pageTable_[addr >> PAGE_SHIFT]) + (addr & PAGE_MASK);
+    }
+    void BuildPageTable();
+
+    void Trace(uint32_t addr, uint32_t value, uint8_t size, bool write, bool fault) const {
+        if (!trace_) return;
+        trace_[traceHead_++ & traceMask_] = { addr, value, size, write, fault };
+    }
+
+    bool TouchesCode(uint32_t addr, size_t size) const;
+    void NotifyCodeWrite(uint32_t addr, size_t size);
+    // Обрамляют запись в [addr, addr + size) через указатель хоста:
+    // до - грязные страницы и копии для снимков, после - инвалидация кода
+    void BeginWrite(uint32_t addr, size_t size);
+    void EndWrite(uint32_t addr, size_t size);
+    void CopyOnWrite(size_t page);
+    void ProtectForSnapshot();
+
     void CheckBounds(uint32_t addr, size_t size) const;
     bool IsAligned(uint32_t addr, size_t alignment) const;
     void InitializeMemory();
+    bool InitializeFastmem();
+};
+
+// Снимок памяти (см. Memory::TakeSnapshot): физическая страница -> её
+// содержимое на момент снимка. Копия одной записи делится между снимками.
+class MemorySnapshot {
+public:
+    // Память, занятая скопированными страницами
+    size_t GetSavedBytes() const { return pages_.size() * Memory::PAGE_SIZE; }
+
+private:
+    friend class Memory;
+    std::unordered_map<uint32_t, std::shared_ptr<const uint8_t[]>> pages_;
 };
 
 } // namespace core
@@ -0,0 +1,49 @@
+// core/mmio.cpp
+
+#include "mmio.h"
+
+namespace ppsspp {
+namespace core {
+
+namespace {
+
+// Little-endian чтение size байт из образа регистров; за его концом - нули
+uint32_t ReadImage(const uint8_t* image, uint32_t imageSize, uint32_t offset, uint8_t size) {
+    uint32_t value = 0;
+    for (uint32_t n = 0; n < size; ++n) {
+        if (offset + n < imageSize) {
+            value |= uint32_t(image[offset + n]) << (n * 8);
+        }
+    }
+    return value;
+}
+
+}  // namespace
+
+void ControllerMmio::SetState(uint32_t buttons, uint8_t lx, uint8_t ly) {
+    buttons_.store(buttons, std::memory_order_relaxed);
+    analog_.store(uint32_t(lx) | (uint32_t(ly) << 8), std::memory_order_relaxed);
+}
+
+ControllerMmio::State ControllerMmio::GetState() const {
+    const uint32_t analog = analog_.load(std::memory_order_relaxed);
+    return { buttons_.load(std::memory_order_relaxed), static_cast<uint8_t>(analog),
+             static_cast<uint8_t>(analog >> 8) };
+}
+
+uint32_t ControllerMmio::Read(uint32_t addr, uint8_t size) {
+    const State state = GetState();
+
+    uint8_t image[SIZE] = {};
+    for (int n = 0; n < 4; ++n) {
+        image[BUTTONS + n] = static_cast<uint8_t>(state.buttons >> (n * 8));
+    }
+    image[ANALOG_X] = state.lx;
+    image[ANALOG_Y] = state.ly;
+    return ReadImage(image, SIZE, addr - BASE, size);
+}
+
+void ControllerMmio::Write(uint32_t, uint8_t, uint32_t) {}
+
+}  // namespace core
+}  // namespace ppsspp
@@ -0,0 +1,56 @@
+// core/mmio.h
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ppsspp {
+namespace core {
+
+// Устройство, отображённое в адресное пространство гостя. Memory вызывает его
+// для обращений к страницам, закреплённым через Memory::MapMmio().
+class MmioHandler {
+public:
+    virtual ~MmioHandler() = default;
+
+    // addr - полный гостевой адрес, size - 1, 2 или 4 байта
+    virtual uint32_t Read(uint32_t addr, uint8_t size) = 0;
+    virtual void Write(uint32_t addr, uint8_t size, uint32_t value) = 0;
+};
+
+// Блок контроллера в формате SceCtrlData (кнопки и аналоговый стик).
+// Состояние выставляет система ввода; гость читает его как регистры,
+// HLE - напрямую через GetState().
+class ControllerMmio : public MmioHandler {
+public:
+    // В области аппаратных регистров 0xBC000000-0xBFFFFFFF: страница блока
+    // не перекрывает зеркала RAM
+    static constexpr uint32_t BASE = 0xBE000000;
+    static constexpr uint32_t SIZE = 16;        // sizeof(SceCtrlData)
+    static constexpr uint32_t TIMESTAMP = 0x0;  // заполняет HLE, в блоке 0
+    static constexpr uint32_t BUTTONS = 0x4;    // битовая маска PSP_CTRL_*
+    static constexpr uint32_t ANALOG_X = 0x8;   // 0-255, центр 128
+    static constexpr uint32_t ANALOG_Y = 0x9;
+
+    struct State {
+        uint32_t buttons;
+        uint8_t lx;
+        uint8_t ly;
+    };
+
+    // Может вызываться из потока ввода
+    void SetState(uint32_t buttons, uint8_t lx, uint8_t ly);
+    State GetState() const;
+
+    uint32_t Read(uint32_t addr, uint8_t size) override;
+    // Регистры только для чтения: запись игнорируется
+    void Write(uint32_t addr, uint8_t size, uint32_t value) override;
+
+private:
+    std::atomic<uint32_t> buttons_{ 0 };
+    std::atomic<uint32_t> analog_{ 0x8080 };    // lx | ly << 8
+};
+
+}  // namespace core
+}  // namespace ppsspp
@@ -0,0 +1,569 @@
+// core/opcode_table.h
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace ppsspp {
+namespace core {
+
+// Плотный идентификатор инструкции Allegrex (MIPS32 + расширения PSP)
+enum class InstId : uint16_t {
+    Invalid,
+
+    // SPECIAL
+    Sll, Srl, Rotr, Sra, Sllv, Srlv, Rotrv, Srav,
+    Jr, Jalr, Movz, Movn, Syscall, Break, Sync,
+    Mfhi, Mthi, Mflo, Mtlo, Clz, Clo,
+    Mult, Multu, Div, Divu, Madd, Maddu, Msub, Msubu,
+    Add, Addu, Sub, Subu, And, Or, Xor, Nor, Slt, Sltu, Max, Min,
+
+    // REGIMM
+    Bltz, Bgez, Bltzl, Bgezl, Bltzal, Bgezal, Bltzall, Bgezall,
+
+    // Основные опкоды
+    J, Jal, Beq, Bne, Blez, Bgtz, Beql, Bnel, Blezl, Bgtzl,
+    Addi, Addiu, Slti, Sltiu, Andi, Ori, Xori, Lui,
+    Lb, Lh, Lwl, Lw, Lbu, Lhu, Lwr, Sb, Sh, Swl, Sw, Swr,
+    Cache, Ll, Sc,
+
+    // SPECIAL2 / SPECIAL3 (Allegrex)
+    Halt, Mfic, Mtic,
+    Ext, Ins, Wsbh, Wsbw, Seb, Seh, Bitrev,
+
+    // COP0
+    Mfc0, Mtc0, Eret,
+
+    // COP1 (FPU)
+    Mfc1, Cfc1, Mtc1, Ctc1, Bc1f, Bc1t, Bc1fl, Bc1tl,
+    AddS, SubS, MulS, DivS, SqrtS, AbsS, MovS, NegS,
+    RoundWS, TruncWS, CeilWS, FloorWS, CvtWS, CvtSW, CmpS,
+    Lwc1, Swc1,
+
+    // COP2 / VFPU
+    Mfv, Mtv, Bvf, Bvt, Bvfl, Bvtl,
+    Vadd, Vsub, Vsbn, Vdiv,
+    Vmul, Vdot, Vscl, Vhdp, Vcrs, Vdet,
+    Vcmp, Vmin, Vmax, Vscmp, Vsge, Vslt,
+    VfpuUnary, VfpuPrefix, VfpuMatrix, VfpuControl,
+    LvS, LvQ, LvlrQ, SvS, SvQ, SvlrQ,
+
+    Count
+};
+
+constexpr size_t NUM_INST_IDS = static_cast<size_t>(InstId::Count);
+
+// Классификация инструкции
+enum InstFlags : uint32_t {
+    IF_BRANCH     = 1 << 0,   // переход с delay slot
+    IF_LIKELY     = 1 << 1,   // delay slot только при переходе
+    IF_LINK       = 1 << 2,   // пишет $ra
+    IF_JUMP_REG   = 1 << 3,   // цель перехода в регистре
+    IF_LOAD       = 1 << 4,
+    IF_STORE      = 1 << 5,
+    IF_TERMINATOR = 1 << 6,   // после инструкции PC может уйти из блока (syscall, break, eret, halt)
+    IF_FPU        = 1 << 7,
+    IF_VFPU       = 1 << 8,
+    IF_COP0       = 1 << 9,
+
+    // Операнды GPR
+    IF_IN_RS      = 1 << 10,
+    IF_IN_RT      = 1 << 11,
+    IF_OUT_RD     = 1 << 12,
+    IF_OUT_RT     = 1 << 13,
+    IF_COND_WRITE = 1 << 14,  // запись выполняется не всегда (movz/movn)
+    IF_IN_HILO    = 1 << 15,
+    IF_OUT_HILO   = 1 << 16,
+};
+
+struct InstInfo {
+    const char* name;
+    uint32_t flags;
+};
+
+namespace detail {
+
+constexpr uint32_t RS = IF_IN_RS;
+constexpr uint32_t RT = IF_IN_RT;
+constexpr uint32_t RS_RT = IF_IN_RS | IF_IN_RT;
+constexpr uint32_t BR = IF_BRANCH;
+
+constexpr InstInfo MakeInfo(InstId id) {
+    switch (id) {
+        case InstId::Invalid: return { "unknown", 0 };
+
+        case InstId::Sll:   return { "sll", RT | IF_OUT_RD };
+        case InstId::Srl:   return { "srl", RT | IF_OUT_RD };
+        case InstId::Rotr:  return { "rotr", RT | IF_OUT_RD };
+        case InstId::Sra:   return { "sra", RT | IF_OUT_RD };
+        case InstId::Sllv:  return { "sllv", RS_RT | IF_OUT_RD };
+        case InstId::Srlv:  return { "srlv", RS_RT | IF_OUT_RD };
+        case InstId::Rotrv: return { "rotrv", RS_RT | IF_OUT_RD };
+        case InstId::Srav:  return { "srav", RS_RT | IF_OUT_RD };
+        case InstId::Jr:    return { "jr", BR | IF_JUMP_REG | RS };
+        case InstId::Jalr:  return { "jalr", BR | IF_JUMP_REG | RS | IF_OUT_RD };
+        case InstId::Movz:  return { "movz", RS_RT | IF_OUT_RD | IF_COND_WRITE };
+        case InstId::Movn:  return { "movn", RS_RT | IF_OUT_RD | IF_COND_WRITE };
+        case InstId::Syscall: return { "syscall", IF_TERMINATOR };
+        case InstId::Break: return { "break", IF_TERMINATOR };
+        case InstId::Sync:  return { "sync", 0 };
+        case InstId::Mfhi:  return { "mfhi", IF_IN_HILO | IF_OUT_RD };
+        case InstId::Mthi:  return { "mthi", RS | IF_OUT_HILO };
+        case InstId::Mflo:  return { "mflo", IF_IN_HILO | IF_OUT_RD };
+        case InstId::Mtlo:  return { "mtlo", RS | IF_OUT_HILO };
+        case InstId::Clz:   return { "clz", RS | IF_OUT_RD };
+        case InstId::Clo:   return { "clo", RS | IF_OUT_RD };
+        case InstId::Mult:  return { "mult", RS_RT | IF_OUT_HILO };
+        case InstId::Multu: return { "multu", RS_RT | IF_OUT_HILO };
+        case InstId::Div:   return { "div", RS_RT | IF_OUT_HILO };
+        case InstId::Divu:  return { "divu", RS_RT | IF_OUT_HILO };
+        case InstId::Madd:  return { "madd", RS_RT | IF_IN_HILO | IF_OUT_HILO };
+        case InstId::Maddu: return { "maddu", RS_RT | IF_IN_HILO | IF_OUT_HILO };
+        case InstId::Msub:  return { "msub", RS_RT | IF_IN_HILO | IF_OUT_HILO };
+        case InstId::Msubu: return { "msubu", RS_RT | IF_IN_HILO | IF_OUT_HILO };
+        case InstId::Add:   return { "add", RS_RT | IF_OUT_RD };
+        case InstId::Addu:  return { "addu", RS_RT | IF_OUT_RD };
+        case InstId::Sub:   return { "sub", RS_RT | IF_OUT_RD };
+        case InstId::Subu:  return { "subu", RS_RT | IF_OUT_RD };
+        case InstId::And:   return { "and", RS_RT | IF_OUT_RD };
+        case InstId::Or:    return { "or", RS_RT | IF_OUT_RD };
+        case InstId::Xor:   return { "xor", RS_RT | IF_OUT_RD };
+        case InstId::Nor:   return { "nor", RS_RT | IF_OUT_RD };
+        case InstId::Slt:   return { "slt", RS_RT | IF_OUT_RD };
+        case InstId::Sltu:  return { "sltu", RS_RT | IF_OUT_RD };
+        case InstId::Max:   return { "max", RS_RT | IF_OUT_RD };
+        case InstId::Min:   return { "min", RS_RT | IF_OUT_RD };
+
+        case InstId::Bltz:    return { "bltz", BR | RS };
+        case InstId::Bgez:    return { "bgez", BR | RS };
+        case InstId::Bltzl:   return { "bltzl", BR | IF_LIKELY | RS };
+        case InstId::Bgezl:   return { "bgezl", BR | IF_LIKELY | RS };
+        case InstId::Bltzal:  return { "bltzal", BR | IF_LINK | RS };
+        case InstId::Bgezal:  return { "bgezal", BR | IF_LINK | RS };
+        case InstId::Bltzall: return { "bltzall", BR | IF_LINK | IF_LIKELY | RS };
+        case InstId::Bgezall: return { "bgezall", BR | IF_LINK | IF_LIKELY | RS };
+
+        case InstId::J:     return { "j", BR };
+        case InstId::Jal:   return { "jal", BR | IF_LINK };
+        case InstId::Beq:   return { "beq", BR | RS_RT };
+        case InstId::Bne:   return { "bne", BR | RS_RT };
+        case InstId::Blez:  return { "blez", BR | RS };
+        case InstId::Bgtz:  return { "bgtz", BR | RS };
+        case InstId::Beql:  return { "beql", BR | IF_LIKELY | RS_RT };
+        case InstId::Bnel:  return { "bnel", BR | IF_LIKELY | RS_RT };
+        case InstId::Blezl: return { "blezl", BR | IF_LIKELY | RS };
+        case InstId::Bgtzl: return { "bgtzl", BR | IF_LIKELY | RS };
+        case InstId::Addi:  return { "addi", RS | IF_OUT_RT };
+        case InstId::Addiu: return { "addiu", RS | IF_OUT_RT };
+        case InstId::Slti:  return { "slti", RS | IF_OUT_RT };
+        case InstId::Sltiu: return { "sltiu", RS | IF_OUT_RT };
+        case InstId::Andi:  return { "andi", RS | IF_OUT_RT };
+        case InstId::Ori:   return { "ori", RS | IF_OUT_RT };
+        case InstId::Xori:  return { "xori", RS | IF_OUT_RT };
+        case InstId::Lui:   return { "lui", IF_OUT_RT };
+        case InstId::Lb:    return { "lb", IF_LOAD | RS | IF_OUT_RT };
+        case InstId::Lh:    return { "lh", IF_LOAD | RS | IF_OUT_RT };
+        case InstId::Lwl:   return { "lwl", IF_LOAD | RS_RT | IF_OUT_RT };
+        case InstId::Lw:    return { "lw", IF_LOAD | RS | IF_OUT_RT };
+        case InstId::Lbu:   return { "lbu", IF_LOAD | RS | IF_OUT_RT };
+        case InstId::Lhu:   return { "lhu", IF_LOAD | RS | IF_OUT_RT };
+        case InstId::Lwr:   return { "lwr", IF_LOAD | RS_RT | IF_OUT_RT };
+        case InstId::Sb:    return { "sb", IF_STORE | RS_RT };
+        case InstId::Sh:    return { "sh", IF_STORE | RS_RT };
+        case InstId::Swl:   return { "swl", IF_LOAD | IF_STORE | RS_RT };
+        case InstId::Sw:    return { "sw", IF_STORE | RS_RT };
+        case InstId::Swr:   return { "swr", IF_LOAD | IF_STORE | RS_RT };
+        case InstId::Cache: return { "cache", 0 };
+        case InstId::Ll:    return { "ll", IF_LOAD | RS | IF_OUT_RT };
+        case InstId::Sc:    return { "sc", IF_STORE | RS_RT | IF_OUT_RT };
+
+        case InstId::Halt:   return { "halt", IF_TERMINATOR };
+        case InstId::Mfic:   return { "mfic", IF_OUT_RT };
+        case InstId::Mtic:   return { "mtic", RT };
+        case InstId::Ext:    return { "ext", RS | IF_OUT_RT };
+        case InstId::Ins:    return { "ins", RS_RT | IF_OUT_RT };
+        case InstId::Wsbh:   return { "wsbh", RT | IF_OUT_RD };
+        case InstId::Wsbw:   return { "wsbw", RT | IF_OUT_RD };
+        case InstId::Seb:    return { "seb", RT | IF_OUT_RD };
+        case InstId::Seh:    return { "seh", RT | IF_OUT_RD };
+        case InstId::Bitrev: return { "bitrev", RT | IF_OUT_RD };
+
+        case InstId::Mfc0: return { "mfc0", IF_COP0 | IF_OUT_RT };
+        case InstId::Mtc0: return { "mtc0", IF_COP0 | RT };
+        case InstId::Eret: return { "eret", IF_COP0 | IF_TERMINATOR };
+
+        case InstId::Mfc1:  return { "mfc1", IF_FPU | IF_OUT_RT };
+        case InstId::Cfc1:  return { "cfc1", IF_FPU | IF_OUT_RT };
+        case InstId::Mtc1:  return { "mtc1", IF_FPU | RT };
+        case InstId::Ctc1:  return { "ctc1", IF_FPU | RT };
+        case InstId::Bc1f:  return { "bc1f", IF_FPU | BR };
+        case InstId::Bc1t:  return { "bc1t", IF_FPU | BR };
+        case InstId::Bc1fl: return { "bc1fl", IF_FPU | BR | IF_LIKELY };
+        case InstId::Bc1tl: return { "bc1tl", IF_FPU | BR | IF_LIKELY };
+        case InstId::AddS:  return { "add.s", IF_FPU };
+        case InstId::SubS:  return { "sub.s", IF_FPU };
+        case InstId::MulS:  return { "mul.s", IF_FPU };
+        case InstId::DivS:  return { "div.s", IF_FPU };
+        case InstId::SqrtS: return { "sqrt.s", IF_FPU };
+        case InstId::AbsS:  return { "abs.s", IF_FPU };
+        case InstId::MovS:  return { "mov.s", IF_FPU };
+        case InstId::NegS:  return { "neg.s", IF_FPU };
+        case InstId::RoundWS: return { "round.w.s", IF_FPU };
+        case InstId::TruncWS: return { "trunc.w.s", IF_FPU };
+        case InstId::CeilWS:  return { "ceil.w.s", IF_FPU };
+        case InstId::FloorWS: return { "floor.w.s", IF_FPU };
+        case InstId::CvtWS: return { "cvt.w.s", IF_FPU };
+        case InstId::CvtSW: return { "cvt.s.w", IF_FPU };
+        case InstId::CmpS:  return { "c.cond.s", IF_FPU };
+        case InstId::Lwc1:  return { "lwc1", IF_FPU | IF_LOAD | RS };
+        case InstId::Swc1:  return { "swc1", IF_FPU | IF_STORE | RS };
+
+        case InstId::Mfv:  return { "mfv", IF_VFPU | IF_OUT_RT };
+        case InstId::Mtv:  return { "mtv", IF_VFPU | RT };
+        case InstId::Bvf:  return { "bvf", IF_VFPU | BR };
+        case InstId::Bvt:  return { "bvt", IF_VFPU | BR };
+        case InstId::Bvfl: return { "bvfl", IF_VFPU | BR | IF_LIKELY };
+        case InstId::Bvtl: return { "bvtl", IF_VFPU | BR | IF_LIKELY };
+        case InstId::Vadd: return { "vadd", IF_VFPU };
+        case InstId::Vsub: return { "vsub", IF_VFPU };
+        case InstId::Vsbn: return { "vsbn", IF_VFPU };
+        case InstId::Vdiv: return { "vdiv", IF_VFPU };
+        case InstId::Vmul: return { "vmul", IF_VFPU };
+        case InstId::Vdot: return { "vdot", IF_VFPU };
+        case InstId::Vscl: return { "vscl", IF_VFPU };
+        case InstId::Vhdp: return { "vhdp", IF_VFPU };
+        case InstId::Vcrs: return { "vcrs", IF_VFPU };
+        case InstId::Vdet: return { "vdet", IF_VFPU };
+        case InstId::Vcmp: return { "vcmp", IF_VFPU };
+        case InstId::Vmin: return { "vmin", IF_VFPU };
+        case InstId::Vmax: return { "vmax", IF_VFPU };
+        case InstId::Vscmp: return { "vscmp", IF_VFPU };
+        case InstId::Vsge: return { "vsge", IF_VFPU };
+        case InstId::Vslt: return { "vslt", IF_VFPU };
+        case InstId::VfpuUnary:   return { "vfpu.unary", IF_VFPU };
+        case InstId::VfpuPrefix:  return { "vfpu.prefix", IF_VFPU };
+        case InstId::VfpuMatrix:  return { "vfpu.matrix", IF_VFPU };
+        case InstId::VfpuControl: return { "vfpu.control", IF_VFPU };
+        case InstId::LvS:   return { "lv.s", IF_VFPU | IF_LOAD | RS };
+        case InstId::LvQ:   return { "lv.q", IF_VFPU | IF_LOAD | RS };
+        case InstId::LvlrQ: return { "lvl.q", IF_VFPU | IF_LOAD | RS };
+        case InstId::SvS:   return { "sv.s", IF_VFPU | IF_STORE | RS };
+        case InstId::SvQ:   return { "sv.q", IF_VFPU | IF_STORE | RS };
+        case InstId::SvlrQ: return { "svl.q", IF_VFPU | IF_STORE | RS };
+
+        case InstId::Count: break;
+    }
+    return { "unknown", 0 };
+}
+
+// Уровни многоуровневой таблицы: индекс = (word >> shift) & mask
+struct DecodeLevel {
+    uint8_t shift;
+    uint8_t mask;
+    uint16_t first;     // смещение первой записи уровня в общем массиве
+};
+
+// Запись таблицы: либо инструкция, либо ссылка на подтаблицу (next != 0)
+struct DecodeEntry {
+    InstId id;
+    uint8_t next;
+};
+
+enum Level : uint8_t {
+    L_PRIMARY, L_SPECIAL, L_REGIMM, L_SRL, L_SRLV, L_SPECIAL2, L_SPECIAL3, L_BSHFL,
+    L_COP0, L_COP0_CO, L_COP1, L_BC1, L_FPU_S, L_FPU_W, L_COP2, L_BVC,
+    L_VFPU0, L_VFPU1, L_VFPU3,
+    NUM_LEVELS
+};
+
+constexpr std::array<DecodeLevel, NUM_LEVELS> BuildLevels() {
+    constexpr uint8_t shape[NUM_LEVELS][2] = {
+        { 26, 63 },  // L_PRIMARY: opcode
+        { 0, 63 },   // L_SPECIAL: funct
+        { 16, 31 },  // L_REGIMM: rt
+        { 21, 1 },   // L_SRL: srl/rotr по младшему биту rs
+        { 6, 1 },    // L_SRLV: srlv/rotrv по младшему биту shamt
+        { 0, 63 },   // L_SPECIAL2: funct
+        { 0, 63 },   // L_SPECIAL3: funct
+        { 6, 31 },   // L_BSHFL: shamt
+        { 21, 31 },  // L_COP0: rs
+        { 0, 63 },   // L_COP0_CO: funct
+        { 21, 31 },  // L_COP1: rs (fmt)
+        { 16, 3 },   // L_BC1: nd/tf
+        { 0, 63 },   // L_FPU_S: funct
+        { 0, 63 },   // L_FPU_W: funct
+        { 21, 31 },  // L_COP2: rs
+        { 16, 3 },   // L_BVC: nd/tf
+        { 23, 7 },   // L_VFPU0
+        { 23, 7 },   // L_VFPU1
+        { 23, 7 },   // L_VFPU3
+    };
+    std::array<DecodeLevel, NUM_LEVELS> levels{};
+    uint16_t first = 0;
+    for (size_t n = 0; n < NUM_LEVELS; ++n) {
+        levels[n] = { shape[n][0], shape[n][1], first };
+        first = uint16_t(first + shape[n][1] + 1);
+    }
+    return levels;
+}
+
+inline constexpr std::array<DecodeLevel, NUM_LEVELS> kDecodeLevels = BuildLevels();
+inline constexpr size_t NUM_DECODE_ENTRIES =
+    kDecodeLevels[NUM_LEVELS - 1].first + kDecodeLevels[NUM_LEVELS - 1].mask + 1;
+
+constexpr std::array<DecodeEntry, NUM_DECODE_ENTRIES> BuildEntries() {
+    std::array<DecodeEntry, NUM_DECODE_ENTRIES> e{};
+    for (DecodeEntry& entry : e) entry = { InstId::Invalid, 0 };
+
+    auto set = [&](Level level, uint32_t index, InstId id) {
+        e[kDecodeLevels[level].first + index] = { id, 0 };
+    };
+    auto sub = [&](Level level, uint32_t index, Level next) {
+        e[kDecodeLevels[level].first + index] = { InstId::Invalid, uint8_t(next) };
+    };
+
+    // Основные опкоды
+    sub(L_PRIMARY, 0x00, L_SPECIAL);
+    sub(L_PRIMARY, 0x01, L_REGIMM);
+    set(L_PRIMARY, 0x02, InstId::J);
+    set(L_PRIMARY, 0x03, InstId::Jal);
+    set(L_PRIMARY, 0x04, InstId::Beq);
+    set(L_PRIMARY, 0x05, InstId::Bne);
+    set(L_PRIMARY, 0x06, InstId::Blez);
+    set(L_PRIMARY, 0x07, InstId::Bgtz);
+    set(L_PRIMARY, 0x08, InstId::Addi);
+    set(L_PRIMARY, 0x09, InstId::Addiu);
+    set(L_PRIMARY, 0x0A, InstId::Slti);
+    set(L_PRIMARY, 0x0B, InstId::Sltiu);
+    set(L_PRIMARY, 0x0C, InstId::Andi);
+    set(L_PRIMARY, 0x0D, InstId::Ori);
+    set(L_PRIMARY, 0x0E, InstId::Xori);
+    set(L_PRIMARY, 0x0F, InstId::Lui);
+    sub(L_PRIMARY, 0x10, L_COP0);
+    sub(L_PRIMARY, 0x11, L_COP1);
+    sub(L_PRIMARY, 0x12, L_COP2);
+    set(L_PRIMARY, 0x14, InstId::Beql);
+    set(L_PRIMARY, 0x15, InstId::Bnel);
+    set(L_PRIMARY, 0x16, InstId::Blezl);
+    set(L_PRIMARY, 0x17, InstId::Bgtzl);
+    sub(L_PRIMARY, 0x18, L_VFPU0);
+    sub(L_PRIMARY, 0x19, L_VFPU1);
+    sub(L_PRIMARY, 0x1B, L_VFPU3);
+    sub(L_PRIMARY, 0x1C, L_SPECIAL2);
+    sub(L_PRIMARY, 0x1F, L_SPECIAL3);
+    set(L_PRIMARY, 0x20, InstId::Lb);
+    set(L_PRIMARY, 0x21, InstId::Lh);
+    set(L_PRIMARY, 0x22, InstId::Lwl);
+    set(L_PRIMARY, 0x23, InstId::Lw);
+    set(L_PRIMARY, 0x24, InstId::Lbu);
+    set(L_PRIMARY, 0x25, InstId::Lhu);
+    set(L_PRIMARY, 0x26, InstId::Lwr);
+    set(L_PRIMARY, 0x28, InstId::Sb);
+    set(L_PRIMARY, 0x29, InstId::Sh);
+    set(L_PRIMARY, 0x2A, InstId::Swl);
+    set(L_PRIMARY, 0x2B, InstId::Sw);
+    set(L_PRIMARY, 0x2E, InstId::Swr);
+    set(L_PRIMARY, 0x2F, InstId::Cache);
+    set(L_PRIMARY, 0x30, InstId::Ll);
+    set(L_PRIMARY, 0x31, InstId::Lwc1);
+    set(L_PRIMARY, 0x32, InstId::LvS);
+    set(L_PRIMARY, 0x34, InstId::VfpuUnary);
+    set(L_PRIMARY, 0x35, InstId::LvlrQ);
+    set(L_PRIMARY, 0x36, InstId::LvQ);
+    set(L_PRIMARY, 0x37, InstId::VfpuPrefix);
+    set(L_PRIMARY, 0x38, InstId::Sc);
+    set(L_PRIMARY, 0x39, InstId::Swc1);
+    set(L_PRIMARY, 0x3A, InstId::SvS);
+    set(L_PRIMARY, 0x3C, InstId::VfpuMatrix);
+    set(L_PRIMARY, 0x3D, InstId::SvlrQ);
+    set(L_PRIMARY, 0x3E, InstId::SvQ);
+    set(L_PRIMARY, 0x3F, InstId::VfpuControl);
+
+    // SPECIAL
+    set(L_SPECIAL, 0x00, InstId::Sll);
+    sub(L_SPECIAL, 0x02, L_SRL);
+    set(L_SPECIAL, 0x03, InstId::Sra);
+    set(L_SPECIAL, 0x04, InstId::Sllv);
+    sub(L_SPECIAL, 0x06, L_SRLV);
+    set(L_SPECIAL, 0x07, InstId::Srav);
+    set(L_SPECIAL, 0x08, InstId::Jr);
+    set(L_SPECIAL, 0x09, InstId::Jalr);
+    set(L_SPECIAL, 0x0A, InstId::Movz);
+    set(L_SPECIAL, 0x0B, InstId::Movn);
+    set(L_SPECIAL, 0x0C, InstId::Syscall);
+    set(L_SPECIAL, 0x0D, InstId::Break);
+    set(L_SPECIAL, 0x0F, InstId::Sync);
+    set(L_SPECIAL, 0x10, InstId::Mfhi);
+    set(L_SPECIAL, 0x11, InstId::Mthi);
+    set(L_SPECIAL, 0x12, InstId::Mflo);
+    set(L_SPECIAL, 0x13, InstId::Mtlo);
+    set(L_SPECIAL, 0x16, InstId::Clz);
+    set(L_SPECIAL, 0x17, InstId::Clo);
+    set(L_SPECIAL, 0x18, InstId::Mult);
+    set(L_SPECIAL, 0x19, InstId::Multu);
+    set(L_SPECIAL, 0x1A, InstId::Div);
+    set(L_SPECIAL, 0x1B, InstId::Divu);
+    set(L_SPECIAL, 0x1C, InstId::Madd);
+    set(L_SPECIAL, 0x1D, InstId::Maddu);
+    set(L_SPECIAL, 0x20, InstId::Add);
+    set(L_SPECIAL, 0x21, InstId::Addu);
+    set(L_SPECIAL, 0x22, InstId::Sub);
+    set(L_SPECIAL, 0x23, InstId::Subu);
+    set(L_SPECIAL, 0x24, InstId::And);
+    set(L_SPECIAL, 0x25, InstId::Or);
+    set(L_SPECIAL, 0x26, InstId::Xor);
+    set(L_SPECIAL, 0x27, InstId::Nor);
+    set(L_SPECIAL, 0x2A, InstId::Slt);
+    set(L_SPECIAL, 0x2B, InstId::Sltu);
+    set(L_SPECIAL, 0x2C, InstId::Max);
+    set(L_SPECIAL, 0x2D, InstId::Min);
+    set(L_SPECIAL, 0x2E, InstId::Msub);
+    set(L_SPECIAL, 0x2F, InstId::Msubu);
+
+    set(L_SRL, 0, InstId::Srl);
+    set(L_SRL, 1, InstId::Rotr);
+    set(L_SRLV, 0, InstId::Srlv);
+    set(L_SRLV, 1, InstId::Rotrv);
+
+    // REGIMM
+    set(L_REGIMM, 0x00, InstId::Bltz);
+    set(L_REGIMM, 0x01, InstId::Bgez);
+    set(L_REGIMM, 0x02, InstId::Bltzl);
+    set(L_REGIMM, 0x03, InstId::Bgezl);
+    set(L_REGIMM, 0x10, InstId::Bltzal);
+    set(L_REGIMM, 0x11, InstId::Bgezal);
+    set(L_REGIMM, 0x12, InstId::Bltzall);
+    set(L_REGIMM, 0x13, InstId::Bgezall);
+
+    // SPECIAL2 / SPECIAL3
+    set(L_SPECIAL2, 0x00, InstId::Halt);
+    set(L_SPECIAL2, 0x24, InstId::Mfic);
+    set(L_SPECIAL2, 0x26, InstId::Mtic);
+    set(L_SPECIAL3, 0x00, InstId::Ext);
+    set(L_SPECIAL3, 0x04, InstId::Ins);
+    sub(L_SPECIAL3, 0x20, L_BSHFL);
+    set(L_BSHFL, 0x02, InstId::Wsbh);
+    set(L_BSHFL, 0x03, InstId::Wsbw);
+    set(L_BSHFL, 0x10, InstId::Seb);
+    set(L_BSHFL, 0x14, InstId::Bitrev);
+    set(L_BSHFL, 0x18, InstId::Seh);
+
+    // COP0
+    set(L_COP0, 0x00, InstId::Mfc0);
+    set(L_COP0, 0x04, InstId::Mtc0);
+    sub(L_COP0, 0x10, L_COP0_CO);
+    set(L_COP0_CO, 0x18, InstId::Eret);
+
+    // COP1
+    set(L_COP1, 0x00, InstId::Mfc1);
+    set(L_COP1, 0x02, InstId::Cfc1);
+    set(L_COP1, 0x04, InstId::Mtc1);
+    set(L_COP1, 0x06, InstId::Ctc1);
+    sub(L_COP1, 0x08, L_BC1);
+    sub(L_COP1, 0x10, L_FPU_S);
+    sub(L_COP1, 0x14, L_FPU_W);
+    set(L_BC1, 0, InstId::Bc1f);
+    set(L_BC1, 1, InstId::Bc1t);
+    set(L_BC1, 2, InstId::Bc1fl);
+    set(L_BC1, 3, InstId::Bc1tl);
+    set(L_FPU_S, 0x00, InstId::AddS);
+    set(L_FPU_S, 0x01, InstId::SubS);
+    set(L_FPU_S, 0x02, InstId::MulS);
+    set(L_FPU_S, 0x03, InstId::DivS);
+    set(L_FPU_S, 0x04, InstId::SqrtS);
+    set(L_FPU_S, 0x05, InstId::AbsS);
+    set(L_FPU_S, 0x06, InstId::MovS);
+    set(L_FPU_S, 0x07, InstId::NegS);
+    set(L_FPU_S, 0x0C, InstId::RoundWS);
+    set(L_FPU_S, 0x0D, InstId::TruncWS);
+    set(L_FPU_S, 0x0E, InstId::CeilWS);
+    set(L_FPU_S, 0x0F, InstId::FloorWS);
+    set(L_FPU_S, 0x24, InstId::CvtWS);
+    for (uint32_t cond = 0x30; cond <= 0x3F; ++cond) {
+        set(L_FPU_S, cond, InstId::CmpS);
+    }
+    set(L_FPU_W, 0x20, InstId::CvtSW);
+
+    // COP2 / VFPU
+    set(L_COP2, 0x03, InstId::Mfv);
+    set(L_COP2, 0x07, InstId::Mtv);
+    sub(L_COP2, 0x08, L_BVC);
+    set(L_BVC, 0, InstId::Bvf);
+    set(L_BVC, 1, InstId::Bvt);
+    set(L_BVC, 2, InstId::Bvfl);
+    set(L_BVC, 3, InstId::Bvtl);
+    set(L_VFPU0, 0, InstId::Vadd);
+    set(L_VFPU0, 1, InstId::Vsub);
+    set(L_VFPU0, 2, InstId::Vsbn);
+    set(L_VFPU0, 7, InstId::Vdiv);
+    set(L_VFPU1, 0, InstId::Vmul);
+    set(L_VFPU1, 1, InstId::Vdot);
+    set(L_VFPU1, 2, InstId::Vscl);
+    set(L_VFPU1, 4, InstId::Vhdp);
+    set(L_VFPU1, 5, InstId::Vcrs);
+    set(L_VFPU1, 6, InstId::Vdet);
+    set(L_VFPU3, 0, InstId::Vcmp);
+    set(L_VFPU3, 2, InstId::Vmin);
+    set(L_VFPU3, 3, InstId::Vmax);
+    set(L_VFPU3, 5, InstId::Vscmp);
+    set(L_VFPU3, 6, InstId::Vsge);
+    set(L_VFPU3, 7, InstId::Vslt);
+
+    return e;
+}
+
+constexpr std::array<InstInfo, NUM_INST_IDS> BuildInfo() {
+    std::array<InstInfo, NUM_INST_IDS> info{};
+    for (size_t n = 0; n < NUM_INST_IDS; ++n) {
+        info[n] = MakeInfo(static_cast<InstId>(n));
+    }
+    return info;
+}
+
+inline constexpr std::array<DecodeEntry, NUM_DECODE_ENTRIES> kDecodeEntries = BuildEntries();
+inline constexpr std::array<InstInfo, NUM_INST_IDS> kInstInfo = BuildInfo();
+
+}  // namespace detail
+
+// Идентификатор инструкции: одна-две загрузки из таблицы для большинства слов
+constexpr InstId LookupInstId(uint32_t word) {
+    const detail::DecodeEntry* e = &detail::kDecodeEntries[word >> 26];
+    while (e->next != 0) {
+        const detail::DecodeLevel& level = detail::kDecodeLevels[e->next];
+        e = &detail::kDecodeEntries[level.first + ((word >> level.shift) & level.mask)];
+    }
+    return e->id;
+}
+
+constexpr const InstInfo& GetInstInfo(InstId id) {
+    return detail::kInstInfo[static_cast<size_t>(id)];
+}
+
+// Множества GPR, читаемых и записываемых инструкцией ($zero исключён).
+// Для условной записи приёмник считается и читаемым: старое значение может сохраниться.
+constexpr uint32_t GprReadMask(uint32_t word, uint32_t flags) {
+    uint32_t mask = 0;
+    if (flags & IF_IN_RS) mask |= 1u << ((word >> 21) & 31);
+    if (flags & IF_IN_RT) mask |= 1u << ((word >> 16) & 31);
+    if (flags & IF_COND_WRITE) mask |= 1u << ((word >> 11) & 31);
+    return mask & ~1u;
+}
+
+constexpr uint32_t GprWriteMask(uint32_t word, uint32_t flags) {
+    uint32_t mask = 0;
+    if (flags & IF_OUT_RD) mask |= 1u << ((word >> 11) & 31);
+    if (flags & IF_OUT_RT) mask |= 1u << ((word >> 16) & 31);
+    if (flags & IF_LINK) mask |= 1u << 31;
+    return mask & ~1u;
+}
+
+static_assert(LookupInstId(0x00000000) == InstId::Sll, "nop decodes as sll");
+static_assert(LookupInstId(0x00200002) == InstId::Rotr, "srl with rs=1 is rotr");
+static_assert(LookupInstId(0x7C000420) == InstId::Seb, "bshfl sub-table");
+static_assert(LookupInstId(0x45010000) == InstId::Bc1t, "bc1 sub-table");
+static_assert(GetInstInfo(InstId::Bgezall).flags & IF_LIKELY, "info table is aligned with InstId");
+
+}  // namespace core
+}  // namespace ppsspp
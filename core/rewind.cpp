@@ -0,0 +1,38 @@
+// core/rewind.cpp
+
+#include "rewind.h"
+
+namespace ppsspp {
+namespace core {
+
+RewindBuffer::RewindBuffer(Memory& memory, size_t capacity)
+    : memory_(memory), capacity_(capacity ? capacity : 1) {}
+
+void RewindBuffer::Push() {
+    if (snapshots_.size() == capacity_) {
+        snapshots_.pop_front();
+    }
+    snapshots_.push_back(memory_.TakeSnapshot());
+}
+
+bool RewindBuffer::Rewind() {
+    if (snapshots_.empty()) return false;
+    memory_.RestoreSnapshot(*snapshots_.back());
+    snapshots_.pop_back();
+    return true;
+}
+
+void RewindBuffer::Clear() {
+    snapshots_.clear();
+}
+
+size_t RewindBuffer::GetSavedBytes() const {
+    size_t bytes = 0;
+    for (const auto& snapshot : snapshots_) {
+        bytes += snapshot->GetSavedBytes();
+    }
+    return bytes;
+}
+
+}  // namespace core
+}  // namespace ppsspp
@@ -0,0 +1,43 @@
+// core/rewind.h
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+
+#include "memory.h"
+
+namespace ppsspp {
+namespace core {
+
+// Кольцо снимков памяти для перемотки назад. Снимки копируют страницы только
+// при записи, поэтому кадр стоит столько, сколько страниц гость изменил.
+// Регистры CPU сохраняет вызывающий вместе со снимком.
+class RewindBuffer {
+public:
+    RewindBuffer(Memory& memory, size_t capacity);
+
+    // Запрещаем копирование
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+    // Снимок текущего состояния (обычно раз в кадр); самый старый вытесняется
+    void Push();
+    // Возвращает память к последнему снимку и убирает его; false - кольцо пусто
+    bool Rewind();
+    void Clear();
+
+    size_t GetCount() const { return snapshots_.size(); }
+    size_t GetCapacity() const { return capacity_; }
+    // Память, занятая скопированными страницами всех снимков
+    size_t GetSavedBytes() const;
+
+private:
+    Memory& memory_;
+    size_t capacity_;
+    std::deque<std::shared_ptr<MemorySnapshot>> snapshots_;
+};
+
+}  // namespace core
+}  // namespace ppsspp
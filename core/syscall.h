@@ -5,14 +5,12 @@
 namespace ppsspp {
 namespace syscall {
 
-enum SyscallID : uint32_t {
-    SYSCALL_EXIT = 0x00000001,
-    SYSCALL_GET_TIME = 0x00000002,
-    SYSCALL_CTRL_INPUT = 0x00000003,
-    // и т.п.
-};
-
+// Точка выхода интерпретатора в HLE. syscallID - код из заглушки импорта,
+// то есть индекс в NID_TABLE; разбор выполняет SyscallHandler::Invoke
 void HandleSyscall(core::CPUState* st, uint32_t syscallID);
 
+// Удаляет обработчик HLE, созданный для завершающейся core::System
+void ResetSyscallHandler();
+
 }
 }
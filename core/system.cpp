@@ -0,0 +1,85 @@
+// core/system.cpp
+
+#include "system.h"
+#include "syscall.h"
+#include "logger.h"
+
+namespace ppsspp {
+namespace core {
+
+namespace {
+
+System* g_currentSystem = nullptr;
+
+}  // namespace
+
+// Память - по карте PSP: без резерва адресного пространства Memory
+// сама переходит на плоскую
+System::System(bool useJit)
+    : memory_(true), blocks_(memory_), interpreter_(cpu_, memory_, blocks_) {
+    cpu_.SetMemory(&memory_);
+    memory_.MapMmio(ControllerMmio::BASE, ControllerMmio::SIZE, &controller_);
+#ifdef PPSSPP_JIT_X64
+    if (useJit) {
+        jit_ = std::make_unique<jit::Jit>(cpu_, memory_, blocks_);
+        if (!jit_->IsValid()) {
+            LogWarning("JIT code cache is unavailable, using the interpreter");
+            jit_.reset();
+        }
+    }
+#else
+    (void)useJit;
+#endif
+    g_currentSystem = this;
+}
+
+System::~System() {
+    // HLE держит ссылки на CPU, память и события CoreTiming системы
+    syscall::ResetSyscallHandler();
+    if (g_currentSystem == this) g_currentSystem = nullptr;
+}
+
+System* System::GetCurrent() {
+    return g_currentSystem;
+}
+
+bool System::IsJitEnabled() const {
+#ifdef PPSSPP_JIT_X64
+    return jit_ != nullptr;
+#else
+    return false;
+#endif
+}
+
+void System::SetSyscallHook(SyscallHook hook) {
+    interpreter_.SetSyscallHook(hook);
+#ifdef PPSSPP_JIT_X64
+    if (jit_) jit_->SetSyscallHook(hook);
+#endif
+}
+
+int64_t System::RunSlice() {
+    const int64_t slice = timing_.GetSliceLength();
+#ifdef PPSSPP_JIT_X64
+    if (jit_) {
+        timing_.BeginSlice(slice, jit_->GetDowncountPtr());
+        const int64_t executed = jit_->Run(slice);
+        timing_.Advance(executed);
+        return executed;
+    }
+#endif
+    timing_.BeginSlice(slice, interpreter_.GetDowncountPtr());
+    const int64_t executed = interpreter_.Run(slice);
+    timing_.Advance(executed);
+    return executed;
+}
+
+void System::Run() {
+    while (!stopRequested_.load(std::memory_order_relaxed) && cpu_.GetPC() != CPUState::INVALID_PC) {
+        RunSlice();
+    }
+    stopRequested_.store(false, std::memory_order_relaxed);
+}
+
+}  // namespace core
+}  // namespace ppsspp
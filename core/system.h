@@ -0,0 +1,76 @@
+// core/system.h
+
+#pragma once
+
+#include "block_cache.h"
+#include "core_timing.h"
+#include "cpu_state.h"
+#include "interpreter.h"
+#include "memory.h"
+#include "mmio.h"
+#include "../jit/x64_jit.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ppsspp {
+namespace core {
+
+// Эмулируемая PSP: память, CPU, кэш блоков, исполнитель, эмулируемое время
+// и блок контроллера, отображённый в адресное пространство.
+//
+// CoreTiming принадлежит системе, а не HLE: главный цикл считает циклы с
+// первой инструкции, а HLE (vblank, потоки, ввод-вывод) планирует события в
+// ту же очередь. Обработчик HLE находит систему через GetCurrent().
+class System {
+public:
+    // useJit - рекомпилятор, если он есть на этой платформе
+    explicit System(bool useJit = true);
+    ~System();
+
+    // Запрещаем копирование
+    System(const System&) = delete;
+    System& operator=(const System&) = delete;
+
+    // Последняя созданная система; nullptr - её нет
+    static System* GetCurrent();
+
+    Memory& GetMemory() { return memory_; }
+    CPUState& GetCPU() { return cpu_; }
+    BlockCache& GetBlocks() { return blocks_; }
+    CoreTiming& GetTiming() { return timing_; }
+    // Состояние выставляет InputSystem, читают гость и HLE
+    ControllerMmio& GetController() { return controller_; }
+    bool IsJitEnabled() const;
+
+    // Обработчик syscall для интерпретатора и JIT
+    void SetSyscallHook(SyscallHook hook);
+
+    // Один отрезок до ближайшего события: timing.Advance(cpu.Run(slice)).
+    // HLE внутри отрезка видит время с уже исполненными блоками.
+    // Возвращает количество исполненных инструкций
+    int64_t RunSlice();
+
+    // Исполняет отрезки, пока гость не завершился (PC = INVALID_PC)
+    // или не вызван Stop()
+    void Run();
+    // Может вызываться из другого потока и из событий CoreTiming
+    void Stop() { stopRequested_.store(true, std::memory_order_relaxed); }
+
+private:
+    // Раньше памяти: переживает своё отображение
+    ControllerMmio controller_;
+    Memory memory_;
+    CPUState cpu_;
+    BlockCache blocks_;
+    CoreTiming timing_;
+    Interpreter interpreter_;
+#ifdef PPSSPP_JIT_X64
+    std::unique_ptr<jit::Jit> jit_;
+#endif
+    std::atomic<bool> stopRequested_{ false };
+};
+
+}  // namespace core
+}  // namespace ppsspp
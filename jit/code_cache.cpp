@@ -0,0 +1,40 @@
+// jit/code_cache.cpp
+
+#include "code_cache.h"
+#include "../core/logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace ppsspp {
+namespace jit {
+
+CodeCache::CodeCache(size_t size) : size_(size) {
+#ifdef _WIN32
+    void* mem = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+    base_ = static_cast<uint8_t*>(mem);
+#else
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    base_ = mem == MAP_FAILED ? nullptr : static_cast<uint8_t*>(mem);
+#endif
+    if (!base_) {
+        size_ = 0;
+        core::LogError("Failed to allocate JIT code cache");
+    }
+}
+
+CodeCache::~CodeCache() {
+    if (!base_) return;
+#ifdef _WIN32
+    VirtualFree(base_, 0, MEM_RELEASE);
+#else
+    munmap(base_, size_);
+#endif
+}
+
+}  // namespace jit
+}  // namespace ppsspp
@@ -0,0 +1,31 @@
+// jit/code_cache.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ppsspp {
+namespace jit {
+
+// Исполняемая область памяти для сгенерированного кода
+class CodeCache {
+public:
+    explicit CodeCache(size_t size);
+    ~CodeCache();
+
+    // Запрещаем копирование
+    CodeCache(const CodeCache&) = delete;
+    CodeCache& operator=(const CodeCache&) = delete;
+
+    bool IsValid() const { return base_ != nullptr; }
+    uint8_t* GetBase() const { return base_; }
+    size_t GetSize() const { return size_; }
+
+private:
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace jit
+}  // namespace ppsspp
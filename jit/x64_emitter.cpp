@@ -0,0 +1,242 @@
+// jit/x64_emitter.cpp
+
+#include "x64_emitter.h"
+
+#include <cstring>
+
+namespace ppsspp {
+namespace jit {
+
+void X64Emitter::Dword(uint32_t value) {
+    std::memcpy(code_ + pos_, &value, sizeof(value));
+    pos_ += sizeof(value);
+}
+
+void X64Emitter::Qword(uint64_t value) {
+    std::memcpy(code_ + pos_, &value, sizeof(value));
+    pos_ += sizeof(value);
+}
+
+void X64Emitter::Rex(bool w, int reg, int rm) {
+    uint8_t rex = 0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((rm & 8) ? 0x01 : 0);
+    if (rex != 0x40) Byte(rex);
+}
+
+void X64Emitter::ModRMReg(int reg, int rm) {
+    Byte(uint8_t(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+}
+
+// [base + disp]: RSP/R12 требуют SIB, RBP/R13 не допускают mod=00
+void X64Emitter::ModRMMem(int reg, X64Reg base, int32_t disp) {
+    const int b = base & 7;
+    const int r = (reg & 7) << 3;
+    if (disp == 0 && b != 5) {
+        Byte(uint8_t(0x00 | r | b));
+        if (b == 4) Byte(0x24);
+    } else if (disp >= -128 && disp <= 127) {
+        Byte(uint8_t(0x40 | r | b));
+        if (b == 4) Byte(0x24);
+        Byte(uint8_t(int8_t(disp)));
+    } else {
+        Byte(uint8_t(0x80 | r | b));
+        if (b == 4) Byte(0x24);
+        Dword(uint32_t(disp));
+    }
+}
+
+void X64Emitter::MOV32_RM(X64Reg dst, X64Reg base, int32_t disp) {
+    Rex(false, dst, base);
+    Byte(0x8B);
+    ModRMMem(dst, base, disp);
+}
+
+void X64Emitter::MOV32_MR(X64Reg base, int32_t disp, X64Reg src) {
+    Rex(false, src, base);
+    Byte(0x89);
+    ModRMMem(src, base, disp);
+}
+
+void X64Emitter::MOV32_MI(X64Reg base, int32_t disp, uint32_t imm) {
+    Rex(false, 0, base);
+    Byte(0xC7);
+    ModRMMem(0, base, disp);
+    Dword(imm);
+}
+
+void X64Emitter::MOV32_RI(X64Reg dst, uint32_t imm) {
+    Rex(false, 0, dst);
+    Byte(uint8_t(0xB8 + (dst & 7)));
+    Dword(imm);
+}
+
+void X64Emitter::MOV32_RR(X64Reg dst, X64Reg src) {
+    Rex(false, src, dst);
+    Byte(0x89);
+    ModRMReg(src, dst);
+}
+
+void X64Emitter::MOV64_RI(X64Reg dst, uint64_t imm) {
+    Rex(true, 0, dst);
+    Byte(uint8_t(0xB8 + (dst & 7)));
+    Qword(imm);
+}
+
+void X64Emitter::MOV64_RR(X64Reg dst, X64Reg src) {
+    Rex(true, src, dst);
+    Byte(0x89);
+    ModRMReg(src, dst);
+}
+
+void X64Emitter::MOV64_RM(X64Reg dst, X64Reg base, int32_t disp) {
+    Rex(true, dst, base);
+    Byte(0x8B);
+    ModRMMem(dst, base, disp);
+}
+
+// Только AL..BL: без REX байтовые регистры 4..7 означают AH..BH
+void X64Emitter::MOVZX32_R8(X64Reg dst, X64Reg src) {
+    Rex(false, dst, src);
+    Byte(0x0F);
+    Byte(0xB6);
+    ModRMReg(dst, src);
+}
+
+void X64Emitter::ALU32_RR(X64Alu op, X64Reg dst, X64Reg src) {
+    Rex(false, src, dst);
+    Byte(op);
+    ModRMReg(src, dst);
+}
+
+void X64Emitter::ALU32_RI(X64Alu op, X64Reg dst, uint32_t imm) {
+    Rex(false, 0, dst);
+    Byte(0x81);
+    ModRMReg(op >> 3, dst);
+    Dword(imm);
+}
+
+void X64Emitter::ALU64_RI(X64Alu op, X64Reg dst, int32_t imm) {
+    Rex(true, 0, dst);
+    Byte(0x81);
+    ModRMReg(op >> 3, dst);
+    Dword(uint32_t(imm));
+}
+
+void X64Emitter::ALU64_MI(X64Alu op, X64Reg base, int32_t disp, int32_t imm) {
+    Rex(true, 0, base);
+    Byte(0x81);
+    ModRMMem(op >> 3, base, disp);
+    Dword(uint32_t(imm));
+}
+
+void X64Emitter::CMP8_MI(X64Reg base, int32_t disp, uint8_t imm) {
+    Rex(false, 0, base);
+    Byte(0x80);
+    ModRMMem(7, base, disp);
+    Byte(imm);
+}
+
+void X64Emitter::TEST32_RR(X64Reg a, X64Reg b) {
+    Rex(false, b, a);
+    Byte(0x85);
+    ModRMReg(b, a);
+}
+
+void X64Emitter::SHIFT32_RI(X64Shift op, X64Reg dst, uint8_t amount) {
+    Rex(false, 0, dst);
+    Byte(0xC1);
+    ModRMReg(op, dst);
+    Byte(amount);
+}
+
+void X64Emitter::SHIFT32_RCL(X64Shift op, X64Reg dst) {
+    Rex(false, 0, dst);
+    Byte(0xD3);
+    ModRMReg(op, dst);
+}
+
+void X64Emitter::NOT32(X64Reg dst) {
+    Rex(false, 0, dst);
+    Byte(0xF7);
+    ModRMReg(2, dst);
+}
+
+void X64Emitter::MUL32(X64Reg src) {
+    Rex(false, 0, src);
+    Byte(0xF7);
+    ModRMReg(4, src);
+}
+
+void X64Emitter::IMUL32(X64Reg src) {
+    Rex(false, 0, src);
+    Byte(0xF7);
+    ModRMReg(5, src);
+}
+
+// Только AL..BL, см. MOVZX32_R8
+void X64Emitter::SETcc(X64Cond cc, X64Reg dst) {
+    Byte(0x0F);
+    Byte(uint8_t(0x90 + cc));
+    ModRMReg(0, dst);
+}
+
+uint8_t* X64Emitter::JMP32() {
+    Byte(0xE9);
+    uint8_t* patch = GetCodePtr();
+    Dword(0);
+    return patch;
+}
+
+uint8_t* X64Emitter::Jcc32(X64Cond cc) {
+    Byte(0x0F);
+    Byte(uint8_t(0x80 + cc));
+    uint8_t* patch = GetCodePtr();
+    Dword(0);
+    return patch;
+}
+
+void X64Emitter::JMP(const uint8_t* target) {
+    SetJumpTarget(JMP32(), target);
+}
+
+void X64Emitter::Jcc(X64Cond cc, const uint8_t* target) {
+    SetJumpTarget(Jcc32(cc), target);
+}
+
+void X64Emitter::JMP_R(X64Reg target) {
+    Rex(false, 0, target);
+    Byte(0xFF);
+    ModRMReg(4, target);
+}
+
+void X64Emitter::CALL_R(X64Reg target) {
+    Rex(false, 0, target);
+    Byte(0xFF);
+    ModRMReg(2, target);
+}
+
+void X64Emitter::PUSH(X64Reg reg) {
+    Rex(false, 0, reg);
+    Byte(uint8_t(0x50 + (reg & 7)));
+}
+
+void X64Emitter::POP(X64Reg reg) {
+    Rex(false, 0, reg);
+    Byte(uint8_t(0x58 + (reg & 7)));
+}
+
+void X64Emitter::RET() {
+    Byte(0xC3);
+}
+
+void X64Emitter::CallFunction(const void* fn) {
+    MOV64_RI(RAX, reinterpret_cast<uint64_t>(fn));
+    CALL_R(RAX);
+}
+
+void X64Emitter::SetJumpTarget(uint8_t* patch, const uint8_t* target) {
+    const int32_t rel = int32_t(target - (patch + 4));
+    std::memcpy(patch, &rel, sizeof(rel));
+}
+
+}  // namespace jit
+}  // namespace ppsspp
@@ -0,0 +1,117 @@
+// jit/x64_emitter.h
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ppsspp {
+namespace jit {
+
+// Регистры x86-64 (номера совпадают с кодировкой)
+enum X64Reg : uint8_t {
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+    R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15,
+};
+
+// Коды условий для Jcc/SETcc
+enum X64Cond : uint8_t {
+    CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5,
+    CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF,
+};
+
+// Двухоперандные ALU-операции (значение - опкод формы r/m, r)
+enum X64Alu : uint8_t {
+    ALU_ADD = 0x01, ALU_OR = 0x09, ALU_AND = 0x21, ALU_SUB = 0x29,
+    ALU_XOR = 0x31, ALU_CMP = 0x39,
+};
+
+// Сдвиги (значение - расширение опкода в ModRM.reg)
+enum X64Shift : uint8_t {
+    SHIFT_ROR = 1, SHIFT_SHL = 4, SHIFT_SHR = 5, SHIFT_SAR = 7,
+};
+
+// Аргументы вызова в соглашении хоста
+#ifdef _WIN32
+constexpr X64Reg ABI_ARG0 = RCX;
+constexpr X64Reg ABI_ARG1 = RDX;
+constexpr X64Reg ABI_ARG2 = R8;
+constexpr int32_t ABI_SHADOW_SPACE = 32;
+#else
+constexpr X64Reg ABI_ARG0 = RDI;
+constexpr X64Reg ABI_ARG1 = RSI;
+constexpr X64Reg ABI_ARG2 = RDX;
+constexpr int32_t ABI_SHADOW_SPACE = 0;
+#endif
+
+// Минимальный кодировщик x86-64 для рекомпилятора.
+// Пишет напрямую в предоставленный буфер; переполнение контролирует вызывающий.
+class X64Emitter {
+public:
+    X64Emitter() = default;
+    X64Emitter(uint8_t* code, size_t size) { SetBuffer(code, size); }
+
+    void SetBuffer(uint8_t* code, size_t size) { code_ = code; size_ = size; pos_ = 0; }
+    void SetPosition(size_t pos) { pos_ = pos; }
+
+    uint8_t* GetCodePtr() const { return code_ + pos_; }
+    size_t GetPosition() const { return pos_; }
+    size_t GetSpaceLeft() const { return size_ - pos_; }
+
+    // Пересылки
+    void MOV32_RM(X64Reg dst, X64Reg base, int32_t disp);      // mov r32, [base+disp]
+    void MOV32_MR(X64Reg base, int32_t disp, X64Reg src);      // mov [base+disp], r32
+    void MOV32_MI(X64Reg base, int32_t disp, uint32_t imm);    // mov dword [base+disp], imm32
+    void MOV32_RI(X64Reg dst, uint32_t imm);
+    void MOV32_RR(X64Reg dst, X64Reg src);
+    void MOV64_RI(X64Reg dst, uint64_t imm);
+    void MOV64_RR(X64Reg dst, X64Reg src);
+    void MOV64_RM(X64Reg dst, X64Reg base, int32_t disp);
+    void MOVZX32_R8(X64Reg dst, X64Reg src);
+
+    // Арифметика
+    void ALU32_RR(X64Alu op, X64Reg dst, X64Reg src);
+    void ALU32_RI(X64Alu op, X64Reg dst, uint32_t imm);
+    void ALU64_RI(X64Alu op, X64Reg dst, int32_t imm);
+    void ALU64_MI(X64Alu op, X64Reg base, int32_t disp, int32_t imm);
+    void CMP8_MI(X64Reg base, int32_t disp, uint8_t imm);
+    void TEST32_RR(X64Reg a, X64Reg b);
+    void SHIFT32_RI(X64Shift op, X64Reg dst, uint8_t amount);
+    void SHIFT32_RCL(X64Shift op, X64Reg dst);
+    void NOT32(X64Reg dst);
+    void MUL32(X64Reg src);   // edx:eax = eax * src (без знака)
+    void IMUL32(X64Reg src);  // edx:eax = eax * src (со знаком)
+    void SETcc(X64Cond cc, X64Reg dst);
+
+    // Управление
+    uint8_t* JMP32();              // Возвращает место для патча rel32
+    uint8_t* Jcc32(X64Cond cc);
+    void JMP(const uint8_t* target);
+    void Jcc(X64Cond cc, const uint8_t* target);
+    void JMP_R(X64Reg target);
+    void CALL_R(X64Reg target);
+    void PUSH(X64Reg reg);
+    void POP(X64Reg reg);
+    void RET();
+
+    // Вызов произвольной функции через RAX
+    void CallFunction(const void* fn);
+
+    // Записывает смещение rel32 перехода, ранее выданного JMP32/Jcc32
+    static void SetJumpTarget(uint8_t* patch, const uint8_t* target);
+
+private:
+    void Byte(uint8_t value) { code_[pos_++] = value; }
+    void Dword(uint32_t value);
+    void Qword(uint64_t value);
+    void Rex(bool w, int reg, int rm);
+    void ModRMReg(int reg, int rm);
+    void ModRMMem(int reg, X64Reg base, int32_t disp);
+
+    uint8_t* code_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+};
+
+}  // namespace jit
+}  // namespace ppsspp
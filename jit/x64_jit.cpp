@@ -0,0 +1,682 @@
+// jit/x64_jit.cpp
+
+#include "x64_jit.h"
+
+#ifdef PPSSPP_JIT_X64
+
+#include "../core/block_cache.h"
+#include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/syscall.h"
+
+#include <cstddef>
+#include <string>
+
+namespace ppsspp {
+namespace jit {
+
+using core::GuestAccess;
+using core::Inst;
+using core::IRInst;
+using core::IROp;
+using core::IR_LIKELY;
+using core::IR_LINK;
+using core::IsIRBranch;
+using core::Memory;
+
+namespace {
+
+constexpr int32_t CTX_PC = int32_t(offsetof(JitContext, exec) + offsetof(core::ExecContext, pc));
+constexpr int32_t CTX_NEXT_PC = int32_t(offsetof(JitContext, exec) + offsetof(core::ExecContext, nextPC));
+constexpr int32_t CTX_BRANCH_TARGET = int32_t(offsetof(JitContext, exec) + offsetof(core::ExecContext, branchTarget));
+constexpr int32_t CTX_GPR = int32_t(offsetof(JitContext, exec) + offsetof(core::ExecContext, gpr));
+constexpr int32_t CTX_DOWNCOUNT = int32_t(offsetof(JitContext, downcount));
+constexpr int32_t CTX_IDLE_SKIPS = int32_t(offsetof(JitContext, idleSkips));
+constexpr int32_t CTX_EXCEPTION = int32_t(offsetof(JitContext, exceptionPending));
+
+// Выравнивание стека и shadow space при вызовах из сгенерированного кода
+constexpr int32_t STACK_ADJUST = 8 + ABI_SHADOW_SPACE;
+
+// Переход без собственной генерации (bc1x и т.п.)
+inline bool IsInterpBranch(const IRInst& ir) {
+    return ir.op == IROp::Interp && (core::GetInstInfo(core::LookupInstId(ir.imm)).flags & core::IF_BRANCH);
+}
+
+// Инструкций гостя от начала блока до pc включительно
+inline uint32_t Executed(const core::Block& block, uint32_t pc) {
+    return (pc - block.startPC) / 4 + 1;
+}
+
+// Исключения не должны раскручиваться через сгенерированный код:
+// вспомогательные функции перехватывают их и выставляют флаг в контексте
+template <typename F>
+inline auto Guarded(JitContext* ctx, F&& f) -> decltype(f()) {
+    try {
+        return f();
+    } catch (...) {
+        ctx->owner->SetPendingException(std::current_exception());
+        ctx->exceptionPending = 1;
+        return decltype(f())();
+    }
+}
+
+// Ошибка доступа записывается Memory без исключения и превращается
+// в исключение только на холодном пути
+template <typename T>
+uint32_t GuestLoad(JitContext* ctx, uint32_t addr) {
+    Memory& mem = *ctx->exec.mem;
+    const T value = mem.Load<T, GuestAccess>(addr);
+    if (mem.HasFault()) [[unlikely]] {
+        Guarded(ctx, [&] { mem.RaiseFault(); });
+    }
+    return uint32_t(value);
+}
+
+template <typename T>
+void GuestStore(JitContext* ctx, uint32_t addr, uint32_t value) {
+    // Запись в код инвалидирует блоки, что может бросить исключение
+    Guarded(ctx, [&] {
+        Memory& mem = *ctx->exec.mem;
+        mem.Store<T, GuestAccess>(addr, T(value));
+        if (mem.HasFault()) [[unlikely]] mem.RaiseFault();
+    });
+}
+
+uint32_t JitRead8S(JitContext* ctx, uint32_t addr) {
+    return uint32_t(int32_t(int8_t(GuestLoad<uint8_t>(ctx, addr))));
+}
+uint32_t JitRead8U(JitContext* ctx, uint32_t addr) {
+    return GuestLoad<uint8_t>(ctx, addr);
+}
+uint32_t JitRead16S(JitContext* ctx, uint32_t addr) {
+    return uint32_t(int32_t(int16_t(GuestLoad<uint16_t>(ctx, addr))));
+}
+uint32_t JitRead16U(JitContext* ctx, uint32_t addr) {
+    return GuestLoad<uint16_t>(ctx, addr);
+}
+uint32_t JitRead32(JitContext* ctx, uint32_t addr) {
+    return GuestLoad<uint32_t>(ctx, addr);
+}
+void JitWrite8(JitContext* ctx, uint32_t addr, uint32_t value) {
+    GuestStore<uint8_t>(ctx, addr, value);
+}
+void JitWrite16(JitContext* ctx, uint32_t addr, uint32_t value) {
+    GuestStore<uint16_t>(ctx, addr, value);
+}
+void JitWrite32(JitContext* ctx, uint32_t addr, uint32_t value) {
+    GuestStore<uint32_t>(ctx, addr, value);
+}
+
+// Выход в HLE через тот же обработчик, что и у интерпретатора
+void JitSyscall(JitContext* ctx, uint32_t code) {
+    if (!ctx->exec.syscall) return;
+    Guarded(ctx, [&] { ctx->exec.syscall(ctx->exec.cpu, code); });
+}
+
+// Инструкции без собственной генерации исполняются обработчиком интерпретатора
+void JitInterpret(JitContext* ctx, const Inst* inst) {
+    Guarded(ctx, [&] { inst->handler(ctx->exec, *inst); });
+}
+
+// Переход через обработчик интерпретатора: цель - в exec.branchTarget.
+// 0 - невыполненный likely-переход, delay slot пропускается
+uint32_t JitInterpretBranch(JitContext* ctx, const Inst* inst) {
+    ctx->exec.branchPending = false;
+    Guarded(ctx, [&] { inst->handler(ctx->exec, *inst); });
+    const bool pending = ctx->exec.branchPending;
+    ctx->exec.branchPending = false;
+    return pending ? 1 : 0;
+}
+
+}  // namespace
+
+Jit::Jit(core::CPUState& cpu, core::Memory& memory, core::BlockCache& blocks)
+    : cpu_(cpu), memory_(memory), blocks_(blocks), codeCache_(CODE_CACHE_SIZE) {
+    ctx_.exec.cpu = &cpu_;
+    ctx_.exec.gpr = cpu_.GetGPRPtr();
+    ctx_.exec.mem = &memory_;
+    ctx_.exec.syscall = &syscall::HandleSyscall;
+    ctx_.owner = this;
+
+    const uint8_t* gpr = reinterpret_cast<const uint8_t*>(cpu_.GetGPRPtr());
+    loOffset_ = int32_t(reinterpret_cast<const uint8_t*>(cpu_.GetLOPtr()) - gpr);
+    hiOffset_ = int32_t(reinterpret_cast<const uint8_t*>(cpu_.GetHIPtr()) - gpr);
+    pcOffset_ = int32_t(reinterpret_cast<const uint8_t*>(cpu_.GetPCPtr()) - gpr);
+
+    if (!codeCache_.IsValid()) return;
+
+    emit_.SetBuffer(codeCache_.GetBase(), codeCache_.GetSize());
+    GenerateStubs();
+
+    blocks_.SetInvalidateCallback([this](uint32_t startPC) {
+        InvalidateBlock(startPC);
+    });
+}
+
+Jit::~Jit() {
+    blocks_.SetInvalidateCallback(nullptr);
+}
+
+void Jit::SetPendingException(std::exception_ptr e) {
+    pendingException_ = e;
+}
+
+void Jit::GenerateStubs() {
+    // uint32_t enter(JitContext* ctx, const uint8_t* code)
+    enter_ = reinterpret_cast<EnterFn>(emit_.GetCodePtr());
+    emit_.PUSH(RBX);
+    emit_.PUSH(RBP);
+    emit_.PUSH(R12);
+    emit_.PUSH(R13);
+    emit_.PUSH(R14);
+    emit_.PUSH(R15);
+    emit_.ALU64_RI(ALU_SUB, RSP, STACK_ADJUST);
+    emit_.MOV64_RR(R12, ABI_ARG0);
+    emit_.MOV64_RM(RBX, R12, CTX_GPR);
+    emit_.JMP_R(ABI_ARG1);
+
+    // Выход из блока: EAX содержит следующий PC гостя
+    exitStub_ = emit_.GetCodePtr();
+    emit_.ALU64_RI(ALU_ADD, RSP, STACK_ADJUST);
+    emit_.POP(R15);
+    emit_.POP(R14);
+    emit_.POP(R13);
+    emit_.POP(R12);
+    emit_.POP(RBP);
+    emit_.POP(RBX);
+    emit_.RET();
+
+    // Исключение во вспомогательной функции: PC указывает на виновную инструкцию
+    exceptionStub_ = emit_.GetCodePtr();
+    emit_.MOV32_RM(RAX, R12, CTX_PC);
+    emit_.JMP(exitStub_);
+
+    codeStart_ = emit_.GetPosition();
+}
+
+void Jit::LinkIncoming(uint32_t target, const uint8_t* entry) {
+    auto it = incoming_.find(target);
+    if (it == incoming_.end()) return;
+    for (uint8_t* patch : it->second) {
+        X64Emitter::SetJumpTarget(patch, entry);
+    }
+    if (entry != exitStub_) {
+        linkCount_ += it->second.size();
+    }
+}
+
+void Jit::InvalidateBlock(uint32_t startPC) {
+    auto it = compiled_.find(startPC);
+    if (it == compiled_.end()) return;
+
+    // Выходы самого блока больше не нужно перенаправлять
+    for (const ExitLink& link : it->second.exits) {
+        auto in = incoming_.find(link.first);
+        if (in == incoming_.end()) continue;
+        std::vector<uint8_t*>& patches = in->second;
+        for (size_t n = 0; n < patches.size(); ++n) {
+            if (patches[n] == link.second) {
+                patches[n] = patches.back();
+                patches.pop_back();
+                break;
+            }
+        }
+        if (patches.empty()) incoming_.erase(in);
+    }
+    compiled_.erase(it);
+
+    // Связанные с ним блоки снова выходят через диспетчер
+    LinkIncoming(startPC, exitStub_);
+}
+
+void Jit::ClearCache() {
+    compiled_.clear();
+    incoming_.clear();
+    emit_.SetPosition(codeStart_);
+}
+
+const uint8_t* Jit::GetOrCompile(uint32_t pc) {
+    auto it = compiled_.find(pc);
+    if (it != compiled_.end()) {
+        return it->second.entry;
+    }
+    return Compile(pc);
+}
+
+int64_t Jit::Run(int64_t cycles) {
+    ctx_.exec.gpr = cpu_.GetGPRPtr();
+    ctx_.downcount = cycles;
+    uint32_t pc = cpu_.GetPC();
+
+    while (ctx_.downcount > 0 && pc != core::CPUState::INVALID_PC) {
+        const uint8_t* code = GetOrCompile(pc);
+        pc = enter_(&ctx_, code);
+
+        if (ctx_.exceptionPending) {
+            ctx_.exceptionPending = 0;
+            *cpu_.GetPCPtr() = pc;
+            std::exception_ptr e = pendingException_;
+            pendingException_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    *cpu_.GetPCPtr() = pc;
+    return cycles - ctx_.downcount;
+}
+
+const uint8_t* Jit::Compile(uint32_t pc) {
+    const core::Block& block = blocks_.GetOrCompile(pc);
+    const Inst* insts = blocks_.GetInsts(block);
+    const IRInst* ir = blocks_.GetIR(block);
+
+    if (emit_.GetSpaceLeft() < block.numInsts * MAX_INST_BYTES + 256) {
+        core::LogInfo("JIT code cache full, flushing");
+        ClearCache();
+    }
+
+    const uint8_t* entry = emit_.GetCodePtr();
+    bool exited = false;
+    pendingExits_.clear();
+
+    for (uint32_t i = 0; i < block.numInsts; ++i) {
+        if (ir[i].op == IROp::Syscall) {
+            CompileSyscall(ir[i], Executed(block, ir[i].pc));
+            exited = true;
+            break;
+        }
+        if (i + 1 < block.numInsts && IsIRBranch(ir[i].op)) {
+            CompileBranch(block, ir, insts, i);
+            exited = true;
+            break;
+        }
+        if (i + 1 < block.numInsts && IsInterpBranch(ir[i])) {
+            CompileInterpBranch(block, ir, insts, i);
+            exited = true;
+            break;
+        }
+        CompileInstruction(ir[i], insts[i], false);
+    }
+
+    if (!exited) {
+        WriteExit(block.endPC, (block.endPC - block.startPC) / 4);
+    }
+
+    JitBlock& jitBlock = compiled_[pc];
+    jitBlock.entry = entry;
+    jitBlock.exits = pendingExits_;
+    for (const ExitLink& link : pendingExits_) {
+        incoming_[link.first].push_back(link.second);
+    }
+    LinkIncoming(pc, entry);
+    return entry;
+}
+
+void Jit::LoadGuestReg(X64Reg reg, uint8_t guest) {
+    if (guest == 0) {
+        emit_.ALU32_RR(ALU_XOR, reg, reg);
+    } else {
+        emit_.MOV32_RM(reg, RBX, GuestRegOffset(guest));
+    }
+}
+
+void Jit::StoreGuestReg(uint8_t guest, X64Reg reg) {
+    if (guest != 0) {
+        emit_.MOV32_MR(RBX, GuestRegOffset(guest), reg);
+    }
+}
+
+void Jit::CheckException() {
+    emit_.CMP8_MI(R12, CTX_EXCEPTION, 0);
+    emit_.Jcc(CC_NE, exceptionStub_);
+}
+
+void Jit::WriteExit(uint32_t target, uint32_t executed) {
+    emit_.ALU64_MI(ALU_SUB, R12, CTX_DOWNCOUNT, int32_t(executed));
+    emit_.MOV32_RI(RAX, target);
+    // Бюджет исчерпан - в диспетчер, иначе прямо в следующий блок
+    emit_.Jcc(CC_LE, exitStub_);
+
+    uint8_t* patch = emit_.JMP32();
+    auto it = compiled_.find(target);
+    X64Emitter::SetJumpTarget(patch, it != compiled_.end() ? it->second.entry : exitStub_);
+    if (it != compiled_.end()) {
+        ++linkCount_;
+    }
+    pendingExits_.emplace_back(target, patch);
+}
+
+void Jit::WriteIdleExit(uint32_t target) {
+    emit_.ALU64_MI(ALU_ADD, R12, CTX_IDLE_SKIPS, 1);
+    emit_.ALU64_MI(ALU_AND, R12, CTX_DOWNCOUNT, 0);
+    emit_.MOV32_RI(RAX, target);
+    emit_.JMP(exitStub_);
+}
+
+void Jit::WriteDynamicExit(X64Reg target, uint32_t executed) {
+    emit_.ALU64_MI(ALU_SUB, R12, CTX_DOWNCOUNT, int32_t(executed));
+    if (target != RAX) {
+        emit_.MOV32_RR(RAX, target);
+    }
+    emit_.JMP(exitStub_);
+}
+
+
+void Jit::CompileBranch(const core::Block& block, const IRInst* ir, const Inst* insts, uint32_t index) {
+    const IRInst& br = ir[index];
+    const IRInst& slot = ir[index + 1];
+    const uint32_t pc = br.pc;
+    const uint32_t executed = Executed(block, pc);
+    const bool likely = (br.flags & IR_LIKELY) != 0;
+    const bool link = (br.flags & IR_LINK) != 0;
+    // syscall в delay slot (заглушка импорта "jr $ra; syscall"): HLE получает
+    // цель перехода как PC возврата и может сменить его, переключив поток
+    const bool slotSyscall = slot.op == IROp::Syscall;
+
+    // Выход по выполненному переходу
+    auto writeTakenExit = [&]() {
+        if (block.idleLoop && br.imm == block.startPC) {
+            WriteIdleExit(br.imm);
+        } else {
+            WriteExit(br.imm, executed + 1);
+        }
+    };
+
+    if (br.op == IROp::Jump) {
+        if (link) {
+            emit_.MOV32_MI(RBX, GuestRegOffset(31), pc + 8);
+        }
+        if (slotSyscall) {
+            emit_.MOV32_MI(RBX, pcOffset_, br.imm);
+            CompileSyscallExit(slot, executed + 1);
+            return;
+        }
+        CompileInstruction(slot, insts[index + 1], true);
+        writeTakenExit();
+        return;
+    }
+    if (br.op == IROp::JumpReg) {
+        // Цель читается до delay slot
+        LoadGuestReg(R13, br.src1);
+        if (br.dst != 0) {
+            emit_.MOV32_MI(RBX, GuestRegOffset(br.dst), pc + 8);
+        }
+        if (slotSyscall) {
+            emit_.MOV32_MR(RBX, pcOffset_, R13);
+            CompileSyscallExit(slot, executed + 1);
+            return;
+        }
+        CompileInstruction(slot, insts[index + 1], true);
+        WriteDynamicExit(R13, executed + 1);
+        return;
+    }
+
+    X64Cond cc = CC_E;
+    switch (br.op) {
+        case IROp::Beq:  cc = CC_E; break;
+        case IROp::Bne:  cc = CC_NE; break;
+        case IROp::Blez: cc = CC_LE; break;
+        case IROp::Bgtz: cc = CC_G; break;
+        case IROp::Bltz: cc = CC_L; break;
+        case IROp::Bgez: cc = CC_GE; break;
+        default: break;
+    }
+
+    // Условие вычисляется до delay slot, который может изменить операнды
+    LoadGuestReg(RAX, br.src1);
+    if (br.op == IROp::Beq || br.op == IROp::Bne) {
+        LoadGuestReg(RCX, br.src2);
+        emit_.ALU32_RR(ALU_CMP, RAX, RCX);
+    } else {
+        emit_.ALU32_RI(ALU_CMP, RAX, 0);
+    }
+    emit_.SETcc(cc, RAX);
+    emit_.MOVZX32_R8(R13, RAX);
+
+    if (link) {
+        emit_.MOV32_MI(RBX, GuestRegOffset(31), pc + 8);
+    }
+
+    if (slotSyscall && !likely) {
+        emit_.MOV32_MI(RBX, pcOffset_, pc + 8);
+        emit_.TEST32_RR(R13, R13);
+        uint8_t* notTaken = emit_.Jcc32(CC_E);
+        emit_.MOV32_MI(RBX, pcOffset_, br.imm);
+        X64Emitter::SetJumpTarget(notTaken, emit_.GetCodePtr());
+        CompileSyscallExit(slot, executed + 1);
+    } else if (!likely) {
+        CompileInstruction(slot, insts[index + 1], true);
+        emit_.TEST32_RR(R13, R13);
+        uint8_t* notTaken = emit_.Jcc32(CC_E);
+        writeTakenExit();
+        X64Emitter::SetJumpTarget(notTaken, emit_.GetCodePtr());
+        WriteExit(pc + 8, executed + 1);
+    } else {
+        // Невыполненный likely-переход пропускает delay slot
+        emit_.TEST32_RR(R13, R13);
+        uint8_t* taken = emit_.Jcc32(CC_NE);
+        WriteExit(pc + 8, executed);
+        X64Emitter::SetJumpTarget(taken, emit_.GetCodePtr());
+        if (slotSyscall) {
+            emit_.MOV32_MI(RBX, pcOffset_, br.imm);
+            CompileSyscallExit(slot, executed + 1);
+            return;
+        }
+        CompileInstruction(slot, insts[index + 1], true);
+        writeTakenExit();
+    }
+}
+
+void Jit::CompileInterpBranch(const core::Block& block, const IRInst* ir, const Inst* insts, uint32_t index) {
+    const IRInst& br = ir[index];
+    const IRInst& slot = ir[index + 1];
+    const uint32_t pc = br.pc;
+    const uint32_t executed = Executed(block, pc);
+
+    // Условие вычисляет обработчик до delay slot
+    emit_.MOV32_MI(R12, CTX_PC, pc);
+    emit_.MOV32_MI(R12, CTX_NEXT_PC, pc + 4);
+    emit_.MOV64_RR(ABI_ARG0, R12);
+    emit_.MOV64_RI(ABI_ARG1, reinterpret_cast<uint64_t>(&insts[index]));
+    emit_.CallFunction(reinterpret_cast<const void*>(&JitInterpretBranch));
+    CheckException();
+
+    if (core::GetInstInfo(core::LookupInstId(br.imm)).flags & core::IF_LIKELY) {
+        emit_.TEST32_RR(RAX, RAX);
+        uint8_t* taken = emit_.Jcc32(CC_NE);
+        WriteExit(pc + 8, executed);
+        X64Emitter::SetJumpTarget(taken, emit_.GetCodePtr());
+    }
+    emit_.MOV32_RM(R13, R12, CTX_BRANCH_TARGET);
+    if (slot.op == IROp::Syscall) {
+        emit_.MOV32_MR(RBX, pcOffset_, R13);
+        CompileSyscallExit(slot, executed + 1);
+        return;
+    }
+    CompileInstruction(slot, insts[index + 1], true);
+    WriteDynamicExit(R13, executed + 1);
+}
+
+void Jit::CompileLoad(const IRInst& ir, const void* helper) {
+    emit_.MOV32_MI(R12, CTX_PC, ir.pc);
+    emit_.MOV64_RR(ABI_ARG0, R12);
+    LoadGuestReg(ABI_ARG1, ir.src1);
+    if (ir.imm != 0) {
+        emit_.ALU32_RI(ALU_ADD, ABI_ARG1, ir.imm);
+    }
+    emit_.CallFunction(helper);
+    CheckException();
+    StoreGuestReg(ir.dst, RAX);
+}
+
+void Jit::CompileStore(const IRInst& ir, const void* helper) {
+    emit_.MOV32_MI(R12, CTX_PC, ir.pc);
+    emit_.MOV64_RR(ABI_ARG0, R12);
+    LoadGuestReg(ABI_ARG1, ir.src1);
+    if (ir.imm != 0) {
+        emit_.ALU32_RI(ALU_ADD, ABI_ARG1, ir.imm);
+    }
+    LoadGuestReg(ABI_ARG2, ir.src2);
+    emit_.CallFunction(helper);
+    CheckException();
+}
+
+void Jit::CompileSyscall(const IRInst& ir, uint32_t executed) {
+    // HLE видит PC возврата и может его изменить
+    emit_.MOV32_MI(RBX, pcOffset_, ir.pc + 4);
+    CompileSyscallExit(ir, executed);
+}
+
+void Jit::CompileSyscallExit(const IRInst& ir, uint32_t executed) {
+    emit_.MOV32_MI(R12, CTX_PC, ir.pc);
+    emit_.MOV64_RR(ABI_ARG0, R12);
+    emit_.MOV32_RI(ABI_ARG1, ir.imm);
+    emit_.CallFunction(reinterpret_cast<const void*>(&JitSyscall));
+    CheckException();
+    emit_.MOV32_RM(RAX, RBX, pcOffset_);
+    WriteDynamicExit(RAX, executed);
+}
+
+void Jit::CompileFallback(const IRInst& ir, const Inst& inst) {
+    emit_.MOV32_MI(R12, CTX_PC, ir.pc);
+    emit_.MOV32_MI(R12, CTX_NEXT_PC, ir.pc + 4);
+    emit_.MOV64_RR(ABI_ARG0, R12);
+    emit_.MOV64_RI(ABI_ARG1, reinterpret_cast<uint64_t>(&inst));
+    emit_.CallFunction(reinterpret_cast<const void*>(&JitInterpret));
+    CheckException();
+}
+
+void Jit::CompileInstruction(const IRInst& ir, const Inst& inst, bool inDelaySlot) {
+    // Трёхоперандная ALU-операция dst = src1 op src2
+    auto aluRR = [&](X64Alu op) {
+        LoadGuestReg(RAX, ir.src1);
+        LoadGuestReg(RCX, ir.src2);
+        emit_.ALU32_RR(op, RAX, RCX);
+        StoreGuestReg(ir.dst, RAX);
+    };
+    auto setRR = [&](X64Cond cc) {
+        LoadGuestReg(RAX, ir.src1);
+        LoadGuestReg(RCX, ir.src2);
+        emit_.ALU32_RR(ALU_CMP, RAX, RCX);
+        emit_.SETcc(cc, RAX);
+        emit_.MOVZX32_R8(RAX, RAX);
+        StoreGuestReg(ir.dst, RAX);
+    };
+    auto aluImm = [&](X64Alu op) {
+        LoadGuestReg(RAX, ir.src1);
+        emit_.ALU32_RI(op, RAX, ir.imm);
+        StoreGuestReg(ir.dst, RAX);
+    };
+    auto setImm = [&](X64Cond cc) {
+        LoadGuestReg(RAX, ir.src1);
+        emit_.ALU32_RI(ALU_CMP, RAX, ir.imm);
+        emit_.SETcc(cc, RAX);
+        emit_.MOVZX32_R8(RAX, RAX);
+        StoreGuestReg(ir.dst, RAX);
+    };
+    auto shiftImm = [&](X64Shift op) {
+        LoadGuestReg(RAX, ir.src1);
+        if ((ir.imm & 31) != 0) emit_.SHIFT32_RI(op, RAX, uint8_t(ir.imm & 31));
+        StoreGuestReg(ir.dst, RAX);
+    };
+    auto shiftVar = [&](X64Shift op) {
+        LoadGuestReg(RAX, ir.src1);
+        LoadGuestReg(RCX, ir.src2);
+        emit_.SHIFT32_RCL(op, RAX);
+        StoreGuestReg(ir.dst, RAX);
+    };
+    auto multiply = [&](bool isSigned) {
+        LoadGuestReg(RAX, ir.src1);
+        LoadGuestReg(RCX, ir.src2);
+        if (isSigned) emit_.IMUL32(RCX); else emit_.MUL32(RCX);
+        emit_.MOV32_MR(RBX, loOffset_, RAX);
+        emit_.MOV32_MR(RBX, hiOffset_, RDX);
+    };
+
+    // Запись в $zero не имеет эффекта (загрузки всё равно обращаются к памяти)
+    if (ir.dst == 0 && ir.op >= IROp::SetConst && ir.op <= IROp::MfLo) {
+        return;
+    }
+
+    switch (ir.op) {
+        case IROp::Nop: return;
+        case IROp::SetConst:
+            emit_.MOV32_MI(RBX, GuestRegOffset(ir.dst), ir.imm);
+            return;
+        case IROp::Mov:
+            LoadGuestReg(RAX, ir.src1);
+            StoreGuestReg(ir.dst, RAX);
+            return;
+
+        case IROp::Add: aluRR(ALU_ADD); return;
+        case IROp::Sub: aluRR(ALU_SUB); return;
+        case IROp::And: aluRR(ALU_AND); return;
+        case IROp::Or:  aluRR(ALU_OR); return;
+        case IROp::Xor: aluRR(ALU_XOR); return;
+        case IROp::Nor:
+            LoadGuestReg(RAX, ir.src1);
+            LoadGuestReg(RCX, ir.src2);
+            emit_.ALU32_RR(ALU_OR, RAX, RCX);
+            emit_.NOT32(RAX);
+            StoreGuestReg(ir.dst, RAX);
+            return;
+        case IROp::Slt:  setRR(CC_L); return;
+        case IROp::Sltu: setRR(CC_B); return;
+
+        case IROp::AddI:  aluImm(ALU_ADD); return;
+        case IROp::AndI:  aluImm(ALU_AND); return;
+        case IROp::OrI:   aluImm(ALU_OR); return;
+        case IROp::XorI:  aluImm(ALU_XOR); return;
+        case IROp::SltI:  setImm(CC_L); return;
+        case IROp::SltuI: setImm(CC_B); return;
+
+        case IROp::ShlI: shiftImm(SHIFT_SHL); return;
+        case IROp::ShrI: shiftImm(SHIFT_SHR); return;
+        case IROp::SarI: shiftImm(SHIFT_SAR); return;
+        case IROp::RorI: shiftImm(SHIFT_ROR); return;
+        case IROp::Shl:  shiftVar(SHIFT_SHL); return;
+        case IROp::Shr:  shiftVar(SHIFT_SHR); return;
+        case IROp::Sar:  shiftVar(SHIFT_SAR); return;
+        case IROp::Ror:  shiftVar(SHIFT_ROR); return;
+
+        case IROp::MfHi:
+            emit_.MOV32_RM(RAX, RBX, hiOffset_);
+            StoreGuestReg(ir.dst, RAX);
+            return;
+        case IROp::MfLo:
+            emit_.MOV32_RM(RAX, RBX, loOffset_);
+            StoreGuestReg(ir.dst, RAX);
+            return;
+        case IROp::MtHi:
+            LoadGuestReg(RAX, ir.src1);
+            emit_.MOV32_MR(RBX, hiOffset_, RAX);
+            return;
+        case IROp::MtLo:
+            LoadGuestReg(RAX, ir.src1);
+            emit_.MOV32_MR(RBX, loOffset_, RAX);
+            return;
+        case IROp::Mult:  multiply(true); return;
+        case IROp::Multu: multiply(false); return;
+
+        case IROp::Load8S:  CompileLoad(ir, reinterpret_cast<const void*>(&JitRead8S)); return;
+        case IROp::Load8U:  CompileLoad(ir, reinterpret_cast<const void*>(&JitRead8U)); return;
+        case IROp::Load16S: CompileLoad(ir, reinterpret_cast<const void*>(&JitRead16S)); return;
+        case IROp::Load16U: CompileLoad(ir, reinterpret_cast<const void*>(&JitRead16U)); return;
+        case IROp::Load32:  CompileLoad(ir, reinterpret_cast<const void*>(&JitRead32)); return;
+        case IROp::Store8:  CompileStore(ir, reinterpret_cast<const void*>(&JitWrite8)); return;
+        case IROp::Store16: CompileStore(ir, reinterpret_cast<const void*>(&JitWrite16)); return;
+        case IROp::Store32: CompileStore(ir, reinterpret_cast<const void*>(&JitWrite32)); return;
+
+        default: break;
+    }
+
+    if (inDelaySlot && IsIRBranch(ir.op)) {
+        core::LogWarning("Branch in delay slot at PC=" + std::to_string(ir.pc));
+    }
+    CompileFallback(ir, inst);
+}
+
+}  // namespace jit
+}  // namespace ppsspp
+
+#endif  // PPSSPP_JIT_X64
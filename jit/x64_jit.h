@@ -0,0 +1,159 @@
+// jit/x64_jit.h
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PPSSPP_JIT_X64 1
+#endif
+
+#ifdef PPSSPP_JIT_X64
+
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../core/cpu_state.h"
+#include "../core/interpreter.h"
+#include "../core/ir.h"
+#include "code_cache.h"
+#include "x64_emitter.h"
+
+namespace ppsspp {
+namespace core {
+class Memory;
+class BlockCache;
+struct Block;
+}
+
+namespace jit {
+
+class Jit;
+
+// Состояние, доступное сгенерированному коду через R12.
+// exec идёт первым, чтобы R12 можно было передавать обработчикам интерпретатора.
+struct JitContext {
+    core::ExecContext exec;
+    int64_t downcount = 0;
+    int64_t idleSkips = 0;
+    uint8_t exceptionPending = 0;
+    Jit* owner = nullptr;
+};
+
+// Рекомпилятор базовых блоков MIPS в код x86-64.
+// Регистры хоста: RBX - массив GPR гостя, R12 - JitContext, R13 - условие перехода.
+// Выходы с известным адресом связываются напрямую с блоком-получателем,
+// пока бюджет циклов не исчерпан, управление не возвращается в диспетчер.
+class Jit {
+public:
+    static constexpr size_t CODE_CACHE_SIZE = 32 * 1024 * 1024;
+    static constexpr size_t MAX_INST_BYTES = 96;
+
+    Jit(core::CPUState& cpu, core::Memory& memory, core::BlockCache& blocks);
+    ~Jit();
+
+    // Запрещаем копирование
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    bool IsValid() const { return codeCache_.IsValid(); }
+
+    // По умолчанию syscall::HandleSyscall, как у интерпретатора
+    void SetSyscallHook(core::SyscallHook hook) { ctx_.exec.syscall = hook; }
+
+    // Остаток бюджета Run(), уменьшается на выходе из каждого блока
+    const int64_t* GetDowncountPtr() const { return &ctx_.downcount; }
+
+    // Исполняет блоки, пока не исчерпан бюджет циклов или PC не стал INVALID_PC.
+    // Возвращает количество исполненных инструкций.
+    int64_t Run(int64_t cycles);
+
+    // Сброс скомпилированного кода
+    void InvalidateBlock(uint32_t startPC);
+    void ClearCache();
+
+    size_t GetCompiledBlockCount() const { return compiled_.size(); }
+    uint64_t GetLinkCount() const { return linkCount_; }
+    uint64_t GetIdleSkipCount() const { return uint64_t(ctx_.idleSkips); }
+
+    // Вызывается из вспомогательных функций при исключении в гостевом коде
+    void SetPendingException(std::exception_ptr e);
+
+private:
+    using EnterFn = uint32_t (*)(JitContext* ctx, const uint8_t* code);
+
+    void GenerateStubs();
+    const uint8_t* GetOrCompile(uint32_t pc);
+    const uint8_t* Compile(uint32_t pc);
+
+    // Генерация отдельных инструкций IR; inst - та же инструкция в форме интерпретатора
+    void CompileInstruction(const core::IRInst& ir, const core::Inst& inst, bool inDelaySlot);
+    // Переход ir[index] вместе с delay slot ir[index + 1]
+    void CompileBranch(const core::Block& block, const core::IRInst* ir, const core::Inst* insts, uint32_t index);
+    // Переход, условие которого вычисляет обработчик интерпретатора (bc1x)
+    void CompileInterpBranch(const core::Block& block, const core::IRInst* ir, const core::Inst* insts,
+                             uint32_t index);
+    void CompileLoad(const core::IRInst& ir, const void* helper);
+    void CompileStore(const core::IRInst& ir, const void* helper);
+    void CompileSyscall(const core::IRInst& ir, uint32_t executed);
+    // Вызов HLE и выход по PC, который HLE оставил в CPUState; PC возврата
+    // (ir.pc + 4 или цель перехода для delay slot) уже записан туда
+    void CompileSyscallExit(const core::IRInst& ir, uint32_t executed);
+    void CompileFallback(const core::IRInst& ir, const core::Inst& inst);
+
+    void LoadGuestReg(X64Reg reg, uint8_t guest);
+    void StoreGuestReg(uint8_t guest, X64Reg reg);
+    void CheckException();
+    // Выход с известным адресом: связывается с блоком target, если он скомпилирован
+    void WriteExit(uint32_t target, uint32_t executed);
+    void WriteDynamicExit(X64Reg target, uint32_t executed);
+    // Повтор цикла ожидания: остаток бюджета списывается целиком
+    void WriteIdleExit(uint32_t target);
+
+    int32_t GuestRegOffset(uint8_t guest) const { return int32_t(guest) * 4; }
+
+    core::CPUState& cpu_;
+    core::Memory& memory_;
+    core::BlockCache& blocks_;
+
+    CodeCache codeCache_;
+    X64Emitter emit_;
+    JitContext ctx_;
+
+    EnterFn enter_ = nullptr;
+    const uint8_t* exitStub_ = nullptr;
+    const uint8_t* exceptionStub_ = nullptr;
+    size_t codeStart_ = 0;
+
+    // Смещения LO/HI/PC относительно массива GPR (через указатели CPUState для JIT)
+    int32_t loOffset_ = 0;
+    int32_t hiOffset_ = 0;
+    int32_t pcOffset_ = 0;
+
+    // Связываемый выход: место патча rel32 и PC гостя, куда он ведёт
+    using ExitLink = std::pair<uint32_t, uint8_t*>;
+
+    struct JitBlock {
+        const uint8_t* entry = nullptr;
+        std::vector<ExitLink> exits;
+    };
+
+    void LinkIncoming(uint32_t target, const uint8_t* entry);
+
+    // PC гостевого блока -> точка входа и исходящие выходы
+    std::unordered_map<uint32_t, JitBlock> compiled_;
+    // PC гостя -> выходы живых блоков, ведущие на него (связанные или нет)
+    std::unordered_map<uint32_t, std::vector<uint8_t*>> incoming_;
+    // Выходы компилируемого блока
+    std::vector<ExitLink> pendingExits_;
+    uint64_t linkCount_ = 0;
+
+    std::exception_ptr pendingException_;
+};
+
+}  // namespace jit
+}  // namespace ppsspp
+
+#endif  // PPSSPP_JIT_X64
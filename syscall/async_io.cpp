@@ -0,0 +1,63 @@
+// syscall/async_io.cpp
+
+#include "async_io.h"
+
+#include <utility>
+
+namespace ppsspp {
+namespace syscall {
+
+AsyncIoPool::AsyncIoPool(size_t numWorkers) {
+    if (numWorkers == 0) numWorkers = 1;
+    workers_.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        workers_.emplace_back(&AsyncIoPool::WorkerLoop, this);
+    }
+}
+
+AsyncIoPool::~AsyncIoPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+}
+
+void AsyncIoPool::Submit(uint32_t id, Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.erase(id);
+        jobs_.emplace_back(id, std::move(job));
+    }
+    cv_.notify_one();
+}
+
+bool AsyncIoPool::Poll(uint32_t id, int64_t& outResult) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_.find(id);
+    if (it == results_.end()) return false;
+    outResult = it->second;
+    results_.erase(it);
+    return true;
+}
+
+void AsyncIoPool::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+        if (stop_) return;
+
+        auto [id, job] = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        // Сам ввод-вывод - без блокировки: остальные потоки берут свои задания
+        lock.unlock();
+        const int64_t result = job();
+        lock.lock();
+        results_[id] = result;
+    }
+}
+
+}  // namespace syscall
+}  // namespace ppsspp
@@ -0,0 +1,68 @@
+// syscall/async_io.h
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ppsspp {
+namespace syscall {
+
+// Коды ошибок IoFileMgrForUser
+constexpr uint32_t SCE_KERNEL_ERROR_ASYNC_BUSY = 0x80020329;
+constexpr uint32_t SCE_KERNEL_ERROR_NOASYNC = 0x8002032A;
+constexpr uint32_t SCE_KERNEL_ERROR_BADF = 0x80020323;
+// 0x80010000 | errno
+constexpr uint32_t SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND = 0x80010002;
+constexpr uint32_t SCE_KERNEL_ERROR_ERRNO_IO_ERROR = 0x80010005;
+constexpr uint32_t SCE_KERNEL_ERROR_ERRNO_ACCESS_DENIED = 0x8001000D;
+constexpr uint32_t SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS = 0x80010011;
+constexpr uint32_t SCE_KERNEL_ERROR_ERRNO_INVALID_ARGUMENT = 0x80010016;
+constexpr uint32_t SCE_KERNEL_ERROR_ERRNO_READ_ONLY = 0x8001001E;
+
+// Пул фоновых потоков для файловых операций гостя.
+//
+// Задания исполняются в порядке постановки, результат забирается Poll() по
+// ключу задания (номер fd). Пул ничего не сообщает потоку эмуляции сам:
+// тот опрашивает завершение из события CoreTiming, поэтому всё состояние
+// эмуляции меняется только в его потоке.
+class AsyncIoPool {
+public:
+    static constexpr size_t DEFAULT_WORKERS = 2;
+
+    // Задание возвращает число байт или отрицательный код ошибки
+    using Job = std::function<int64_t()>;
+
+    explicit AsyncIoPool(size_t numWorkers = DEFAULT_WORKERS);
+    ~AsyncIoPool();
+
+    // Запрещаем копирование
+    AsyncIoPool(const AsyncIoPool&) = delete;
+    AsyncIoPool& operator=(const AsyncIoPool&) = delete;
+
+    // У одного id одновременно не больше одного задания
+    void Submit(uint32_t id, Job job);
+
+    // true - задание id завершено; результат забирается
+    bool Poll(uint32_t id, int64_t& outResult);
+
+private:
+    void WorkerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::pair<uint32_t, Job>> jobs_;
+    std::unordered_map<uint32_t, int64_t> results_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace syscall
+}  // namespace ppsspp
@@ -0,0 +1,146 @@
+// syscall/nid_table.h
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace ppsspp {
+namespace syscall {
+
+struct NidEntry {
+    uint32_t nid;       // первые 4 байта SHA-1 от имени функции
+    const char* name;
+};
+
+// Реализованные HLE-функции. Позиция в таблице - код syscall, которым
+// загрузчик связывает заглушку импорта; по тому же индексу
+// SyscallHandler::Invoke берёт обработчик. Новые функции добавляются в конец.
+inline constexpr NidEntry NID_TABLE[] = {
+    { 0x05572A5F, "sceKernelExitGame" },
+    { 0x984C27E7, "sceDisplayWaitVblankStart" },
+    { 0x0E20F177, "sceDisplaySetMode" },
+    { 0x1F803938, "sceCtrlReadBufferPositive" },
+    { 0x3A622550, "sceCtrlPeekBufferPositive" },
+    { 0x3F7AD767, "sceRtcGetCurrentTick" },
+    { 0x8C1009B2, "sceAudioOutput" },
+    { 0x109F50BC, "sceIoOpen" },
+    { 0x6A638D83, "sceIoRead" },
+    { 0x42EC03AC, "sceIoWrite" },
+    { 0x810C4BC3, "sceIoClose" },
+    { 0x27CC57F0, "sceKernelLibcTime" },
+    { 0x446D8DE6, "sceKernelCreateThread" },
+    { 0xF475845D, "sceKernelStartThread" },
+    { 0xAA73C935, "sceKernelExitThread" },
+    { 0x809CE29B, "sceKernelExitDeleteThread" },
+    { 0x9FA03CD3, "sceKernelDeleteThread" },
+    { 0x9ACE131E, "sceKernelSleepThread" },
+    { 0x82826F70, "sceKernelSleepThreadCB" },
+    { 0xD59EAD2F, "sceKernelWakeupThread" },
+    { 0xCEADEB47, "sceKernelDelayThread" },
+    { 0x68DA9E36, "sceKernelDelayThreadCB" },
+    { 0x293B45B8, "sceKernelGetThreadId" },
+    { 0xA0B5A7C2, "sceIoReadAsync" },
+    { 0x0FACAB19, "sceIoWriteAsync" },
+    { 0xE23EEC33, "sceIoWaitAsync" },
+    { 0x35DBD746, "sceIoWaitAsyncCB" },
+    { 0x3251EA56, "sceIoPollAsync" },
+    { 0x136CAF51, "sceAudioOutputBlocking" },
+    { 0x5EC81C55, "sceAudioChReserve" },
+    { 0x6FC46853, "sceAudioChRelease" },
+};
+
+inline constexpr uint32_t NUM_SYSCALLS = static_cast<uint32_t>(std::size(NID_TABLE));
+
+namespace detail {
+
+// Идеальный хэш, строится при компиляции (hash and displace):
+// NID раскладываются по корзинам младшими битами, для каждой корзины
+// подбирается затравка, разводящая её ключи по свободным слотам.
+// Поиск - два умножения и три чтения без циклов и сравнений строк.
+constexpr uint32_t Mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+constexpr uint32_t NextPow2(uint32_t x) {
+    uint32_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+inline constexpr uint32_t NUM_BUCKETS = NextPow2(NUM_SYSCALLS / 2 + 1);
+inline constexpr uint32_t NUM_SLOTS = NextPow2(NUM_SYSCALLS * 2);
+inline constexpr uint16_t EMPTY_SLOT = 0xFFFF;
+
+struct NidHash {
+    std::array<uint32_t, NUM_BUCKETS> seeds{};
+    std::array<uint16_t, NUM_SLOTS> slots{};
+};
+
+constexpr uint32_t Slot(uint32_t nid, uint32_t seed) {
+    return Mix(nid ^ (seed * 0x9E3779B9u)) & (NUM_SLOTS - 1);
+}
+
+constexpr NidHash BuildNidHash() {
+    NidHash hash;
+    for (uint16_t& slot : hash.slots) slot = EMPTY_SLOT;
+
+    // Сначала самые заполненные корзины - для них труднее найти затравку
+    std::array<uint32_t, NUM_BUCKETS> order{};
+    std::array<uint32_t, NUM_BUCKETS> counts{};
+    for (const NidEntry& entry : NID_TABLE) ++counts[entry.nid & (NUM_BUCKETS - 1)];
+    for (uint32_t b = 0; b < NUM_BUCKETS; ++b) order[b] = b;
+    for (uint32_t i = 1; i < NUM_BUCKETS; ++i) {
+        for (uint32_t j = i; j > 0 && counts[order[j]] > counts[order[j - 1]]; --j) {
+            const uint32_t t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    }
+
+    for (uint32_t bucket : order) {
+        for (uint32_t seed = 0;; ++seed) {
+            std::array<uint16_t, NUM_SLOTS> trial = hash.slots;
+            bool fits = true;
+            for (uint32_t i = 0; i < NUM_SYSCALLS && fits; ++i) {
+                if ((NID_TABLE[i].nid & (NUM_BUCKETS - 1)) != bucket) continue;
+                uint16_t& slot = trial[Slot(NID_TABLE[i].nid, seed)];
+                fits = slot == EMPTY_SLOT;
+                slot = static_cast<uint16_t>(i);
+            }
+            if (fits) {
+                hash.slots = trial;
+                hash.seeds[bucket] = seed;
+                break;
+            }
+        }
+    }
+    return hash;
+}
+
+inline constexpr NidHash NID_HASH = BuildNidHash();
+
+}  // namespace detail
+
+// Код syscall для NID; false - функция не реализована
+constexpr bool LookupNid(uint32_t nid, uint32_t& outCode) {
+    const uint32_t seed = detail::NID_HASH.seeds[nid & (detail::NUM_BUCKETS - 1)];
+    const uint16_t index = detail::NID_HASH.slots[detail::Slot(nid, seed)];
+    if (index == detail::EMPTY_SLOT || NID_TABLE[index].nid != nid) return false;
+    outCode = index;
+    return true;
+}
+
+// Имя функции по коду syscall; nullptr - неизвестный код
+constexpr const char* GetSyscallName(uint32_t code) {
+    return code < NUM_SYSCALLS ? NID_TABLE[code].name : nullptr;
+}
+
+}  // namespace syscall
+}  // namespace ppsspp
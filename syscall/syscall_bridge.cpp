@@ -1,10 +1,43 @@
 // syscall/syscall_bridge.cpp
+#include "syscall_bridge.h"
 #include "syscall_handler.h"
+#include "../core/cpu_state.h"
+#include "../core/syscall.h"
+#include "../core/system.h"
+#include "../core/audio_system.h"
+#include "../video/video_engine.h"
+#include <memory>
+
+namespace ppsspp {
+namespace syscall {
 
 // Глобальный указатель, выставляется в main()
-ppsspp::syscall::SyscallHandler* g_syscallHandler = nullptr;
+SyscallHandler* g_syscallHandler = nullptr;
+
+// Обработчик, созданный здесь, если main() не выставил свой
+static std::unique_ptr<SyscallHandler> g_ownedHandler;
+
+SyscallHandler* GetSyscallHandler(core::CPUState& cpu) {
+    if (g_syscallHandler) return g_syscallHandler;
+
+    // Время, память и контроллер - общие с главным циклом системы
+    core::System* system = core::System::GetCurrent();
+    if (!system || &system->GetCPU() != &cpu) return nullptr;
 
-// Экспортируемая точка входа из JIT
-extern "C" uint32_t HandleSyscall(uint32_t syscallID) {
-    return g_syscallHandler->Invoke(syscallID);
+    // Аудио и видео с параметрами по умолчанию
+    static auto& audio = core::AudioSystem::GetInstance();
+    static video::VideoEngine video(480, 272); // Разрешение PSP экрана
+
+    g_ownedHandler = std::make_unique<SyscallHandler>(cpu, system->GetMemory(), system->GetTiming(),
+                                                      system->GetController(), audio, video);
+    g_syscallHandler = g_ownedHandler.get();
+    return g_syscallHandler;
+}
+
+void ResetSyscallHandler() {
+    if (g_syscallHandler == g_ownedHandler.get()) g_syscallHandler = nullptr;
+    g_ownedHandler.reset();
 }
+
+}  // namespace syscall
+}  // namespace ppsspp
@@ -3,19 +3,21 @@
 #include <cstdint>
 
 namespace ppsspp {
+namespace core {
+class CPUState;
+}
+
 namespace syscall {
 
-class SyscallHandler {
-public:
-    virtual ~SyscallHandler() = default;
-    virtual uint32_t HandleSyscall(uint32_t syscallID) = 0;
-};
+class SyscallHandler;
 
+// Активный обработчик HLE, общий для интерпретатора и JIT.
+// Выставляется в main(); иначе его создаёт GetSyscallHandler()
 extern SyscallHandler* g_syscallHandler;
 
+// Активный обработчик; при первом обращении создаётся для core::System,
+// которой принадлежит cpu. nullptr - cpu не принадлежит текущей системе
+SyscallHandler* GetSyscallHandler(core::CPUState& cpu);
+
 }  // namespace syscall
 }  // namespace ppsspp
-
-extern "C" {
-    uint32_t HandleSyscall(uint32_t syscallID);
-}
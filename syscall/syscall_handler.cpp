@@ -1,214 +1,622 @@
 // syscall/syscall_handler.cpp
 
 #include "syscall_handler.h"
-#include <thread>
+#include "nid_table.h"
+#include "../core/mmio.h"
+#include <cerrno>
 #include <cstring>
+#include <thread>
 #include <cstdlib>
 #include <cstdio>
 #include <filesystem>
-#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <iterator>
+#include <type_traits>
 
 namespace ppsspp {
 namespace syscall {
 
-using namespace std::chrono;
-
-SyscallHandler::SyscallHandler(core::CPUState& cpu, core::Memory& memory,
-                               core::AudioSystem& audio, video::VideoEngine& video)
-    : cpu_(cpu), memory_(memory), audio_(audio), video_(video), startTime_(steady_clock::now()) {
+SyscallHandler::SyscallHandler(core::CPUState& cpu, core::Memory& memory, core::CoreTiming& timing,
+                               const core::ControllerMmio& controller, core::AudioSystem& audio,
+                               video::VideoEngine& video)
+    : cpu_(cpu), memory_(memory), audio_(audio), video_(video), timing_(timing),
+      controller_(controller), threads_(cpu, memory, timing) {
     std::filesystem::create_directories("saves");
+    rtcBaseTick_ = RTC_UNIX_EPOCH_TICK + static_cast<uint64_t>(std::time(nullptr)) * 1000000;
+    vblankEvent_ = timing_.RegisterEvent("Vblank", &SyscallHandler::OnVblank, this);
+    timing_.ScheduleEvent(VBLANK_CYCLES, vblankEvent_);
+    ioEvent_ = timing_.RegisterEvent("IoComplete", &SyscallHandler::OnIoEvent, this);
+}
+
+void SyscallHandler::OnVblank(void* userdata, uint64_t /*param*/, int64_t cyclesLate) {
+    auto* self = static_cast<SyscallHandler*>(userdata);
+    // Период отсчитывается от срока, а не от фактического вызова: без дрейфа
+    self->timing_.ScheduleEvent(VBLANK_CYCLES - cyclesLate, self->vblankEvent_);
+    self->threads_.WakeWaiting(ThreadManager::WaitType::Vblank, 0);
+    self->threads_.RescheduleIfNeeded();
+    self->timing_.SyncHost();
+}
+
+constexpr SyscallHandler::SyscallEntry SyscallHandler::DISPATCH[] = {
+    { 0x05572A5F, &Call<&SyscallHandler::Sys_ExitGame> },
+    { 0x984C27E7, &Call<&SyscallHandler::Sys_DisplayWaitVblankStart> },
+    { 0x0E20F177, &Call<&SyscallHandler::Sys_DisplaySetMode> },
+    { 0x1F803938, &Call<&SyscallHandler::Sys_CtrlReadBufferPositive> },
+    { 0x3A622550, &Call<&SyscallHandler::Sys_CtrlPeekBufferPositive> },
+    { 0x3F7AD767, &Call<&SyscallHandler::Sys_RtcGetCurrentTick> },
+    { 0x8C1009B2, &Call<&SyscallHandler::Sys_AudioOutput> },
+    { 0x109F50BC, &Call<&SyscallHandler::Sys_IoOpen> },
+    { 0x6A638D83, &Call<&SyscallHandler::Sys_IoRead> },
+    { 0x42EC03AC, &Call<&SyscallHandler::Sys_IoWrite> },
+    { 0x810C4BC3, &Call<&SyscallHandler::Sys_IoClose> },
+    { 0x27CC57F0, &Call<&SyscallHandler::Sys_LibcTime> },
+    { 0x446D8DE6, &Call<&SyscallHandler::Sys_CreateThread> },
+    { 0xF475845D, &Call<&SyscallHandler::Sys_StartThread> },
+    { 0xAA73C935, &Call<&SyscallHandler::Sys_ExitThread> },
+    { 0x809CE29B, &Call<&SyscallHandler::Sys_ExitDeleteThread> },
+    { 0x9FA03CD3, &Call<&SyscallHandler::Sys_DeleteThread> },
+    { 0x9ACE131E, &Call<&SyscallHandler::Sys_SleepThread> },
+    { 0x82826F70, &Call<&SyscallHandler::Sys_SleepThread> },
+    { 0xD59EAD2F, &Call<&SyscallHandler::Sys_WakeupThread> },
+    { 0xCEADEB47, &Call<&SyscallHandler::Sys_DelayThread> },
+    { 0x68DA9E36, &Call<&SyscallHandler::Sys_DelayThread> },
+    { 0x293B45B8, &Call<&SyscallHandler::Sys_GetThreadId> },
+    { 0xA0B5A7C2, &Call<&SyscallHandler::Sys_IoReadAsync> },
+    { 0x0FACAB19, &Call<&SyscallHandler::Sys_IoWriteAsync> },
+    { 0xE23EEC33, &Call<&SyscallHandler::Sys_IoWaitAsync> },
+    { 0x35DBD746, &Call<&SyscallHandler::Sys_IoWaitAsync> },
+    { 0x3251EA56, &Call<&SyscallHandler::Sys_IoPollAsync> },
+    { 0x136CAF51, &Call<&SyscallHandler::Sys_AudioOutputBlocking> },
+    { 0x5EC81C55, &Call<&SyscallHandler::Sys_AudioChReserve> },
+    { 0x6FC46853, &Call<&SyscallHandler::Sys_AudioChRelease> },
+};
+
+constexpr bool SyscallHandler::DispatchMatchesNidTable() {
+    if (std::size(DISPATCH) != NUM_SYSCALLS) return false;
+    for (uint32_t i = 0; i < NUM_SYSCALLS; ++i) {
+        if (DISPATCH[i].nid != NID_TABLE[i].nid) return false;
+    }
+    return true;
 }
 
 uint32_t SyscallHandler::Invoke(uint32_t syscallID) {
-    switch (syscallID) {
-        case 0x20: Sys_DisplayWaitVblankStart(); break;
-        case 0x21: Sys_DisplaySetMode(); break;
-        case 0x30: Sys_CtrlReadBufferPositive(); break;
-        case 0x31: Sys_CtrlPeekBufferPositive(); break;
-        case 0x10: Sys_ExitGame(); break;
-        case 0x40: Sys_RtcGetTick(); break;
-        case 0x50: Sys_AudioOutput(); break;
-        case 0x70: Sys_UtilitySavedata(); break;
-        case 0xA0: Sys_IoOpen(); break;
-        case 0xA1: Sys_IoRead(); break;
-        case 0xA2: Sys_IoWrite(); break;
-        case 0xA3: Sys_IoClose(); break;
-        default:
-            std::fprintf(stderr, "[SyscallHandler] Unknown syscall 0x%X\n", syscallID);
-            writeResult(uint32_t(-1));
-            break;
+    // Код syscall в заглушке импорта - индекс в NID_TABLE, поэтому обе таблицы
+    // обязаны идти в одном порядке
+    static_assert(DispatchMatchesNidTable(), "DISPATCH must list NID_TABLE entries in the same order");
+
+    if (syscallID < NUM_SYSCALLS) [[likely]] {
+        DISPATCH[syscallID].func(*this);
+        // Переключение потока - только после записи результата в v0 вызвавшего
+        threads_.RescheduleIfNeeded();
+    } else {
+        std::fprintf(stderr, "[SyscallHandler] Unknown syscall 0x%X\n", syscallID);
+        writeResult(uint32_t(-1));
     }
     return cpu_.GetPC();
 }
 
-void SyscallHandler::writeResult(uint32_t value) {
-    cpu_.SetGPR(2, value);
+template <auto Method, size_t... I>
+void SyscallHandler::CallWithArgs(SyscallHandler& handler, std::index_sequence<I...>) {
+    // a0..a3 и t0..t3 - подряд идущие регистры 4..11
+    if constexpr (std::is_void_v<decltype((handler.*Method)(handler.cpu_.GetGPR(4 + I)...))>) {
+        (handler.*Method)(handler.cpu_.GetGPR(4 + I)...);
+    } else {
+        handler.writeResult((handler.*Method)(handler.cpu_.GetGPR(4 + I)...));
+    }
 }
 
-void SyscallHandler::Sys_DisplayWaitVblankStart() {
-    std::this_thread::sleep_for(std::chrono::milliseconds(16));
-    writeResult(0);
+namespace {
+
+template <typename T>
+struct MethodArity;
+
+template <typename C, typename R, typename... Args>
+struct MethodArity<R (C::*)(Args...)> {
+    static_assert((std::is_same_v<Args, uint32_t> && ...), "syscall arguments must be uint32_t");
+    static constexpr size_t value = sizeof...(Args);
+};
+
+}  // namespace
+
+template <auto Method>
+void SyscallHandler::Call(SyscallHandler& handler) {
+    constexpr size_t arity = MethodArity<decltype(Method)>::value;
+    static_assert(arity <= 8, "syscall takes at most 8 register arguments");
+    CallWithArgs<Method>(handler, std::make_index_sequence<arity>());
 }
 
-void SyscallHandler::Sys_DisplaySetMode() {
-    uint32_t w = cpu_.GetGPR(5), h = cpu_.GetGPR(6);
-    video_ = video::VideoEngine(w, h);
-    writeResult(0);
+void SyscallHandler::writeResult(uint32_t value) {
+    cpu_.SetGPR(core::reg::V0, value);
 }
 
-void SyscallHandler::Sys_CtrlReadBufferPositive() {
-    uint32_t addr = cpu_.GetGPR(4);
-    uint32_t val = memory_.Read32(0x88000000);
-    uint8_t lx = memory_.Read8(0x88000004);
-    uint8_t ly = memory_.Read8(0x88000005);
+uint32_t SyscallHandler::Sys_DisplayWaitVblankStart() {
+    // Поток ждёт события Vblank, остальные тем временем исполняются
+    threads_.WaitCurrent(ThreadManager::WaitType::Vblank, 0);
+    return 0;
+}
 
-    memory_.Write32(addr, val);
-    memory_.Write8(addr + 4, lx);
-    memory_.Write8(addr + 5, ly);
-    for (int i = 0; i < 6; ++i)
-        memory_.Write8(addr + 6 + i, 0);
+uint32_t SyscallHandler::Sys_DisplaySetMode(uint32_t /*mode*/, uint32_t width, uint32_t height) {
+    video_ = video::VideoEngine(width, height);
+    return 0;
+}
 
-    writeResult(1);
+uint32_t SyscallHandler::Sys_CtrlReadBufferPositive(uint32_t dataAddr, uint32_t count) {
+    using core::ControllerMmio;
+    const ControllerMmio::State state = controller_.GetState();
+
+    // SceCtrlData; выборки не копятся, все count записей - текущее состояние
+    const uint32_t timestamp = static_cast<uint32_t>(timing_.GetMicroseconds());
+    uint8_t data[ControllerMmio::SIZE] = {};
+    std::memcpy(data + ControllerMmio::TIMESTAMP, &timestamp, sizeof(timestamp));
+    std::memcpy(data + ControllerMmio::BUTTONS, &state.buttons, sizeof(state.buttons));
+    data[ControllerMmio::ANALOG_X] = state.lx;
+    data[ControllerMmio::ANALOG_Y] = state.ly;
+
+    count = std::min(count, CTRL_BUFFER_MAX);
+    for (uint32_t n = 0; n < count; ++n) {
+        memory_.WriteBytes(dataAddr + n * ControllerMmio::SIZE, data, sizeof(data));
+    }
+    return count;
 }
 
-void SyscallHandler::Sys_CtrlPeekBufferPositive() {
-    Sys_CtrlReadBufferPositive();
+uint32_t SyscallHandler::Sys_CtrlPeekBufferPositive(uint32_t dataAddr, uint32_t count) {
+    return Sys_CtrlReadBufferPositive(dataAddr, count);
 }
 
 void SyscallHandler::Sys_ExitGame() {
     std::exit(0);
 }
 
-void SyscallHandler::Sys_RtcGetTick() {
-    auto elapsed = duration_cast<microseconds>(steady_clock::now() - startTime_);
-    writeResult(static_cast<uint32_t>(elapsed.count()));
+uint32_t SyscallHandler::Sys_RtcGetCurrentTick(uint32_t tickPtr) {
+    // Тик RTC - микросекунда с 0001-01-01; идёт по эмулируемому времени
+    const uint64_t tick = rtcBaseTick_ + timing_.GetMicroseconds();
+    memory_.Write32(tickPtr, static_cast<uint32_t>(tick));
+    memory_.Write32(tickPtr + 4, static_cast<uint32_t>(tick >> 32));
+    return 0;
 }
 
-void SyscallHandler::Sys_AudioOutput() {
-    uint32_t pcmAddr = cpu_.GetGPR(4);
-    uint32_t samples = cpu_.GetGPR(5);
-    uint32_t total = samples * audio_.Channels();
+uint32_t SyscallHandler::Sys_AudioChReserve(uint32_t channel, uint32_t sampleCount, uint32_t format) {
+    if (sampleCount < AUDIO_SAMPLE_MIN || sampleCount > AUDIO_SAMPLE_MAX || (sampleCount % AUDIO_SAMPLE_MIN)) {
+        return SCE_ERROR_AUDIO_OUTPUT_SAMPLE_DATA_SIZE_NOT_ALIGNED;
+    }
+    if (format != AUDIO_FORMAT_STEREO && format != AUDIO_FORMAT_MONO) {
+        return SCE_ERROR_AUDIO_INVALID_FORMAT;
+    }
+
+    if (channel == AUDIO_NEXT_CHANNEL) {
+        // Как на PSP: свободный канал с наибольшим номером
+        channel = AUDIO_CHANNEL_COUNT;
+        while (channel > 0 && audioChannels_[channel - 1].reserved) --channel;
+        if (channel == 0) {
+            return SCE_ERROR_AUDIO_NO_CHANNELS_AVAILABLE;
+        }
+        --channel;
+    } else if (channel >= AUDIO_CHANNEL_COUNT) {
+        return SCE_ERROR_AUDIO_INVALID_CHANNEL;
+    } else if (audioChannels_[channel].reserved) {
+        return SCE_ERROR_AUDIO_CHANNEL_ALREADY_RESERVED;
+    }
+
+    audioChannels_[channel] = { true, format == AUDIO_FORMAT_MONO, sampleCount, 0 };
+    return channel;
+}
+
+uint32_t SyscallHandler::Sys_AudioChRelease(uint32_t channel) {
+    if (channel >= AUDIO_CHANNEL_COUNT) {
+        return SCE_ERROR_AUDIO_INVALID_CHANNEL;
+    }
+    if (!audioChannels_[channel].reserved) {
+        return SCE_ERROR_AUDIO_CHANNEL_NOT_RESERVED;
+    }
+    audioChannels_[channel] = {};
+    return 0;
+}
 
-    std::vector<int16_t> buf(total);
-    for (uint32_t i = 0; i < total; ++i)
-        buf[i] = static_cast<int16_t>(memory_.Read16(pcmAddr + i * 2));
+uint32_t SyscallHandler::Sys_AudioOutput(uint32_t channel, uint32_t volume, uint32_t bufPtr) {
+    return OutputAudio(channel, volume, bufPtr, false);
+}
 
-    audio_.SubmitAudio(buf.data(), samples);
-    writeResult(0);
+uint32_t SyscallHandler::Sys_AudioOutputBlocking(uint32_t channel, uint32_t volume, uint32_t bufPtr) {
+    return OutputAudio(channel, volume, bufPtr, true);
 }
 
-void SyscallHandler::Sys_UtilitySavedata() {
-    uint32_t bufAddr = cpu_.GetGPR(4);
-    uint32_t size = cpu_.GetGPR(5);
-    uint32_t titlePtr = cpu_.GetGPR(6);
+uint32_t SyscallHandler::OutputAudio(uint32_t channel, uint32_t volume, uint32_t bufPtr, bool blocking) {
+    if (channel >= AUDIO_CHANNEL_COUNT) {
+        return SCE_ERROR_AUDIO_INVALID_CHANNEL;
+    }
+    AudioChannel& ch = audioChannels_[channel];
+    if (!ch.reserved) {
+        return SCE_ERROR_AUDIO_CHANNEL_NOT_RESERVED;
+    }
+    if (volume > AUDIO_VOLUME_LIMIT) {
+        return SCE_ERROR_AUDIO_INVALID_VOLUME;
+    }
 
-    std::string title;
-    for (int i = 0; i < 32; ++i) {
-        char c = static_cast<char>(memory_.Read8(titlePtr + i));
-        if (!c) break;
-        title.push_back(c);
+    // Канал занят, пока играет предыдущий блок
+    const uint64_t now = timing_.GetTicks();
+    if (!blocking && ch.busyUntil > now) {
+        return SCE_ERROR_AUDIO_CHANNEL_BUSY;
     }
 
-    if (title.empty()) {
-        writeResult(uint32_t(-1));
-        return;
+    const uint32_t inChannels = ch.mono ? 1 : 2;
+    std::vector<int16_t> in(ch.sampleCount * inChannels);
+    memory_.ReadBytes(bufPtr, in.data(), in.size() * sizeof(int16_t));
+
+    // Громкость 0x8000 - без изменений; моно дублируется во все каналы выхода
+    const uint32_t outChannels = audio_.Channels();
+    std::vector<int16_t> out(ch.sampleCount * outChannels);
+    for (uint32_t s = 0; s < ch.sampleCount; ++s) {
+        for (uint32_t c = 0; c < outChannels; ++c) {
+            const int32_t sample = in[s * inChannels + std::min(c, inChannels - 1)];
+            out[s * outChannels + c] = static_cast<int16_t>(
+                std::clamp<int32_t>(sample * int32_t(volume) / AUDIO_VOLUME_MAX, INT16_MIN, INT16_MAX));
+        }
     }
+    audio_.SubmitAudio(out.data(), ch.sampleCount);
 
-    std::string path = "saves/" + title + ".sav";
-    std::ofstream f(path, std::ios::binary);
-    if (!f) {
-        writeResult(uint32_t(-1));
-        return;
+    // Блокирующий вывод ждёт, пока доиграет предыдущий блок
+    const uint64_t start = std::max(ch.busyUntil, now);
+    ch.busyUntil = start + static_cast<uint64_t>(ch.sampleCount) * core::CoreTiming::CPU_HZ / AUDIO_SAMPLE_RATE;
+    if (blocking && start > now) {
+        threads_.DelayThread(static_cast<uint32_t>((start - now) / core::CoreTiming::CYCLES_PER_US));
     }
+    return ch.sampleCount;
+}
+
+namespace {
+
+// disc0: и umd0: (umd:) - устройства UMD, регистр не важен
+bool IsUmdPath(const std::string& path) {
+    size_t colon = path.find(':');
+    if (colon == std::string::npos) return false;
+    std::string device = path.substr(0, colon);
+    for (char& c : device) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return device == "disc0" || device == "umd0" || device == "umd";
+}
 
-    for (uint32_t i = 0; i < size; ++i) {
-        char c = static_cast<char>(memory_.Read8(bufAddr + i));
-        f.put(c);
+// Флаги sceIoOpen
+constexpr uint32_t PSP_O_RDONLY = 0x0001;
+constexpr uint32_t PSP_O_WRONLY = 0x0002;
+constexpr uint32_t PSP_O_RDWR = PSP_O_RDONLY | PSP_O_WRONLY;
+constexpr uint32_t PSP_O_APPEND = 0x0100;
+constexpr uint32_t PSP_O_CREAT = 0x0200;
+constexpr uint32_t PSP_O_TRUNC = 0x0400;
+constexpr uint32_t PSP_O_EXCL = 0x0800;
+
+// Режим fopen для флагов PSP; nullptr - флаги недопустимы или файл
+// не должен открываться, код ошибки - в outError
+const char* OpenMode(uint32_t flags, bool exists, uint32_t& outError) {
+    const uint32_t access = flags & PSP_O_RDWR;
+    if (access == 0) {
+        outError = SCE_KERNEL_ERROR_ERRNO_INVALID_ARGUMENT;
+        return nullptr;
+    }
+    if (exists && (flags & PSP_O_CREAT) && (flags & PSP_O_EXCL)) {
+        outError = SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS;
+        return nullptr;
+    }
+    if (!exists && !(flags & PSP_O_CREAT)) {
+        outError = SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
+        return nullptr;
     }
 
-    f.close();
-    writeResult(0);
+    const bool read = (access & PSP_O_RDONLY) != 0;
+    if (!(access & PSP_O_WRONLY)) return exists ? "rb" : "wb+";
+    // "w" усекает и создаёт файл, "a" создаёт и пишет в конец,
+    // "r+" пишет в существующий без усечения
+    if (flags & PSP_O_APPEND) return read ? "ab+" : "ab";
+    if (!exists || (flags & PSP_O_TRUNC)) return read ? "wb+" : "wb";
+    return "rb+";
 }
 
-void SyscallHandler::Sys_IoOpen() {
-    uint32_t pathPtr = cpu_.GetGPR(4);
-    uint32_t flags = cpu_.GetGPR(5);
-    uint32_t mode = cpu_.GetGPR(6);
+// Ошибка PSP для errno хоста
+uint32_t ErrnoToSce(int error) {
+    switch (error) {
+        case ENOENT: return SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
+        case EACCES: return SCE_KERNEL_ERROR_ERRNO_ACCESS_DENIED;
+        case EEXIST: return SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS;
+        case EROFS:  return SCE_KERNEL_ERROR_ERRNO_READ_ONLY;
+        default:     return SCE_KERNEL_ERROR_ERRNO_IO_ERROR;
+    }
+}
+
+// Модель задержки ввода-вывода PSP: время, через которое гость видит результат
+constexpr uint64_t IO_BASE_LATENCY_US = 100;
+constexpr uint64_t IO_BYTES_PER_US = 32;
+// Повторная проверка, если хост ещё не выполнил операцию
+constexpr uint64_t IO_POLL_US = 100;
+
+}  // namespace
+
+void SyscallHandler::MountUmd(std::shared_ptr<loader::IsoFileSystem> umd) {
+    // Открытые дескрипторы ссылаются на записи старого индекса
+    umdFdMap_.clear();
+    umd_ = std::move(umd);
+}
 
-    std::string path;
-    for (int i = 0; i < 256; ++i) {
-        char c = static_cast<char>(memory_.Read8(pathPtr + i));
-        if (!c) break;
-        path.push_back(c);
+uint32_t SyscallHandler::Sys_IoOpen(uint32_t pathPtr, uint32_t flags, uint32_t /*mode*/) {
+    std::string path = memory_.ReadCString(pathPtr, 256);
+
+    if (IsUmdPath(path)) {
+        // UMD только для чтения; поиск по готовому индексу без обхода каталогов
+        const loader::IsoFileSystem::Entry* entry = umd_ ? umd_->Find(path) : nullptr;
+        if (!entry || entry->directory) {
+            return SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
+        }
+        if (flags & PSP_O_WRONLY) {
+            return SCE_KERNEL_ERROR_ERRNO_READ_ONLY;
+        }
+        int fd = nextFd_++;
+        umdFdMap_[fd] = { entry, 0 };
+        return fd;
     }
 
-    const char* modeStr = (flags & 0x00000100) ? "rb+" : "wb+";
-    FILE* f = std::fopen(path.c_str(), modeStr);
-    if (!f) f = std::fopen(path.c_str(), "rb+");
+    std::error_code ec;
+    uint32_t error = 0;
+    const char* modeStr = OpenMode(flags, std::filesystem::exists(path, ec), error);
+    if (!modeStr) {
+        return error;
+    }
 
+    errno = 0;
+    FILE* f = std::fopen(path.c_str(), modeStr);
     if (!f) {
-        writeResult(uint32_t(-1));
-        return;
+        return ErrnoToSce(errno);
     }
 
     int fd = nextFd_++;
     fdMap_[fd] = f;
-    writeResult(fd);
+    return fd;
 }
 
-void SyscallHandler::Sys_IoRead() {
-    int fd = static_cast<int>(cpu_.GetGPR(4));
-    uint32_t bufPtr = cpu_.GetGPR(5);
-    uint32_t size = cpu_.GetGPR(6);
+AsyncIoPool::Job SyscallHandler::MakeReadJob(int fd, std::shared_ptr<std::vector<uint8_t>> buffer) {
+    auto umdIt = umdFdMap_.find(fd);
+    if (umdIt != umdFdMap_.end()) {
+        // Запись и позиция - копии: MountUmd может очистить umdFdMap_, пока
+        // задание идёт. Позицию сдвигает OnIoEvent, пока fd занят
+        const loader::IsoFileSystem::Entry* entry = umdIt->second.entry;
+        const uint64_t position = umdIt->second.position;
+        return [this, umd = umd_, entry, position, buffer]() -> int64_t {
+            std::lock_guard<std::mutex> lock(umdMutex_);
+            ptrdiff_t read = umd->Read(*entry, position, buffer->data(), buffer->size());
+            if (read < 0) return static_cast<int32_t>(SCE_KERNEL_ERROR_ERRNO_IO_ERROR);
+            return read;
+        };
+    }
 
     auto it = fdMap_.find(fd);
-    if (it == fdMap_.end()) {
-        writeResult(uint32_t(-1));
-        return;
-    }
+    if (it == fdMap_.end()) return {};
 
     FILE* f = it->second;
-    std::vector<char> temp(size);
-    size_t read = std::fread(temp.data(), 1, size, f);
+    return [f, buffer]() -> int64_t {
+        return static_cast<int64_t>(std::fread(buffer->data(), 1, buffer->size(), f));
+    };
+}
 
-    for (size_t i = 0; i < read; ++i)
-        memory_.Write8(bufPtr + static_cast<uint32_t>(i), static_cast<uint8_t>(temp[i]));
+AsyncIoPool::Job SyscallHandler::MakeWriteJob(int fd, uint32_t bufPtr, uint32_t size) {
+    auto it = fdMap_.find(fd);
+    if (it == fdMap_.end()) return {};
 
-    writeResult(static_cast<uint32_t>(read));
+    // Копия при вызове: гость может менять буфер, пока пул пишет
+    FILE* f = it->second;
+    auto data = std::as_const(memory_).GetRange(bufPtr, size);
+    return [f, buf = std::vector<uint8_t>(data.begin(), data.end())]() -> int64_t {
+        return static_cast<int64_t>(std::fwrite(buf.data(), 1, buf.size(), f));
+    };
 }
 
-void SyscallHandler::Sys_IoWrite() {
-    int fd = static_cast<int>(cpu_.GetGPR(4));
-    uint32_t bufPtr = cpu_.GetGPR(5);
-    uint32_t size = cpu_.GetGPR(6);
+bool SyscallHandler::StartIo(int fd, uint32_t size, AsyncIoPool::Job job) {
+    auto [it, inserted] = pendingIo_.try_emplace(fd);
+    if (!inserted) {
+        if (!it->second.done) return false;
+        it->second = PendingIo{};   // несобранный результат прошлой операции
+    }
+    io_.Submit(fd, std::move(job));
 
-    auto it = fdMap_.find(fd);
-    if (it == fdMap_.end()) {
-        writeResult(uint32_t(-1));
+    const int64_t latency = core::CoreTiming::UsToCycles(IO_BASE_LATENCY_US + size / IO_BYTES_PER_US);
+    timing_.ScheduleEvent(latency, ioEvent_, static_cast<uint64_t>(fd));
+    return true;
+}
+
+void SyscallHandler::OnIoEvent(void* userdata, uint64_t param, int64_t /*cyclesLate*/) {
+    auto* self = static_cast<SyscallHandler*>(userdata);
+    const int fd = static_cast<int>(param);
+    auto it = self->pendingIo_.find(fd);
+    if (it == self->pendingIo_.end()) return;
+
+    int64_t result = 0;
+    if (!self->io_.Poll(fd, result)) {
+        // Хостовый диск медленнее PSP: гость продолжает работать, проверим позже.
+        // Уступаем ядро, чтобы поток пула не ждал, пока гость крутит простой
+        std::this_thread::yield();
+        self->timing_.ScheduleEvent(core::CoreTiming::UsToCycles(IO_POLL_US), self->ioEvent_, param);
         return;
     }
 
-    FILE* f = it->second;
-    std::vector<char> temp(size);
-    for (uint32_t i = 0; i < size; ++i)
-        temp[i] = static_cast<char>(memory_.Read8(bufPtr + i));
+    PendingIo& io = it->second;
+    if (io.readBuffer) {
+        // Память гостя меняется только в потоке эмуляции: страницы
+        // помечаются, а блоки кода в буфере инвалидируются здесь
+        if (result > 0) {
+            self->memory_.WriteBytes(io.readAddr, io.readBuffer->data(), static_cast<size_t>(result));
+            // Файл UMD мог быть закрыт сменой образа
+            auto umdIt = self->umdFdMap_.find(fd);
+            if (umdIt != self->umdFdMap_.end()) umdIt->second.position += static_cast<uint64_t>(result);
+        }
+        io.readBuffer.reset();
+    }
+    if (io.syncWait) {
+        self->pendingIo_.erase(it);
+        self->threads_.WakeWaiting(ThreadManager::WaitType::AsyncIo, fd, static_cast<uint32_t>(result));
+    } else if (io.asyncWait) {
+        self->WriteAsyncResult(io.resultAddr, result);
+        self->pendingIo_.erase(it);
+        self->threads_.WakeWaiting(ThreadManager::WaitType::AsyncIo, fd);
+    } else {
+        io.done = true;
+        io.result = result;
+    }
+    self->threads_.RescheduleIfNeeded();
+}
+
+void SyscallHandler::WriteAsyncResult(uint32_t addr, int64_t result) {
+    if (!addr) return;
+    const uint64_t value = static_cast<uint64_t>(result);
+    memory_.Write32(addr, static_cast<uint32_t>(value));
+    memory_.Write32(addr + 4, static_cast<uint32_t>(value >> 32));
+}
+
+// sceIoRead/sceIoWrite идут через пул, как асинхронные: ждёт только
+// вызвавший поток гостя, число байт в его v0 запишет OnIoEvent
+uint32_t SyscallHandler::Sys_IoRead(uint32_t fd, uint32_t bufPtr, uint32_t size) {
+    const uint32_t error = Sys_IoReadAsync(fd, bufPtr, size);
+    if (error) {
+        return error;
+    }
+    pendingIo_[fd].syncWait = true;
+    threads_.WaitCurrent(ThreadManager::WaitType::AsyncIo, fd);
+    return 0;
+}
+
+uint32_t SyscallHandler::Sys_IoWrite(uint32_t fd, uint32_t bufPtr, uint32_t size) {
+    const uint32_t error = Sys_IoWriteAsync(fd, bufPtr, size);
+    if (error) {
+        return error;
+    }
+    pendingIo_[fd].syncWait = true;
+    threads_.WaitCurrent(ThreadManager::WaitType::AsyncIo, fd);
+    return 0;
+}
+
+uint32_t SyscallHandler::Sys_IoReadAsync(uint32_t fd, uint32_t bufPtr, uint32_t size) {
+    // Ошибка адреса - при вызове, а не при копировании в OnIoEvent
+    std::as_const(memory_).GetRange(bufPtr, size);
+
+    auto buffer = std::make_shared<std::vector<uint8_t>>(size);
+    AsyncIoPool::Job job = MakeReadJob(fd, buffer);
+    if (!job) {
+        return SCE_KERNEL_ERROR_BADF;
+    }
+    if (!StartIo(fd, size, std::move(job))) {
+        return SCE_KERNEL_ERROR_ASYNC_BUSY;
+    }
+
+    PendingIo& io = pendingIo_[fd];
+    io.readBuffer = std::move(buffer);
+    io.readAddr = bufPtr;
+    return 0;
+}
+
+uint32_t SyscallHandler::Sys_IoWriteAsync(uint32_t fd, uint32_t bufPtr, uint32_t size) {
+    AsyncIoPool::Job job = MakeWriteJob(fd, bufPtr, size);
+    if (!job) {
+        return SCE_KERNEL_ERROR_BADF;
+    }
+    return StartIo(fd, size, std::move(job)) ? 0 : SCE_KERNEL_ERROR_ASYNC_BUSY;
+}
+
+uint32_t SyscallHandler::Sys_IoWaitAsync(uint32_t fd, uint32_t resultPtr) {
+    auto it = pendingIo_.find(fd);
+    if (it == pendingIo_.end() || it->second.syncWait || it->second.asyncWait) {
+        return SCE_KERNEL_ERROR_NOASYNC;
+    }
 
-    size_t written = std::fwrite(temp.data(), 1, size, f);
-    writeResult(static_cast<uint32_t>(written));
+    PendingIo& io = it->second;
+    if (io.done) {
+        WriteAsyncResult(resultPtr, io.result);
+        pendingIo_.erase(it);
+        return 0;
+    }
+
+    // Результат запишет OnIoEvent
+    io.asyncWait = true;
+    io.resultAddr = resultPtr;
+    threads_.WaitCurrent(ThreadManager::WaitType::AsyncIo, fd);
+    return 0;
+}
+
+uint32_t SyscallHandler::Sys_IoPollAsync(uint32_t fd, uint32_t resultPtr) {
+    auto it = pendingIo_.find(fd);
+    if (it == pendingIo_.end() || it->second.syncWait) {
+        return SCE_KERNEL_ERROR_NOASYNC;
+    }
+    if (!it->second.done) {
+        return 1;
+    }
+
+    WriteAsyncResult(resultPtr, it->second.result);
+    pendingIo_.erase(it);
+    return 0;
 }
 
-void SyscallHandler::Sys_IoClose() {
-    int fd = static_cast<int>(cpu_.GetGPR(4));
+uint32_t SyscallHandler::Sys_IoClose(uint32_t fd) {
+    auto pending = pendingIo_.find(fd);
+    if (pending != pendingIo_.end()) {
+        if (!pending->second.done) {
+            return SCE_KERNEL_ERROR_ASYNC_BUSY;
+        }
+        pendingIo_.erase(pending);
+    }
+
+    if (umdFdMap_.erase(fd)) {
+        return 0;
+    }
 
     auto it = fdMap_.find(fd);
     if (it != fdMap_.end()) {
         std::fclose(it->second);
         fdMap_.erase(it);
-        writeResult(0);
+        return 0;
     } else {
-        writeResult(uint32_t(-1));
+        return SCE_KERNEL_ERROR_BADF;
     }
 }
 
+uint32_t SyscallHandler::Sys_LibcTime(uint32_t timePtr) {
+    uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+    if (timePtr) memory_.Write32(timePtr, now);
+    return now;
+}
+
+uint32_t SyscallHandler::Sys_CreateThread(uint32_t namePtr, uint32_t entry, uint32_t priority,
+                                          uint32_t stackSize, uint32_t attr, uint32_t /*optParam*/) {
+    return threads_.CreateThread(memory_.ReadCString(namePtr, 32), entry, priority, stackSize, attr);
+}
+
+uint32_t SyscallHandler::Sys_StartThread(uint32_t thid, uint32_t argSize, uint32_t argPtr) {
+    return threads_.StartThread(thid, argSize, argPtr);
+}
+
+uint32_t SyscallHandler::Sys_ExitThread(uint32_t exitStatus) {
+    return threads_.ExitThread(exitStatus);
+}
+
+uint32_t SyscallHandler::Sys_ExitDeleteThread(uint32_t exitStatus) {
+    return threads_.ExitDeleteThread(exitStatus);
+}
+
+uint32_t SyscallHandler::Sys_DeleteThread(uint32_t thid) {
+    return threads_.DeleteThread(thid);
+}
+
+uint32_t SyscallHandler::Sys_SleepThread() {
+    return threads_.SleepThread();
+}
+
+uint32_t SyscallHandler::Sys_WakeupThread(uint32_t thid) {
+    return threads_.WakeupThread(thid);
+}
+
+uint32_t SyscallHandler::Sys_DelayThread(uint32_t usec) {
+    return threads_.DelayThread(usec);
+}
+
+uint32_t SyscallHandler::Sys_GetThreadId() {
+    return threads_.GetThreadId();
+}
+
 }  // namespace syscall
 }  // namespace ppsspp
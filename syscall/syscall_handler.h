@@ -4,52 +4,184 @@
 
 #include "../core/cpu_state.h"
 #include "../core/memory.h"
+#include "../core/core_timing.h"
+#include "../core/mmio.h"
 #include "../core/audio_system.h"
 #include "../video/video_engine.h"
+#include "../Loader/iso_filesystem.h"
+#include "thread_manager.h"
+#include "async_io.h"
 
+#include <array>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <string>
-#include <chrono>
+#include <vector>
 #include <cstdint>
 #include <cstdio>
 
 namespace ppsspp {
 namespace syscall {
 
+// Коды ошибок sceAudio
+constexpr uint32_t SCE_ERROR_AUDIO_CHANNEL_BUSY = 0x80260002;
+constexpr uint32_t SCE_ERROR_AUDIO_INVALID_CHANNEL = 0x80260003;
+constexpr uint32_t SCE_ERROR_AUDIO_NO_CHANNELS_AVAILABLE = 0x80260005;
+constexpr uint32_t SCE_ERROR_AUDIO_OUTPUT_SAMPLE_DATA_SIZE_NOT_ALIGNED = 0x80260006;
+constexpr uint32_t SCE_ERROR_AUDIO_INVALID_FORMAT = 0x80260007;
+constexpr uint32_t SCE_ERROR_AUDIO_CHANNEL_NOT_RESERVED = 0x80260008;
+constexpr uint32_t SCE_ERROR_AUDIO_INVALID_VOLUME = 0x8026000B;
+constexpr uint32_t SCE_ERROR_AUDIO_CHANNEL_ALREADY_RESERVED = 0x80268002;
+
 class SyscallHandler {
 public:
-    SyscallHandler(core::CPUState& cpu, core::Memory& memory,
-                   core::AudioSystem& audio, video::VideoEngine& video);
+    // timing - время системы, которое продвигает её главный цикл;
+    // controller - её блок контроллера
+    SyscallHandler(core::CPUState& cpu, core::Memory& memory, core::CoreTiming& timing,
+                   const core::ControllerMmio& controller, core::AudioSystem& audio,
+                   video::VideoEngine& video);
 
+    // Выполняет HLE-функцию по коду syscall (индекс в NID_TABLE),
+    // возвращает PC после вызова
     uint32_t Invoke(uint32_t syscallID);
 
+    // Подключает образ UMD: пути disc0:/ и umd0:/ открываются из него
+    void MountUmd(std::shared_ptr<loader::IsoFileSystem> umd);
+
+    ThreadManager& GetThreadManager() { return threads_; }
+
 private:
     core::CPUState& cpu_;
     core::Memory& memory_;
     core::AudioSystem& audio_;
     video::VideoEngine& video_;
+    core::CoreTiming& timing_;
+    const core::ControllerMmio& controller_;
+    ThreadManager threads_;
+
+    // Кадр PSP - 59.94 Гц
+    static constexpr int64_t VBLANK_CYCLES = core::CoreTiming::CPU_HZ * 1001 / 60000;
+    core::CoreTiming::EventType vblankEvent_;
+    static void OnVblank(void* userdata, uint64_t param, int64_t cyclesLate);
+
+    // sceCtrlReadBufferPositive читает не больше 64 записей
+    static constexpr uint32_t CTRL_BUFFER_MAX = 64;
+
+    // Тик RTC на 1970-01-01 и тик при создании обработчика
+    static constexpr uint64_t RTC_UNIX_EPOCH_TICK = 62135596800000000ull;
+    uint64_t rtcBaseTick_ = 0;
 
-    std::chrono::steady_clock::time_point startTime_;
+    // Каналы sceAudio: sceAudioChReserve задаёт длину блока и формат
+    static constexpr uint32_t AUDIO_CHANNEL_COUNT = 8;
+    static constexpr uint32_t AUDIO_NEXT_CHANNEL = 0xFFFFFFFF;  // любой свободный
+    static constexpr uint32_t AUDIO_SAMPLE_MIN = 64;            // и шаг длины блока
+    static constexpr uint32_t AUDIO_SAMPLE_MAX = 65472;
+    static constexpr uint32_t AUDIO_FORMAT_STEREO = 0x00;
+    static constexpr uint32_t AUDIO_FORMAT_MONO = 0x10;
+    static constexpr int32_t AUDIO_VOLUME_MAX = 0x8000;
+    static constexpr uint32_t AUDIO_VOLUME_LIMIT = 0xFFFF;
+    static constexpr uint64_t AUDIO_SAMPLE_RATE = 44100;
+    struct AudioChannel {
+        bool reserved = false;
+        bool mono = false;
+        uint32_t sampleCount = 0;
+        uint64_t busyUntil = 0;     // такт CoreTiming, когда доиграет блок
+    };
+    std::array<AudioChannel, AUDIO_CHANNEL_COUNT> audioChannels_;
+    uint32_t OutputAudio(uint32_t channel, uint32_t volume, uint32_t bufPtr, bool blocking);
 
     // fd → FILE* mapping for sceIo*
     std::unordered_map<int, FILE*> fdMap_;
     int nextFd_ = 3;  // 0,1,2 зарезервированы
 
+    // Файлы UMD: запись индекса и текущая позиция; номера fd общие с fdMap_
+    struct UmdFile {
+        const loader::IsoFileSystem::Entry* entry;
+        uint64_t position;
+    };
+    std::shared_ptr<loader::IsoFileSystem> umd_;
+    std::unordered_map<int, UmdFile> umdFdMap_;
+    std::mutex umdMutex_;   // образ UMD читается и из потоков ввода-вывода
+
+    // Операции ввода-вывода идут в пуле; завершение проверяет событие
+    // CoreTiming через время, за которое операцию выполнила бы PSP.
+    // Пул не трогает память гостя: данные идут через хостовый буфер
+    struct PendingIo {
+        bool done = false;
+        int64_t result = 0;
+        bool syncWait = false;      // поток ждёт в sceIoRead/sceIoWrite
+        bool asyncWait = false;     // поток ждёт в sceIoWaitAsync
+        uint32_t resultAddr = 0;    // куда sceIoWaitAsync запишет результат
+        // Чтение: прочитанное копируется в readAddr при завершении
+        std::shared_ptr<std::vector<uint8_t>> readBuffer;
+        uint32_t readAddr = 0;
+    };
+    std::unordered_map<int, PendingIo> pendingIo_;
+    core::CoreTiming::EventType ioEvent_;
+    static void OnIoEvent(void* userdata, uint64_t param, int64_t cyclesLate);
+
+    // Задания чтения в buffer и записи копии [bufPtr, bufPtr + size) для fd;
+    // пустое - fd не открыт
+    AsyncIoPool::Job MakeReadJob(int fd, std::shared_ptr<std::vector<uint8_t>> buffer);
+    AsyncIoPool::Job MakeWriteJob(int fd, uint32_t bufPtr, uint32_t size);
+    // Ставит задание в пул; false - на fd уже идёт операция
+    bool StartIo(int fd, uint32_t size, AsyncIoPool::Job job);
+    // Результат для sceIoWaitAsync/sceIoPollAsync: 64-битное значение
+    void WriteAsyncResult(uint32_t addr, int64_t result);
+
+    // Последним: потоки пула останавливаются раньше, чем закрываются файлы
+    AsyncIoPool io_;
+
     void writeResult(uint32_t value);
 
+    // Обработчик с сигнатурой: аргументы - a0..a3, t0..t3, результат - в v0
+    using SyscallFunc = void (*)(SyscallHandler&);
+    struct SyscallEntry {
+        uint32_t nid;
+        SyscallFunc func;
+    };
+    // По индексу кода syscall, в порядке NID_TABLE
+    static const SyscallEntry DISPATCH[];
+    static constexpr bool DispatchMatchesNidTable();
+
+    // Переходник, раскладывающий регистры по параметрам метода
+    template <auto Method>
+    static void Call(SyscallHandler& handler);
+    template <auto Method, size_t... I>
+    static void CallWithArgs(SyscallHandler& handler, std::index_sequence<I...>);
+
     // Syscall implementations
-    void Sys_DisplayWaitVblankStart();
-    void Sys_DisplaySetMode();
-    void Sys_CtrlReadBufferPositive();
-    void Sys_CtrlPeekBufferPositive();
     void Sys_ExitGame();
-    void Sys_RtcGetTick();
-    void Sys_AudioOutput();
-    void Sys_UtilitySavedata();
-    void Sys_IoOpen();
-    void Sys_IoRead();
-    void Sys_IoWrite();
-    void Sys_IoClose();
+    uint32_t Sys_DisplayWaitVblankStart();
+    uint32_t Sys_DisplaySetMode(uint32_t mode, uint32_t width, uint32_t height);
+    uint32_t Sys_CtrlReadBufferPositive(uint32_t dataAddr, uint32_t count);
+    uint32_t Sys_CtrlPeekBufferPositive(uint32_t dataAddr, uint32_t count);
+    uint32_t Sys_RtcGetCurrentTick(uint32_t tickPtr);
+    uint32_t Sys_AudioChReserve(uint32_t channel, uint32_t sampleCount, uint32_t format);
+    uint32_t Sys_AudioChRelease(uint32_t channel);
+    uint32_t Sys_AudioOutput(uint32_t channel, uint32_t volume, uint32_t bufPtr);
+    uint32_t Sys_AudioOutputBlocking(uint32_t channel, uint32_t volume, uint32_t bufPtr);
+    uint32_t Sys_IoOpen(uint32_t pathPtr, uint32_t flags, uint32_t mode);
+    uint32_t Sys_IoRead(uint32_t fd, uint32_t bufPtr, uint32_t size);
+    uint32_t Sys_IoWrite(uint32_t fd, uint32_t bufPtr, uint32_t size);
+    uint32_t Sys_IoClose(uint32_t fd);
+    uint32_t Sys_IoReadAsync(uint32_t fd, uint32_t bufPtr, uint32_t size);
+    uint32_t Sys_IoWriteAsync(uint32_t fd, uint32_t bufPtr, uint32_t size);
+    uint32_t Sys_IoWaitAsync(uint32_t fd, uint32_t resultPtr);
+    uint32_t Sys_IoPollAsync(uint32_t fd, uint32_t resultPtr);
+    uint32_t Sys_LibcTime(uint32_t timePtr);
+    uint32_t Sys_CreateThread(uint32_t namePtr, uint32_t entry, uint32_t priority,
+                              uint32_t stackSize, uint32_t attr, uint32_t optParam);
+    uint32_t Sys_StartThread(uint32_t thid, uint32_t argSize, uint32_t argPtr);
+    uint32_t Sys_ExitThread(uint32_t exitStatus);
+    uint32_t Sys_ExitDeleteThread(uint32_t exitStatus);
+    uint32_t Sys_DeleteThread(uint32_t thid);
+    uint32_t Sys_SleepThread();
+    uint32_t Sys_WakeupThread(uint32_t thid);
+    uint32_t Sys_DelayThread(uint32_t usec);
+    uint32_t Sys_GetThreadId();
 };
 
 }  // namespace syscall
@@ -0,0 +1,377 @@
+// syscall/thread_manager.cpp
+
+#include "thread_manager.h"
+#include "nid_table.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace ppsspp {
+namespace syscall {
+
+namespace {
+
+constexpr uint32_t NID_EXIT_THREAD = 0xAA73C935;    // sceKernelExitThread
+constexpr uint32_t MIN_STACK_SIZE = 0x200;
+constexpr uint32_t STACK_ALIGN = 0x100;
+// Ниже - пользовательский образ; стеки туда не опускаются
+constexpr uint32_t STACK_FLOOR = core::Memory::RAM_BASE + 0x00800000;
+// Область сохранения аргументов над указателем стека
+constexpr uint32_t STACK_ARG_AREA = 0x40;
+
+constexpr uint32_t MIPS_NOP = 0x00000000;
+constexpr uint32_t MIPS_B_SELF = 0x1000FFFF;        // beq $zero, $zero, .
+
+}  // namespace
+
+ThreadManager::ThreadManager(core::CPUState& cpu, core::Memory& memory, core::CoreTiming& timing)
+    : cpu_(cpu), memory_(memory), timing_(timing) {
+    delayEvent_ = timing_.RegisterEvent("ThreadDelay", &ThreadManager::OnDelayExpired, this);
+    queueHead_.fill(NO_THREAD);
+    queueTail_.fill(NO_THREAD);
+}
+
+void ThreadManager::EnsureInitialized() {
+    if (initialized_) return;
+    initialized_ = true;
+
+    // Возврат из функции потока попадает на sceKernelExitThread
+    uint32_t exitCode = 0;
+    LookupNid(NID_EXIT_THREAD, exitCode);
+    memory_.Write32(THREAD_RETURN_ADDR, (exitCode << 6) | 0x0C);
+    memory_.Write32(THREAD_RETURN_ADDR + 4, MIPS_NOP);
+    memory_.Write32(IDLE_LOOP_ADDR, MIPS_B_SELF);
+    memory_.Write32(IDLE_LOOP_ADDR + 4, MIPS_NOP);
+
+    // Поток простоя: самый низкий приоритет, никогда не блокируется
+    idle_ = AllocateSlot();
+    Thread& idle = threads_[idle_];
+    std::snprintf(idle.name, sizeof(idle.name), "idle");
+    idle.entry = IDLE_LOOP_ADDR;
+    idle.priority = NUM_PRIORITIES - 1;
+    ResetContext(idle);
+    MakeReady(idle_);
+
+    // Исполняющийся сейчас код становится главным потоком
+    current_ = AllocateSlot();
+    Thread& main = threads_[current_];
+    std::snprintf(main.name, sizeof(main.name), "main");
+    main.entry = cpu_.GetPC();
+    main.priority = MAIN_THREAD_PRIORITY;
+    main.state = ThreadState::Running;
+    if (cpu_.GetGPR(core::reg::SP) == 0 && AllocateStack(MAIN_THREAD_STACK_SIZE, main.stackAddr)) {
+        main.stackSize = MAIN_THREAD_STACK_SIZE;
+        cpu_.SetGPR(core::reg::SP, main.stackAddr + main.stackSize - STACK_ARG_AREA);
+    }
+    rescheduleNeeded_ = false;
+}
+
+ThreadManager::Thread* ThreadManager::FindThread(uint32_t thid) {
+    const uint32_t slot = thid % MAX_THREADS;
+    Thread& thread = threads_[slot];
+    if (thread.state == ThreadState::Free || thread.uid != thid) return nullptr;
+    return &thread;
+}
+
+uint8_t ThreadManager::AllocateSlot() {
+    for (uint32_t slot = 0; slot < MAX_THREADS; ++slot) {
+        Thread& thread = threads_[slot];
+        if (thread.state != ThreadState::Free) continue;
+
+        const uint32_t serial = nextSerial_++;
+        thread = Thread{};
+        // UID положителен и однозначно указывает на слот
+        thread.uid = ((serial * MAX_THREADS) | slot) & 0x7FFFFFFF;
+        thread.state = ThreadState::Dormant;
+        thread.prev = thread.next = NO_THREAD;
+        return static_cast<uint8_t>(slot);
+    }
+    return NO_THREAD;
+}
+
+bool ThreadManager::AllocateStack(uint32_t size, uint32_t& outAddr) {
+    // Сначала стек завершённого потока подходящего размера
+    for (size_t i = 0; i < numFreeStacks_; ++i) {
+        if (freeStacks_[i].size != size) continue;
+        outAddr = freeStacks_[i].addr;
+        freeStacks_[i] = freeStacks_[--numFreeStacks_];
+        return true;
+    }
+    if (stackBottom_ - STACK_FLOOR < size) return false;
+    stackBottom_ -= size;
+    outAddr = stackBottom_;
+    return true;
+}
+
+void ThreadManager::FreeThread(uint8_t slot) {
+    Thread& thread = threads_[slot];
+    if (thread.stackSize) {
+        if (thread.stackAddr == stackBottom_) {
+            stackBottom_ += thread.stackSize;
+        } else if (numFreeStacks_ < freeStacks_.size()) {
+            freeStacks_[numFreeStacks_++] = { thread.stackAddr, thread.stackSize };
+        }
+    }
+    thread.state = ThreadState::Free;
+    thread.uid = 0;
+}
+
+void ThreadManager::ResetContext(Thread& thread) {
+    core::CPUState::Context& ctx = thread.context;
+    std::memset(&ctx, 0, sizeof(ctx));
+    ctx.pc = thread.entry;
+    ctx.gp = cpu_.GetGP();
+    ctx.gpr[28] = cpu_.GetGPR(28);                          // $gp создателя
+    ctx.gpr[29] = thread.stackAddr + thread.stackSize - STACK_ARG_AREA;
+    ctx.gpr[31] = THREAD_RETURN_ADDR;
+}
+
+// --- Очереди готовых ---
+
+void ThreadManager::PushBack(uint8_t slot) {
+    Thread& thread = threads_[slot];
+    const uint8_t prio = thread.priority;
+    thread.prev = queueTail_[prio];
+    thread.next = NO_THREAD;
+    if (queueTail_[prio] != NO_THREAD) {
+        threads_[queueTail_[prio]].next = slot;
+    } else {
+        queueHead_[prio] = slot;
+        readyMask_[prio / 64] |= uint64_t(1) << (prio % 64);
+    }
+    queueTail_[prio] = slot;
+}
+
+void ThreadManager::PushFront(uint8_t slot) {
+    Thread& thread = threads_[slot];
+    const uint8_t prio = thread.priority;
+    thread.prev = NO_THREAD;
+    thread.next = queueHead_[prio];
+    if (queueHead_[prio] != NO_THREAD) {
+        threads_[queueHead_[prio]].prev = slot;
+    } else {
+        queueTail_[prio] = slot;
+        readyMask_[prio / 64] |= uint64_t(1) << (prio % 64);
+    }
+    queueHead_[prio] = slot;
+}
+
+void ThreadManager::Unlink(uint8_t slot) {
+    Thread& thread = threads_[slot];
+    const uint8_t prio = thread.priority;
+    if (thread.prev != NO_THREAD) threads_[thread.prev].next = thread.next;
+    else queueHead_[prio] = thread.next;
+    if (thread.next != NO_THREAD) threads_[thread.next].prev = thread.prev;
+    else queueTail_[prio] = thread.prev;
+    thread.prev = thread.next = NO_THREAD;
+
+    if (queueHead_[prio] == NO_THREAD) {
+        readyMask_[prio / 64] &= ~(uint64_t(1) << (prio % 64));
+    }
+}
+
+int ThreadManager::HighestReadyPriority() const {
+    for (size_t word = 0; word < std::size(readyMask_); ++word) {
+        if (readyMask_[word]) {
+            return static_cast<int>(word * 64 + std::countr_zero(readyMask_[word]));
+        }
+    }
+    return -1;
+}
+
+// --- Переключение ---
+
+void ThreadManager::MakeReady(uint8_t slot) {
+    threads_[slot].state = ThreadState::Ready;
+    PushBack(slot);
+    rescheduleNeeded_ = true;
+}
+
+void ThreadManager::BlockCurrent(ThreadState state) {
+    threads_[current_].state = state;
+    rescheduleNeeded_ = true;
+}
+
+void ThreadManager::SwitchTo(uint8_t slot) {
+    // Удалённому потоку (ExitDeleteThread) контекст уже не нужен
+    if (threads_[current_].state != ThreadState::Free) {
+        cpu_.SaveContext(threads_[current_].context);
+    }
+    current_ = slot;
+    threads_[slot].state = ThreadState::Running;
+    cpu_.LoadContext(threads_[slot].context);
+    ++switches_;
+}
+
+void ThreadManager::RescheduleIfNeeded() {
+    if (!rescheduleNeeded_) return;
+    rescheduleNeeded_ = false;
+
+    const int best = HighestReadyPriority();
+    Thread& current = threads_[current_];
+    if (current.state == ThreadState::Running) {
+        // Равный приоритет не вытесняет: очередь сменяется только при ожидании
+        if (best < 0 || best >= current.priority) return;
+        current.state = ThreadState::Ready;
+        PushFront(current_);
+    }
+
+    const uint8_t next = queueHead_[best];
+    Unlink(next);
+    SwitchTo(next);
+}
+
+void ThreadManager::OnDelayExpired(void* userdata, uint64_t param, int64_t /*cyclesLate*/) {
+    auto* self = static_cast<ThreadManager*>(userdata);
+    const uint8_t slot = static_cast<uint8_t>(param);
+    if (self->threads_[slot].state != ThreadState::Delayed) return;
+    self->MakeReady(slot);
+    self->RescheduleIfNeeded();
+}
+
+void ThreadManager::WaitCurrent(WaitType type, uint32_t id) {
+    EnsureInitialized();
+    Thread& current = threads_[current_];
+    current.waitType = type;
+    current.waitId = id;
+    BlockCurrent(ThreadState::Waiting);
+}
+
+void ThreadManager::WakeWaiting(WaitType type, uint32_t id) {
+    WakeWaitingImpl(type, id, false, 0);
+}
+
+void ThreadManager::WakeWaiting(WaitType type, uint32_t id, uint32_t result) {
+    WakeWaitingImpl(type, id, true, result);
+}
+
+void ThreadManager::WakeWaitingImpl(WaitType type, uint32_t id, bool setResult, uint32_t result) {
+    if (!initialized_) return;
+    for (uint32_t slot = 0; slot < MAX_THREADS; ++slot) {
+        Thread& thread = threads_[slot];
+        if (thread.state != ThreadState::Waiting || thread.waitType != type || thread.waitId != id) continue;
+        thread.waitType = WaitType::None;
+        // v0 ждавшего уже сохранён в контексте при переключении
+        if (setResult) thread.context.gpr[2] = result;   // $v0
+        MakeReady(static_cast<uint8_t>(slot));
+    }
+}
+
+// --- Syscall ---
+
+uint32_t ThreadManager::CreateThread(const std::string& name, uint32_t entry, uint32_t priority,
+                                     uint32_t stackSize, uint32_t attr) {
+    EnsureInitialized();
+    // Атрибуты (PSP_THREAD_ATTR_VFPU и пр.) не влияют: VFPU сохраняется всегда
+    (void)attr;
+    if (entry == 0 || (entry & 3)) return SCE_KERNEL_ERROR_ILLEGAL_ENTRY;
+    // Наименьший приоритет занят потоком простоя
+    if (priority == 0 || priority >= NUM_PRIORITIES - 1) return SCE_KERNEL_ERROR_ILLEGAL_PRIORITY;
+    if (stackSize < MIN_STACK_SIZE) return SCE_KERNEL_ERROR_ILLEGAL_STACK_SIZE;
+    stackSize = (stackSize + STACK_ALIGN - 1) & ~(STACK_ALIGN - 1);
+
+    const uint8_t slot = AllocateSlot();
+    if (slot == NO_THREAD) return SCE_KERNEL_ERROR_NO_MEMORY;
+    Thread& thread = threads_[slot];
+    if (!AllocateStack(stackSize, thread.stackAddr)) {
+        thread.state = ThreadState::Free;
+        return SCE_KERNEL_ERROR_NO_MEMORY;
+    }
+
+    std::snprintf(thread.name, sizeof(thread.name), "%s", name.c_str());
+    thread.entry = entry;
+    thread.stackSize = stackSize;
+    thread.priority = static_cast<uint8_t>(priority);
+    return thread.uid;
+}
+
+uint32_t ThreadManager::StartThread(uint32_t thid, uint32_t argSize, uint32_t argPtr) {
+    EnsureInitialized();
+    Thread* thread = FindThread(thid);
+    if (!thread) return SCE_KERNEL_ERROR_UNKNOWN_THID;
+    if (thread->state != ThreadState::Dormant) return SCE_KERNEL_ERROR_NOT_DORMANT;
+
+    ResetContext(*thread);
+    // Блок аргументов копируется на вершину стека нового потока
+    uint32_t& sp = thread->context.gpr[29];
+    if (argPtr && argSize) {
+        const uint32_t size = std::min(argSize, thread->stackSize / 2);
+        sp -= (size + 15) & ~15u;
+        auto args = std::as_const(memory_).GetRange(argPtr, size);
+        memory_.WriteBytes(sp, args.data(), args.size());
+        thread->context.gpr[4] = size;
+        thread->context.gpr[5] = sp;
+        sp -= STACK_ARG_AREA;
+    }
+
+    MakeReady(static_cast<uint8_t>(thid % MAX_THREADS));
+    return 0;
+}
+
+uint32_t ThreadManager::ExitThread(uint32_t exitStatus) {
+    EnsureInitialized();
+    threads_[current_].exitStatus = exitStatus;
+    BlockCurrent(ThreadState::Dormant);
+    return 0;
+}
+
+uint32_t ThreadManager::ExitDeleteThread(uint32_t exitStatus) {
+    EnsureInitialized();
+    threads_[current_].exitStatus = exitStatus;
+    BlockCurrent(ThreadState::Dormant);
+    FreeThread(current_);
+    return 0;
+}
+
+uint32_t ThreadManager::DeleteThread(uint32_t thid) {
+    EnsureInitialized();
+    Thread* thread = FindThread(thid);
+    if (!thread) return SCE_KERNEL_ERROR_UNKNOWN_THID;
+    if (thread->state != ThreadState::Dormant) return SCE_KERNEL_ERROR_NOT_DORMANT;
+    FreeThread(static_cast<uint8_t>(thid % MAX_THREADS));
+    return 0;
+}
+
+uint32_t ThreadManager::SleepThread() {
+    EnsureInitialized();
+    Thread& current = threads_[current_];
+    if (current.wakeupCount) {
+        --current.wakeupCount;
+        return 0;
+    }
+    BlockCurrent(ThreadState::Sleeping);
+    return 0;
+}
+
+uint32_t ThreadManager::WakeupThread(uint32_t thid) {
+    EnsureInitialized();
+    Thread* thread = FindThread(thid);
+    if (!thread) return SCE_KERNEL_ERROR_UNKNOWN_THID;
+    if (thread->state == ThreadState::Dormant) return SCE_KERNEL_ERROR_DORMANT;
+
+    if (thread->state == ThreadState::Sleeping) {
+        MakeReady(static_cast<uint8_t>(thid % MAX_THREADS));
+    } else {
+        ++thread->wakeupCount;
+    }
+    return 0;
+}
+
+uint32_t ThreadManager::DelayThread(uint32_t usec) {
+    EnsureInitialized();
+    // Даже нулевая задержка уступает процессор до следующего отрезка
+    timing_.ScheduleEvent(core::CoreTiming::UsToCycles(usec), delayEvent_, current_);
+    BlockCurrent(ThreadState::Delayed);
+    return 0;
+}
+
+uint32_t ThreadManager::GetThreadId() {
+    EnsureInitialized();
+    return threads_[current_].uid;
+}
+
+}  // namespace syscall
+}  // namespace ppsspp
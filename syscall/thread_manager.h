@@ -0,0 +1,172 @@
+// syscall/thread_manager.h
+
+#pragma once
+
+#include "../core/cpu_state.h"
+#include "../core/memory.h"
+#include "../core/core_timing.h"
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace ppsspp {
+namespace syscall {
+
+// Коды ошибок ThreadManForUser
+constexpr uint32_t SCE_KERNEL_ERROR_NO_MEMORY = 0x80020190;
+constexpr uint32_t SCE_KERNEL_ERROR_ILLEGAL_ENTRY = 0x80020192;
+constexpr uint32_t SCE_KERNEL_ERROR_ILLEGAL_PRIORITY = 0x80020193;
+constexpr uint32_t SCE_KERNEL_ERROR_ILLEGAL_STACK_SIZE = 0x80020194;
+constexpr uint32_t SCE_KERNEL_ERROR_UNKNOWN_THID = 0x80020198;
+constexpr uint32_t SCE_KERNEL_ERROR_DORMANT = 0x800201A2;
+constexpr uint32_t SCE_KERNEL_ERROR_NOT_DORMANT = 0x800201A4;
+
+// Планировщик потоков гостя (HLE ThreadManForUser).
+//
+// Потоки живут в фиксированном массиве, очереди готовых - интрузивные списки
+// по приоритетам плюс битовая карта непустых очередей: выбор следующего потока -
+// поиск младшего бита, переключение - копирование контекста CPUState.
+// Ни создание очередей, ни переключение не выделяют память.
+//
+// Время - эмулируемое: задержки - события CoreTiming, которые будят поток
+// между отрезками исполнения. Когда все потоки ждут, исполняется поток
+// простоя (цикл "b ."), который интерпретатор и JIT распознают как цикл
+// ожидания и пропускают до ближайшего события.
+class ThreadManager {
+public:
+    static constexpr uint32_t MAX_THREADS = 64;
+    static constexpr uint32_t NUM_PRIORITIES = 128;     // 0 - наивысший
+
+    // Код ядра в памяти ядра: возврат из функции потока и цикл простоя
+    static constexpr uint32_t KERNEL_STUB_ADDR = core::Memory::RAM_BASE;
+    static constexpr uint32_t THREAD_RETURN_ADDR = KERNEL_STUB_ADDR;
+    static constexpr uint32_t IDLE_LOOP_ADDR = KERNEL_STUB_ADDR + 8;
+    // Стеки потоков выделяются от конца RAM вниз
+    static constexpr uint32_t STACK_TOP = core::Memory::RAM_BASE + core::Memory::RAM_SIZE;
+
+    static constexpr uint32_t MAIN_THREAD_PRIORITY = 0x20;
+    static constexpr uint32_t MAIN_THREAD_STACK_SIZE = 0x40000;
+
+    // Причина ожидания для WaitCurrent()/WakeWaiting()
+    enum class WaitType : uint8_t {
+        None,
+        Vblank,
+        AsyncIo,    // id - номер fd
+    };
+
+    ThreadManager(core::CPUState& cpu, core::Memory& memory, core::CoreTiming& timing);
+
+    // Запрещаем копирование
+    ThreadManager(const ThreadManager&) = delete;
+    ThreadManager& operator=(const ThreadManager&) = delete;
+
+    // Syscall ThreadManForUser. Переключение потока откладывается
+    // до RescheduleIfNeeded()
+    uint32_t CreateThread(const std::string& name, uint32_t entry, uint32_t priority,
+                          uint32_t stackSize, uint32_t attr);
+    uint32_t StartThread(uint32_t thid, uint32_t argSize, uint32_t argPtr);
+    uint32_t ExitThread(uint32_t exitStatus);
+    uint32_t ExitDeleteThread(uint32_t exitStatus);
+    uint32_t DeleteThread(uint32_t thid);
+    uint32_t SleepThread();
+    uint32_t WakeupThread(uint32_t thid);
+    uint32_t DelayThread(uint32_t usec);
+    uint32_t GetThreadId();
+
+    // Блокирует текущий поток до WakeWaiting() с теми же type и id
+    void WaitCurrent(WaitType type, uint32_t id);
+    // Делает готовыми все потоки, ждущие (type, id)
+    void WakeWaiting(WaitType type, uint32_t id);
+    // То же, но syscall, на котором ждал поток, возвращает result
+    void WakeWaiting(WaitType type, uint32_t id, uint32_t result);
+
+    // Переключает поток, если вызовы выше изменили очередь готовых.
+    // Вызывается после того, как результат syscall записан в v0 вызвавшего
+    void RescheduleIfNeeded();
+
+    uint64_t GetContextSwitchCount() const { return switches_; }
+
+private:
+    enum class ThreadState : uint8_t {
+        Free,       // слот свободен
+        Dormant,    // создан или завершён, не запущен
+        Ready,
+        Running,
+        Sleeping,   // sceKernelSleepThread
+        Delayed,    // sceKernelDelayThread
+        Waiting,    // WaitCurrent()
+    };
+
+    static constexpr uint8_t NO_THREAD = 0xFF;
+
+    struct Thread {
+        core::CPUState::Context context;
+        char name[32];
+        uint32_t uid;
+        uint32_t entry;
+        uint32_t stackAddr;
+        uint32_t stackSize;
+        uint32_t exitStatus;
+        uint32_t wakeupCount;   // sceKernelWakeupThread до засыпания
+        uint32_t waitId;
+        uint8_t priority;
+        ThreadState state;
+        WaitType waitType;
+        uint8_t prev;       // соседи в очереди готовых
+        uint8_t next;
+    };
+
+    void EnsureInitialized();
+    Thread* FindThread(uint32_t thid);
+    uint8_t AllocateSlot();
+    bool AllocateStack(uint32_t size, uint32_t& outAddr);
+    void FreeThread(uint8_t slot);
+    void ResetContext(Thread& thread);
+
+    // Очереди готовых
+    void PushBack(uint8_t slot);
+    void PushFront(uint8_t slot);
+    void Unlink(uint8_t slot);
+    int HighestReadyPriority() const;
+
+    // Событие CoreTiming: истекла задержка потока в слоте param
+    static void OnDelayExpired(void* userdata, uint64_t param, int64_t cyclesLate);
+
+    void MakeReady(uint8_t slot);
+    void WakeWaitingImpl(WaitType type, uint32_t id, bool setResult, uint32_t result);
+    // Текущий поток больше не исполняется (ждёт или завершён)
+    void BlockCurrent(ThreadState state);
+    void SwitchTo(uint8_t slot);
+
+    core::CPUState& cpu_;
+    core::Memory& memory_;
+    core::CoreTiming& timing_;
+    core::CoreTiming::EventType delayEvent_;
+    bool initialized_ = false;
+    bool rescheduleNeeded_ = false;
+
+    std::array<Thread, MAX_THREADS> threads_{};
+    uint8_t current_ = NO_THREAD;
+    uint8_t idle_ = NO_THREAD;
+    uint32_t nextSerial_ = 1;
+
+    std::array<uint8_t, NUM_PRIORITIES> queueHead_{};
+    std::array<uint8_t, NUM_PRIORITIES> queueTail_{};
+    uint64_t readyMask_[NUM_PRIORITIES / 64] = {};
+
+    // Стеки завершённых потоков, готовые к повторному использованию
+    struct StackRange {
+        uint32_t addr;
+        uint32_t size;
+    };
+    std::array<StackRange, MAX_THREADS> freeStacks_{};
+    size_t numFreeStacks_ = 0;
+    uint32_t stackBottom_ = STACK_TOP;
+
+    uint64_t switches_ = 0;
+};
+
+}  // namespace syscall
+}  // namespace ppsspp
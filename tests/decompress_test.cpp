@@ -0,0 +1,152 @@
+// tests/decompress_test.cpp
+//
+// Inflate и Lz4Decompress на известных векторах: блоки DEFLATE всех трёх типов
+// (получены zlib с windowBits = -15), перекрывающиеся совпадения LZ4,
+// а также обрезанные и испорченные данные, которые должны давать -1.
+
+#include "test_common.h"
+
+#include "Loader/decompress.h"
+
+#include <string>
+
+using ppsspp::loader::Inflate;
+using ppsspp::loader::Lz4Decompress;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+// Последний блок, BTYPE = 00: "PSP stored block"
+const Bytes STORED = {
+    0x01, 0x10, 0x00, 0xEF, 0xFF, 0x50, 0x53, 0x50, 0x20, 0x73, 0x74, 0x6F, 0x72, 0x65, 0x64,
+    0x20, 0x62, 0x6C, 0x6F, 0x63, 0x6B,
+};
+
+// Последний блок, BTYPE = 01: "abcabcabcabcabcabc" (литералы и совпадение на расстоянии 3)
+const Bytes FIXED = { 0x4B, 0x4C, 0x4A, 0x4E, 0x44, 0x45, 0x00 };
+
+// Последний блок, BTYPE = 10: DynamicText()
+const Bytes DYNAMIC = {
+    0x85, 0xD0, 0x31, 0x0E, 0xC2, 0x30, 0x0C, 0x40, 0xD1, 0xAB, 0xE4, 0x04, 0x28, 0x8E, 0xED,
+    0x38, 0x19, 0x2B, 0x0A, 0x52, 0xA4, 0x22, 0x2A, 0xD2, 0xCE, 0xDC, 0xFF, 0x16, 0x88, 0x81,
+    0x11, 0xFD, 0x3F, 0xFF, 0xE9, 0xED, 0xCB, 0x6B, 0x79, 0x5C, 0xE6, 0xFD, 0x99, 0xD6, 0x31,
+    0xAF, 0xEF, 0xB1, 0xA6, 0x73, 0x3B, 0x67, 0xFE, 0x96, 0x8E, 0x71, 0x6C, 0xB7, 0xB4, 0xFF,
+    0x3D, 0x82, 0x0E, 0x31, 0x3A, 0x8A, 0xE0, 0xD1, 0xE8, 0x50, 0xA7, 0xC3, 0x0A, 0x1E, 0x9D,
+    0x0E, 0xAF, 0x74, 0x54, 0xA5, 0x23, 0xD0, 0x34, 0xD0, 0xB4, 0xA1, 0x69, 0x47, 0xD3, 0x8E,
+    0xA6, 0x19, 0x4D, 0x05, 0x4D, 0x05, 0x4D, 0x0B, 0x9A, 0x2A, 0x9A, 0x1A, 0x9A, 0x1A, 0x9A,
+    0x3A, 0x9A, 0x56, 0x34, 0xAD, 0x68, 0x1A, 0x68, 0xDA, 0xD0, 0xB4, 0xA1, 0x69, 0x47, 0xD3,
+    0x8C, 0xA6, 0x82, 0xA6, 0x82, 0xA6, 0x05, 0x4D, 0x15, 0x4D, 0x15, 0x4D, 0x0D, 0x4D, 0x1D,
+    0x4D, 0x1D, 0x4D, 0x2B, 0x9A, 0xC6, 0xCF, 0xF4, 0x03,
+};
+
+std::string DynamicText() {
+    std::string text;
+    char line[64];
+    for (int i = 0; i < 40; ++i) {
+        std::snprintf(line, sizeof(line), "PARAM.SFO DISC_ID ULUS%05d TITLE ", i * 7 % 100);
+        text += line;
+    }
+    return text;
+}
+
+// Результат распаковки или пустая строка с result = -1
+ptrdiff_t RunInflate(const Bytes& in, size_t outSize, std::string& out) {
+    Bytes buffer(outSize);
+    const ptrdiff_t n = Inflate(in.data(), in.size(), buffer.data(), buffer.size());
+    out.assign(buffer.begin(), buffer.begin() + (n > 0 ? n : 0));
+    return n;
+}
+
+ptrdiff_t RunLz4(const Bytes& in, size_t outSize, std::string& out) {
+    Bytes buffer(outSize);
+    const ptrdiff_t n = Lz4Decompress(in.data(), in.size(), buffer.data(), buffer.size());
+    out.assign(buffer.begin(), buffer.begin() + (n > 0 ? n : 0));
+    return n;
+}
+
+void TestInflate() {
+    std::string out;
+
+    CHECK_EQ(RunInflate(STORED, 64, out), ptrdiff_t(16));
+    CHECK(out == "PSP stored block");
+
+    CHECK_EQ(RunInflate(FIXED, 64, out), ptrdiff_t(18));
+    CHECK(out == "abcabcabcabcabcabc");
+
+    const std::string text = DynamicText();
+    CHECK_EQ(RunInflate(DYNAMIC, text.size() + 16, out), ptrdiff_t(text.size()));
+    CHECK(out == text);
+
+    // Поток из двух блоков: неокончательный stored, за ним фиксированный
+    Bytes twoBlocks = { 0x00, 0x05, 0x00, 0xFA, 0xFF, 'h', 'e', 'l', 'l', 'o' };
+    twoBlocks.insert(twoBlocks.end(), FIXED.begin(), FIXED.end());
+    CHECK_EQ(RunInflate(twoBlocks, 64, out), ptrdiff_t(23));
+    CHECK(out == "helloabcabcabcabcabcabc");
+
+    // Выход, заполненный на границе блока, останавливает распаковку;
+    // блок, который не помещается в выход, - ошибка
+    CHECK_EQ(RunInflate(twoBlocks, 5, out), ptrdiff_t(5));
+    CHECK(out == "hello");
+    CHECK_EQ(RunInflate(DYNAMIC, 100, out), ptrdiff_t(-1));
+    CHECK_EQ(RunInflate(STORED, 8, out), ptrdiff_t(-1));
+
+    // Испорченные данные
+    Bytes badLength = STORED;
+    badLength[3] ^= 0x01;                           // NLEN != ~LEN
+    CHECK_EQ(RunInflate(badLength, 64, out), ptrdiff_t(-1));
+    CHECK_EQ(RunInflate({ 0x07, 0x00 }, 64, out), ptrdiff_t(-1));   // BTYPE = 11
+    CHECK_EQ(RunInflate({}, 64, out), ptrdiff_t(-1));
+
+    // Обрезанные данные: поток кончается раньше последнего блока
+    for (size_t size : { size_t(1), size_t(3), size_t(10) }) {
+        CHECK_EQ(RunInflate(Bytes(STORED.begin(), STORED.begin() + size), 64, out), ptrdiff_t(-1));
+    }
+    for (size_t size : { size_t(1), size_t(2), size_t(20), size_t(100) }) {
+        CHECK_EQ(RunInflate(Bytes(DYNAMIC.begin(), DYNAMIC.begin() + size), text.size(), out), ptrdiff_t(-1));
+    }
+    CHECK_EQ(RunInflate(Bytes(twoBlocks.begin(), twoBlocks.begin() + 10), 64, out), ptrdiff_t(-1));
+}
+
+void TestLz4() {
+    std::string out;
+
+    // Литерал 'x' и совпадение длиной 15 на расстоянии 1, затем литералы "END"
+    const Bytes runLength = { 0x1B, 'x', 0x01, 0x00, 0x30, 'E', 'N', 'D' };
+    CHECK_EQ(RunLz4(runLength, 64, out), ptrdiff_t(19));
+    CHECK(out == std::string(16, 'x') + "END");
+
+    // Совпадение длиной 10 на расстоянии 2 перекрывает само себя
+    const Bytes overlap = { 0x26, 'a', 'b', 0x02, 0x00, 0x10, '!' };
+    CHECK_EQ(RunLz4(overlap, 64, out), ptrdiff_t(13));
+    CHECK(out == "abababababab!");
+
+    // Длины литералов и совпадения с байтами продолжения
+    Bytes extended = { 0xFF, 5 };
+    const std::string literals = "0123456789ABCDEFGHIJ";
+    extended.insert(extended.end(), literals.begin(), literals.end());
+    extended.insert(extended.end(), { 0x05, 0x00, 255, 1 });    // 15 + 255 + 1 + 4 = 275
+    CHECK_EQ(RunLz4(extended, 512, out), ptrdiff_t(20 + 275));
+    std::string expected = literals;
+    while (expected.size() < 20 + 275) expected += expected[expected.size() - 5];
+    CHECK(out == expected);
+
+    // Испорченные данные
+    CHECK_EQ(RunLz4({ 0x10, 'a', 0x00, 0x00 }, 64, out), ptrdiff_t(-1));      // offset = 0
+    CHECK_EQ(RunLz4({ 0x10, 'a', 0x02, 0x00 }, 64, out), ptrdiff_t(-1));      // раньше начала выхода
+    CHECK_EQ(RunLz4(overlap, 8, out), ptrdiff_t(-1));                         // совпадение не помещается
+
+    // Обрезанные данные
+    CHECK_EQ(RunLz4({ 0x50, 'a', 'b' }, 64, out), ptrdiff_t(-1));             // литералов меньше заявленных
+    CHECK_EQ(RunLz4({ 0x26, 'a', 'b', 0x02 }, 64, out), ptrdiff_t(-1));       // половина смещения
+    CHECK_EQ(RunLz4({ 0xF0, 255 }, 64, out), ptrdiff_t(-1));                  // длина без продолжения
+    CHECK_EQ(RunLz4({ 0x1F, 'x', 0x01, 0x00 }, 64, out), ptrdiff_t(-1));      // длина совпадения без продолжения
+}
+
+}  // namespace
+
+int main() {
+    TestInflate();
+    TestLz4();
+    return TestResult("decompress_test");
+}
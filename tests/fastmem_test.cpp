@@ -0,0 +1,55 @@
+// tests/fastmem_test.cpp
+//
+// Fastmem: чтение вне карты памяти даёт 0 без ошибки, запись вне карты не
+// выполняется и превращается в MemoryFault через RunFastmemGuarded.
+
+#include "test_common.h"
+
+using namespace ppsspp::core;
+
+namespace {
+
+constexpr uint32_t UNMAPPED_ADDR = 0x20001000;
+
+struct StoreArgs {
+    Memory* memory;
+    uint32_t addr;
+    uint32_t value;
+};
+
+void UncheckedStore(void* arg) {
+    auto* args = static_cast<StoreArgs*>(arg);
+    args->memory->Store<uint32_t, UncheckedAccess>(args->addr, args->value);
+}
+
+}  // namespace
+
+int main() {
+    Memory memory(true);
+    if (!memory.IsFastmem()) {
+        std::printf("fastmem_test: skipped, fastmem is unavailable\n");
+        return 0;
+    }
+
+    // Обычная память и её зеркало
+    StoreArgs ram{ &memory, Memory::RAM_BASE + 0x100, 0x12345678 };
+    CHECK(memory.RunFastmemGuarded(&UncheckedStore, &ram));
+    CHECK_EQ((memory.Load<uint32_t, UncheckedAccess>(0x40000000 + ram.addr)), ram.value);
+    CHECK(!memory.HasFault());
+
+    CHECK_EQ((memory.Load<uint32_t, UncheckedAccess>(UNMAPPED_ADDR)), 0u);
+    CHECK_EQ(memory.GetFastmemFaultCount(), uint64_t(0));
+
+    StoreArgs bad{ &memory, UNMAPPED_ADDR, 0xDEADBEEF };
+    CHECK(!memory.RunFastmemGuarded(&UncheckedStore, &bad));
+    CHECK(memory.HasFault());
+    CHECK_EQ(memory.GetFault().addr, UNMAPPED_ADDR);
+    CHECK(memory.GetFault().write);
+    CHECK_EQ(memory.GetFastmemFaultCount(), uint64_t(1));
+
+    // Запись не осталась в памяти, и повторная снова перехватывается
+    CHECK_EQ((memory.Load<uint32_t, UncheckedAccess>(UNMAPPED_ADDR)), 0u);
+    CHECK(!memory.RunFastmemGuarded(&UncheckedStore, &bad));
+    CHECK_EQ(memory.GetFastmemFaultCount(), uint64_t(2));
+    return TestResult("fastmem_test");
+}
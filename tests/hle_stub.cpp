@@ -0,0 +1,19 @@
+// tests/hle_stub.cpp
+
+// HLE-обработчик по умолчанию требует видео и аудио Xbox 360. На хосте тесты
+// ставят свой обработчик через SetSyscallHook(), а этот лишь останавливает ЦП.
+
+#include "core/syscall.h"
+#include "core/cpu_state.h"
+
+namespace ppsspp {
+namespace syscall {
+
+void HandleSyscall(core::CPUState* st, uint32_t /*syscallID*/) {
+    *st->GetPCPtr() = core::CPUState::INVALID_PC;
+}
+
+void ResetSyscallHandler() {}
+
+}  // namespace syscall
+}  // namespace ppsspp
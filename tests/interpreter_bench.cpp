@@ -0,0 +1,108 @@
+// tests/interpreter_bench.cpp
+//
+// Скорость интерпретатора на цикле addiu/addu/bne в сравнении с простым
+// циклом "выборка - декодирование - switch". Аргумент - число итераций цикла.
+
+#include "test_common.h"
+
+#include "core/block_cache.h"
+#include "core/cpu_state.h"
+#include "core/decoder.h"
+#include "core/interpreter.h"
+
+#include <chrono>
+#include <cstdlib>
+
+using namespace ppsspp::core;
+
+namespace {
+
+constexpr uint32_t CODE_ADDR = 0x1000;
+constexpr uint32_t LOOP_ADDR = CODE_ADDR + 4;
+
+const std::vector<uint32_t> LOOP_CODE = {
+    0x3C087FFF,     // lui   t0, 0x7FFF
+    0x2508FFFF,     // loop: addiu t0, t0, -1
+    0x00681821,     //       addu  v1, v1, t0
+    0x1500FFFD,     //       bne   t0, zero, loop
+    0x24420001,     //       addiu v0, v0, 1
+};
+
+// Эталон: каждая инструкция читается и декодируется заново
+int64_t RunDecodeSwitch(CPUState& cpu, Memory& memory, int64_t count) {
+    const Decoder decoder(false);
+    uint32_t* gpr = cpu.GetGPRPtr();
+    uint32_t pc = cpu.GetPC();
+    uint32_t branchTarget = 0;
+    bool branchPending = false;
+
+    for (int64_t n = 0; n < count; ++n) {
+        const Decoded d = decoder.Decode(memory.Read32(pc));
+        uint32_t nextPC = pc + 4;
+        bool taken = false;
+        switch (d.Id()) {
+            case InstId::Lui:   gpr[d.Rt()] = uint32_t(d.Imm()) << 16; break;
+            case InstId::Addiu: gpr[d.Rt()] = gpr[d.Rs()] + d.SImm(); break;
+            case InstId::Addu:  gpr[d.Rd()] = gpr[d.Rs()] + gpr[d.Rt()]; break;
+            case InstId::Bne:
+                taken = gpr[d.Rs()] != gpr[d.Rt()];
+                branchTarget = taken ? d.BranchTarget(pc) : pc + 8;
+                break;
+            default: std::abort();
+        }
+        gpr[0] = 0;
+        if (branchPending) {
+            nextPC = branchTarget;
+            branchPending = false;
+        } else if (d.IsBranch()) {
+            branchPending = true;
+        }
+        pc = nextPC;
+    }
+    cpu.SetPC(pc);
+    return count;
+}
+
+template <typename F>
+double MeasureMips(F&& run, int64_t& executed) {
+    const auto start = std::chrono::steady_clock::now();
+    executed = run();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(executed) / seconds / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int64_t iterations = argc > 1 ? std::atoll(argv[1]) : 100000000;
+    // lui и по четыре инструкции на итерацию: бюджет кончается на границе блока
+    const int64_t budget = 1 + iterations * 4;
+
+    Memory refMemory;
+    CPUState refCpu;
+    LoadCode(refMemory, CODE_ADDR, LOOP_CODE);
+    refCpu.SetPC(CODE_ADDR);
+    int64_t refExecuted = 0;
+    const double refMips = MeasureMips([&] { return RunDecodeSwitch(refCpu, refMemory, budget); }, refExecuted);
+
+    Memory memory;
+    CPUState cpu;
+    LoadCode(memory, CODE_ADDR, LOOP_CODE);
+    cpu.SetPC(CODE_ADDR);
+    BlockCache blocks(memory);
+    Interpreter interpreter(cpu, memory, blocks);
+    int64_t executed = 0;
+    const double mips = MeasureMips([&] { return interpreter.Run(budget); }, executed);
+
+    std::printf("decode+switch: %lld insts, %.1f MIPS\n", (long long)refExecuted, refMips);
+    std::printf("interpreter:   %lld insts, %.1f MIPS\n", (long long)executed, mips);
+
+    CHECK_EQ(executed, budget);
+    CHECK_EQ(cpu.GetPC(), LOOP_ADDR);
+    CHECK_EQ(cpu.GetGPR(2), uint32_t(iterations));
+    for (int reg = 0; reg < 32; ++reg) {
+        CHECK_EQ(cpu.GetGPR(reg), refCpu.GetGPR(reg));
+    }
+    CHECK_EQ(cpu.GetPC(), refCpu.GetPC());
+    return TestResult("interpreter_bench");
+}
@@ -0,0 +1,120 @@
+// tests/ir_mmio_test.cpp
+//
+// EliminateRedundantLoads не должен объединять чтения регистров устройств:
+// два lw регистра кнопок в одном блоке оба доходят до обработчика MMIO.
+// Повторное чтение обычной памяти при этом по-прежнему устраняется.
+
+#include "test_common.h"
+
+#include "core/block_cache.h"
+#include "core/cpu_state.h"
+#include "core/decoder.h"
+#include "core/interpreter.h"
+#include "core/ir.h"
+#include "core/mmio.h"
+#include "jit/x64_jit.h"
+
+using namespace ppsspp::core;
+
+namespace {
+
+constexpr uint32_t CODE_ADDR = 0x1000;
+constexpr uint32_t DATA_ADDR = 0x2000;
+
+constexpr uint32_t SYSCALL_EXIT = 1;
+constexpr uint32_t MIPS_SYSCALL_EXIT = (SYSCALL_EXIT << 6) | 0x0C;
+
+const std::vector<uint32_t> MMIO_CODE = {
+    0x3C080000 | (ControllerMmio::BASE >> 16),  // lui t0, ControllerMmio::BASE
+    0x8D090004,     // lw   t1, BUTTONS(t0)
+    0x8D0A0004,     // lw   t2, BUTTONS(t0)
+    MIPS_SYSCALL_EXIT,
+};
+
+const std::vector<uint32_t> RAM_CODE = {
+    0x8C092000,     // lw   t1, 0x2000(zero)
+    0x8C0A2000,     // lw   t2, 0x2000(zero)
+    MIPS_SYSCALL_EXIT,
+};
+
+// Регистр кнопок, который меняется при каждом чтении
+class CountingButtons : public MmioHandler {
+public:
+    uint32_t Read(uint32_t, uint8_t) override { return ++reads; }
+    void Write(uint32_t, uint8_t, uint32_t) override {}
+
+    uint32_t reads = 0;
+};
+
+// MapMmio отказывает: адрес вне окна MMIO или страница скрывает регион памяти
+bool MapRejected(uint32_t addr) {
+    Memory memory;
+    CountingButtons buttons;
+    try {
+        memory.MapMmio(addr, sizeof(uint32_t), &buttons);
+    } catch (const MemoryError&) {
+        return true;
+    }
+    return false;
+}
+
+void ExitSyscall(CPUState* cpu, uint32_t) {
+    *cpu->GetPCPtr() = CPUState::INVALID_PC;
+}
+
+size_t CountLoads(const std::vector<uint32_t>& code) {
+    const Decoder decoder(false);
+    std::vector<IRInst> block;
+    for (size_t i = 0; i < code.size(); ++i) {
+        block.push_back(LowerToIR(CODE_ADDR + uint32_t(i) * 4, decoder.Decode(code[i])));
+    }
+    IRStats stats;
+    OptimizeIR(block, stats);
+
+    size_t loads = 0;
+    for (const IRInst& ir : block) {
+        if (ir.op == IROp::Load32) ++loads;
+    }
+    return loads;
+}
+
+void RunMmioBlock(bool useJit) {
+    Memory memory;
+    CPUState cpu;
+    CountingButtons buttons;
+    memory.MapMmio(ControllerMmio::BASE + ControllerMmio::BUTTONS, sizeof(uint32_t), &buttons);
+    LoadCode(memory, CODE_ADDR, MMIO_CODE);
+    cpu.SetPC(CODE_ADDR);
+
+    BlockCache blocks(memory);
+    if (useJit) {
+        ppsspp::jit::Jit jit(cpu, memory, blocks);
+        jit.SetSyscallHook(&ExitSyscall);
+        jit.Run(100);
+    } else {
+        Interpreter interpreter(cpu, memory, blocks);
+        interpreter.SetSyscallHook(&ExitSyscall);
+        interpreter.Run(100);
+    }
+
+    CHECK_EQ(cpu.GetPC(), CPUState::INVALID_PC);
+    CHECK_EQ(buttons.reads, 2u);
+    CHECK_EQ(cpu.GetGPR(9), 1u);
+    CHECK_EQ(cpu.GetGPR(10), 2u);
+}
+
+}  // namespace
+
+int main() {
+    CHECK_EQ(CountLoads(MMIO_CODE), size_t(2));
+    CHECK_EQ(CountLoads(RAM_CODE), size_t(1));
+
+    RunMmioBlock(false);
+    RunMmioBlock(true);
+
+    CHECK(MapRejected(DATA_ADDR));
+    // Зеркало RAM ядра 0x88000000: там заглушки ThreadManager
+    CHECK(MapRejected(Memory::RAM_BASE | 0x80000000));
+    CHECK(!MapRejected(ControllerMmio::BASE));
+    return TestResult("ir_mmio_test");
+}
@@ -0,0 +1,254 @@
+// tests/jit_differential_test.cpp
+//
+// Случайные программы исполняются интерпретатором без оптимизации IR (эталон),
+// интерпретатором с оптимизацией и рекомпилятором; регистры, PC и память
+// данных должны совпасть. Аргумент - зерно генератора.
+
+#include "test_common.h"
+
+#include "core/block_cache.h"
+#include "core/cpu_state.h"
+#include "core/interpreter.h"
+#include "jit/x64_jit.h"
+
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <random>
+
+using namespace ppsspp::core;
+
+namespace {
+
+constexpr uint32_t CODE_ADDR = 0x1000;
+constexpr uint32_t DATA_ADDR = 0x2000;
+constexpr uint32_t DATA_WORDS = 64;
+constexpr int NUM_PROGRAMS = 300;
+constexpr int64_t MAX_CYCLES = 100000;
+
+constexpr uint32_t SYSCALL_EXIT = 1;
+constexpr uint32_t MIPS_SYSCALL_EXIT = (SYSCALL_EXIT << 6) | 0x0C;
+
+// HLE для теста: код 1 завершает программу, остальные пишут в v0 значение от кода
+void TestSyscall(CPUState* cpu, uint32_t code) {
+    if (code == SYSCALL_EXIT) {
+        *cpu->GetPCPtr() = CPUState::INVALID_PC;
+    } else {
+        cpu->GetGPRPtr()[2] = code * 3;
+    }
+}
+
+enum class Backend {
+    Reference,      // интерпретатор без оптимизации IR
+    Interpreter,
+    Jit,
+};
+
+struct Result {
+    std::array<uint32_t, 32> gpr;
+    std::array<uint32_t, 32> fpr;   // битовые образы: NaN сравниваются как равные
+    uint32_t lo, hi, pc, fcr31;
+    uint32_t memoryHash;
+
+    bool operator==(const Result&) const = default;
+};
+
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(uint32_t seed) : rng_(seed) {}
+
+    std::vector<uint32_t> Generate() {
+        std::vector<uint32_t> code;
+        const int count = 5 + int(rng_() % 20);
+        for (int k = 0; k < count; ++k) {
+            Emit(code);
+        }
+        code.push_back(MIPS_SYSCALL_EXIT);
+        return code;
+    }
+
+    uint32_t Next() { return uint32_t(rng_()); }
+
+private:
+    // t0..t7, изредка $zero
+    uint32_t Reg() {
+        const uint32_t v = rng_() % 10;
+        return v >= 8 ? 0u : v + 8;
+    }
+
+    static uint32_t RType(uint32_t rs, uint32_t rt, uint32_t rd, uint32_t sa, uint32_t funct) {
+        return (rs << 21) | (rt << 16) | (rd << 11) | (sa << 6) | funct;
+    }
+    static uint32_t IType(uint32_t op, uint32_t rs, uint32_t rt, uint32_t imm) {
+        return (op << 26) | (rs << 21) | (rt << 16) | (imm & 0xFFFF);
+    }
+    // COP1: fmt в поле rs, остальное - младшие 16 бит
+    static uint32_t Cop1(uint32_t fmt, uint32_t rt, uint32_t low) {
+        return (0x11u << 26) | (fmt << 21) | (rt << 16) | low;
+    }
+
+    void Emit(std::vector<uint32_t>& code) {
+        static constexpr uint32_t FUNCTS[] = {
+            0x00, 0x02, 0x03, 0x04, 0x06, 0x07, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x2A,
+            0x2B, 0x18, 0x19, 0x10, 0x12, 0x0A, 0x0B, 0x2C, 0x2D, 0x1A, 0x1B, 0x16,
+        };
+        static constexpr uint32_t IMM_OPS[] = { 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+        static constexpr uint32_t MEM_OPS[] = { 0x20, 0x21, 0x23, 0x24, 0x25, 0x28, 0x29, 0x2B };
+        static constexpr uint32_t BRANCH_OPS[] = { 0x04, 0x05, 0x06, 0x07, 0x14, 0x15, 0x16, 0x17 };
+        static constexpr uint32_t REGIMM_RTS[] = { 0x00, 0x01, 0x02, 0x03, 0x10, 0x11, 0x12, 0x13 };
+        static constexpr uint32_t FPU_FUNCTS[] = {
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x0C, 0x0D, 0x0E, 0x0F, 0x24,
+        };
+
+        const uint32_t rs = Reg(), rt = Reg(), rd = Reg();
+        const uint32_t sa = rng_() % 32, imm = rng_() & 0xFFFF;
+        const uint32_t fs = rng_() % 4, ft = rng_() % 4, fd = rng_() % 4;
+
+        switch (rng_() % 17) {
+            case 0: case 1: case 2: case 3:
+                code.push_back(RType(rs, rt, rd, sa, FUNCTS[rng_() % std::size(FUNCTS)]));
+                break;
+            case 4:
+                code.push_back(IType(IMM_OPS[rng_() % std::size(IMM_OPS)], rs, rt, imm));
+                break;
+            case 5: {
+                // Выровненный доступ к области данных относительно $zero
+                const uint32_t op = MEM_OPS[rng_() % std::size(MEM_OPS)];
+                uint32_t offset = DATA_ADDR + (rng_() % DATA_WORDS) * 4;
+                if (op == 0x20 || op == 0x24 || op == 0x28) offset += rng_() % 4;
+                if (op == 0x21 || op == 0x25 || op == 0x29) offset += (rng_() % 2) * 2;
+                code.push_back(IType(op, 0, rt, offset));
+                break;
+            }
+            case 6:
+                // Переход вперёд через одну инструкцию, в том числе likely
+                code.push_back(IType(BRANCH_OPS[rng_() % std::size(BRANCH_OPS)], rs, rt, 2));
+                code.push_back(IType(0x09, rs, rd, imm));
+                code.push_back(IType(0x09, rt, rd, 5));
+                break;
+            case 7:
+                code.push_back(IType(0x01, rs, REGIMM_RTS[rng_() % std::size(REGIMM_RTS)], 2));
+                code.push_back(IType(0x09, rs, rd, imm));
+                code.push_back(IType(0x09, rt, rd, 5));
+                break;
+            case 8:
+                // syscall: HLE пишет v0 и меняет PC возврата
+                code.push_back(((rng_() % 60 + 2) << 6) | 0x0C);
+                break;
+            case 9:
+                code.push_back((0x1F << 26) | (rs << 21) | (rt << 16) | ((rng_() % 16) << 11) | ((rng_() % 16) << 6));
+                break;
+            case 10: {
+                const uint32_t t = Reg();
+                code.push_back(IType(0x0F, 0, t, imm));
+                code.push_back(IType(0x0D, t, t, rng_()));
+                if (rng_() % 2) code.push_back(IType(0x0F, 0, t, 7));
+                break;
+            }
+            case 11: {
+                // Повторные загрузки и store-to-load для EliminateRedundantLoads
+                const uint32_t op = (rng_() % 2) ? 0x23 : 0x21;
+                const uint32_t offset = DATA_ADDR + (rng_() % 8) * 4;
+                if (rng_() % 3 == 0) code.push_back(IType(0x2B, 0, rs, offset));
+                code.push_back(IType(op, 0, rt, offset));
+                if (rng_() % 2) code.push_back(IType(0x09, rd, rd, 3));
+                code.push_back(IType(op, 0, rd, offset));
+                break;
+            }
+            case 12:
+                // syscall в delay slot: PC возврата - цель перехода
+                code.push_back(IType(BRANCH_OPS[rng_() % std::size(BRANCH_OPS)], rs, rt, 2));
+                code.push_back(((rng_() % 60 + 2) << 6) | 0x0C);
+                code.push_back(IType(0x09, rt, rd, 5));
+                break;
+            case 13:
+                // FPU: операнды из GPR (как биты или через cvt.s.w), результат обратно
+                code.push_back(Cop1(0x04, rs, fs << 11));                         // mtc1
+                code.push_back(Cop1(0x04, rt, ft << 11));
+                if (rng_() % 2) code.push_back(Cop1(0x14, 0, (fs << 11) | (fs << 6) | 0x20));  // cvt.s.w
+                code.push_back(Cop1(0x10, ft, (fs << 11) | (fd << 6) | FPU_FUNCTS[rng_() % std::size(FPU_FUNCTS)]));
+                code.push_back(Cop1(0x00, rd, fd << 11));                         // mfc1
+                break;
+            case 14:
+                // c.cond.s и bc1f/bc1t/bc1fl/bc1tl вперёд через одну инструкцию
+                code.push_back(Cop1(0x10, ft, (fs << 11) | 0x30 | (rng_() % 16)));
+                code.push_back(Cop1(0x08, rng_() % 4, 2));
+                code.push_back(IType(0x09, rs, rd, imm));
+                code.push_back(IType(0x09, rt, rd, 5));
+                break;
+            case 15: {
+                // lwc1/swc1 в области данных, режим округления и флаг через ctc1/cfc1
+                const uint32_t offset = DATA_ADDR + (rng_() % DATA_WORDS) * 4;
+                code.push_back(IType(rng_() % 2 ? 0x31 : 0x39, 0, fd, offset));
+                if (rng_() % 2) code.push_back(Cop1(0x06, rs, 31 << 11));         // ctc1
+                code.push_back(Cop1(0x02, rt, 31 << 11));                         // cfc1
+                break;
+            }
+            default:
+                code.push_back(IType(0x09, rs, rt, imm));
+                break;
+        }
+    }
+
+    std::mt19937 rng_;
+};
+
+Result Execute(Backend backend, const std::vector<uint32_t>& code,
+               const std::array<uint32_t, 8>& init, uint32_t dataSeed) {
+    Memory memory;
+    CPUState cpu;
+    LoadCode(memory, CODE_ADDR, code);
+    for (uint32_t k = 0; k < DATA_WORDS; ++k) {
+        memory.Write32(DATA_ADDR + k * 4, k * 0x01010101u + dataSeed);
+    }
+    for (int k = 0; k < 8; ++k) {
+        cpu.GetGPRPtr()[8 + k] = init[k];
+    }
+    cpu.SetPC(CODE_ADDR);
+
+    BlockCache blocks(memory);
+    blocks.SetIROptimization(backend != Backend::Reference);
+    if (backend == Backend::Jit) {
+        ppsspp::jit::Jit jit(cpu, memory, blocks);
+        jit.SetSyscallHook(&TestSyscall);
+        jit.Run(MAX_CYCLES);
+    } else {
+        Interpreter interpreter(cpu, memory, blocks);
+        interpreter.SetSyscallHook(&TestSyscall);
+        interpreter.Run(MAX_CYCLES);
+    }
+
+    Result result{};
+    for (int k = 0; k < 32; ++k) result.gpr[k] = cpu.GetGPR(k);
+    for (int k = 0; k < 32; ++k) result.fpr[k] = std::bit_cast<uint32_t>(cpu.GetFPRPtr()[k]);
+    result.fcr31 = *cpu.GetFCR31Ptr();
+    result.lo = cpu.GetLO();
+    result.hi = cpu.GetHI();
+    result.pc = cpu.GetPC();
+    for (uint32_t k = 0; k < DATA_WORDS; ++k) {
+        result.memoryHash = result.memoryHash * 31 + memory.Read32(DATA_ADDR + k * 4);
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    ProgramGenerator generator(argc > 1 ? uint32_t(std::atoi(argv[1])) : 1234);
+
+    for (int program = 0; program < NUM_PROGRAMS; ++program) {
+        const std::vector<uint32_t> code = generator.Generate();
+        std::array<uint32_t, 8> init;
+        for (uint32_t& value : init) value = generator.Next();
+
+        const Result reference = Execute(Backend::Reference, code, init, program);
+        CHECK_EQ(reference.pc, CPUState::INVALID_PC);
+        for (Backend backend : { Backend::Interpreter, Backend::Jit }) {
+            const Result result = Execute(backend, code, init, program);
+            if (result == reference) continue;
+            std::fprintf(stderr, "program %d differs on backend %d\n", program, int(backend));
+            CHECK(result == reference);
+        }
+    }
+    return TestResult("jit_differential_test");
+}
@@ -0,0 +1,126 @@
+// tests/system_test.cpp
+//
+// Главный цикл core::System: исполненные инструкции продвигают CoreTiming,
+// события наступают в срок и могут остановить Run(). Проверяется на
+// интерпретаторе и рекомпиляторе.
+
+#include "test_common.h"
+
+#include "core/system.h"
+
+using namespace ppsspp::core;
+
+namespace {
+
+constexpr uint32_t CODE_ADDR = Memory::RAM_BASE + 0x1000;
+
+// Срок тестового события: кадр PSP
+constexpr int64_t EVENT_CYCLES = CoreTiming::CPU_HZ * 1001 / 60000;
+constexpr int EVENT_COUNT = 3;
+
+constexpr uint32_t IDLE_LOOP = 0x1000FFFF;     // b .
+constexpr uint32_t NOP = 0;
+constexpr uint32_t SYSCALL_STOP = 0x0000000C;  // syscall 0
+
+struct EventLog {
+    System* system = nullptr;
+    CoreTiming::EventType type = 0;
+    int fired = 0;
+    int64_t maxLate = 0;
+    uint64_t lastTicks = 0;
+};
+
+void OnTestEvent(void* userdata, uint64_t /*param*/, int64_t cyclesLate) {
+    auto* log = static_cast<EventLog*>(userdata);
+    ++log->fired;
+    if (cyclesLate > log->maxLate) log->maxLate = cyclesLate;
+    log->lastTicks = log->system->GetTiming().GetTicks();
+    if (log->fired < EVENT_COUNT) {
+        log->system->GetTiming().ScheduleEvent(EVENT_CYCLES - cyclesLate, log->type);
+    } else {
+        log->system->Stop();
+    }
+}
+
+void StopSyscall(CPUState* cpu, uint32_t /*code*/) {
+    *cpu->GetPCPtr() = CPUState::INVALID_PC;
+}
+
+// Время, которое видит HLE в момент syscall
+uint64_t g_syscallTicks = 0;
+
+void RecordTicksSyscall(CPUState* cpu, uint32_t code) {
+    g_syscallTicks = System::GetCurrent()->GetTiming().GetTicks();
+    StopSyscall(cpu, code);
+}
+
+// Гость ждёт в цикле; время идёт только за счёт отрезков Run()
+void TestEventsStopIdleLoop(bool useJit) {
+    System system(useJit);
+    CoreTiming& timing = system.GetTiming();
+    timing.SetThrottle(false);
+
+    EventLog log{ &system };
+    log.type = timing.RegisterEvent("Test", &OnTestEvent, &log);
+    timing.ScheduleEvent(EVENT_CYCLES, log.type);
+
+    LoadCode(system.GetMemory(), CODE_ADDR, { IDLE_LOOP, NOP });
+    system.GetCPU().SetPC(CODE_ADDR);
+    system.Run();
+
+    CHECK_EQ(log.fired, EVENT_COUNT);
+    CHECK_EQ(log.maxLate, int64_t(0));
+    CHECK_EQ(log.lastTicks, uint64_t(EVENT_COUNT * EVENT_CYCLES));
+    CHECK_EQ(timing.GetTicks(), uint64_t(EVENT_COUNT * EVENT_CYCLES));
+    CHECK_EQ(system.GetCPU().GetPC(), CODE_ADDR);
+}
+
+// Run() завершается, когда гость выходит, и засчитывает исполненное
+void TestGuestExit(bool useJit) {
+    System system(useJit);
+    system.GetTiming().SetThrottle(false);
+    system.SetSyscallHook(&StopSyscall);
+    CHECK(System::GetCurrent() == &system);
+
+    LoadCode(system.GetMemory(), CODE_ADDR, { NOP, NOP, SYSCALL_STOP });
+    system.GetCPU().SetPC(CODE_ADDR);
+    system.Run();
+
+    CHECK_EQ(system.GetCPU().GetPC(), CPUState::INVALID_PC);
+    CHECK_EQ(system.GetTiming().GetTicks(), uint64_t(3));
+}
+
+// Внутри отрезка время включает уже исполненные блоки
+void TestTicksInsideSlice(bool useJit) {
+    constexpr uint32_t ITERATIONS = 1000;
+    System system(useJit);
+    system.GetTiming().SetThrottle(false);
+    system.SetSyscallHook(&RecordTicksSyscall);
+
+    LoadCode(system.GetMemory(), CODE_ADDR, {
+        0x24080000 | ITERATIONS,    // addiu t0, zero, ITERATIONS
+        0x2508FFFF,                 // loop: addiu t0, t0, -1
+        0x1500FFFE,                 // bne   t0, zero, loop
+        NOP,
+        SYSCALL_STOP,
+    });
+    system.GetCPU().SetPC(CODE_ADDR);
+    g_syscallTicks = 0;
+    system.Run();
+
+    // Блок с syscall ещё не засчитан, все предыдущие - да
+    CHECK_EQ(g_syscallTicks, uint64_t(1 + 3 * ITERATIONS));
+    CHECK_EQ(system.GetTiming().GetTicks(), uint64_t(2 + 3 * ITERATIONS));
+}
+
+}  // namespace
+
+int main() {
+    for (bool useJit : { false, true }) {
+        TestEventsStopIdleLoop(useJit);
+        TestGuestExit(useJit);
+        TestTicksInsideSlice(useJit);
+    }
+    CHECK(System::GetCurrent() == nullptr);
+    return TestResult("system_test");
+}
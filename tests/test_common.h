@@ -0,0 +1,47 @@
+// tests/test_common.h
+
+#pragma once
+
+#include "core/memory.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Проверка без остановки теста: main() возвращает число провалов
+inline int g_failures = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                              \
+    do {                                                                            \
+        const auto va_ = (a);                                                       \
+        const auto vb_ = (b);                                                       \
+        if (!(va_ == vb_)) {                                                        \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%llx vs %llx)\n", \
+                         __FILE__, __LINE__, #a, #b,                                \
+                         (unsigned long long)va_, (unsigned long long)vb_);         \
+            ++g_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+inline int TestResult(const char* name) {
+    if (g_failures) {
+        std::fprintf(stderr, "%s: %d failure(s)\n", name, g_failures);
+        return 1;
+    }
+    std::printf("%s: OK\n", name);
+    return 0;
+}
+
+inline void LoadCode(ppsspp::core::Memory& memory, uint32_t addr, const std::vector<uint32_t>& code) {
+    for (size_t i = 0; i < code.size(); ++i) {
+        memory.Write32(addr + uint32_t(i) * 4, code[i]);
+    }
+}
@@ -0,0 +1,213 @@
+// tests/thread_switch_test.cpp
+//
+// Два потока гостя передают друг другу управление через sceKernelSleepThread и
+// sceKernelWakeupThread. Вызовы идут через настоящие заглушки импорта
+// "jr $ra; syscall N", то есть syscall исполняется в delay slot, а HLE меняет
+// PC, переключая поток. Проверяется на интерпретаторе и рекомпиляторе.
+
+#include "test_common.h"
+
+#include "core/block_cache.h"
+#include "core/core_timing.h"
+#include "core/cpu_state.h"
+#include "core/interpreter.h"
+#include "jit/x64_jit.h"
+#include "syscall/nid_table.h"
+#include "syscall/thread_manager.h"
+
+using namespace ppsspp::core;
+using ppsspp::syscall::ThreadManager;
+
+namespace {
+
+constexpr uint32_t CODE_ADDR = Memory::RAM_BASE + 0x1000;
+constexpr uint32_t THREAD_B_ADDR = CODE_ADDR + 0x100;
+constexpr uint32_t STUBS_ADDR = CODE_ADDR + 0x200;
+constexpr uint32_t DATA_ADDR = Memory::RAM_BASE + 0x3000;
+
+// Слова в DATA_ADDR
+constexpr int16_t MAIN_THID = 0;
+constexpr int16_t COUNT_A = 4;
+constexpr int16_t COUNT_B = 8;
+constexpr int16_t THREAD_NAME = 16;
+
+constexpr uint32_t ROUNDS = 50;
+
+constexpr uint32_t CodeOf(uint32_t nid) {
+    uint32_t code = 0;
+    ppsspp::syscall::LookupNid(nid, code);
+    return code;
+}
+
+constexpr uint32_t SYS_CREATE = CodeOf(0x446D8DE6);    // sceKernelCreateThread
+constexpr uint32_t SYS_START = CodeOf(0xF475845D);     // sceKernelStartThread
+constexpr uint32_t SYS_SLEEP = CodeOf(0x9ACE131E);     // sceKernelSleepThread
+constexpr uint32_t SYS_WAKEUP = CodeOf(0xD59EAD2F);    // sceKernelWakeupThread
+constexpr uint32_t SYS_GETTID = CodeOf(0x293B45B8);    // sceKernelGetThreadId
+constexpr uint32_t SYS_STOP = 0xFFFFF;                 // только для теста: остановка
+
+// Порядок заглушек в STUBS_ADDR
+constexpr uint32_t STUB_CODES[] = { SYS_CREATE, SYS_START, SYS_SLEEP, SYS_WAKEUP, SYS_GETTID, SYS_STOP };
+
+constexpr uint32_t StubAddr(uint32_t code) {
+    for (uint32_t i = 0; i < std::size(STUB_CODES); ++i) {
+        if (STUB_CODES[i] == code) return STUBS_ADDR + i * 8;
+    }
+    return 0;
+}
+
+// Регистры MIPS
+constexpr uint32_t ZERO = 0, AT = 1, V0 = 2, A0 = 4, A1 = 5, A2 = 6, A3 = 7, T0 = 8;
+constexpr uint32_t S0 = 16, S1 = 17, T9 = 25, RA = 31;
+
+uint32_t IType(uint32_t op, uint32_t rs, uint32_t rt, uint32_t imm) {
+    return (op << 26) | (rs << 21) | (rt << 16) | (imm & 0xFFFF);
+}
+uint32_t Addiu(uint32_t rt, uint32_t rs, int16_t imm) { return IType(0x09, rs, rt, uint16_t(imm)); }
+uint32_t Lui(uint32_t rt, uint16_t imm) { return IType(0x0F, 0, rt, imm); }
+uint32_t Ori(uint32_t rt, uint32_t rs, uint16_t imm) { return IType(0x0D, rs, rt, imm); }
+uint32_t Lw(uint32_t rt, int16_t offset, uint32_t base) { return IType(0x23, base, rt, uint16_t(offset)); }
+uint32_t Sw(uint32_t rt, int16_t offset, uint32_t base) { return IType(0x2B, base, rt, uint16_t(offset)); }
+uint32_t Move(uint32_t rd, uint32_t rs) { return (rs << 21) | (rd << 11) | 0x21; }
+uint32_t Jal(uint32_t target) { return (0x03u << 26) | ((target >> 2) & 0x03FFFFFF); }
+uint32_t Jr(uint32_t rs) { return (rs << 21) | 0x08; }
+uint32_t Syscall(uint32_t code) { return (code << 6) | 0x0C; }
+constexpr uint32_t NOP = 0;
+
+// Условный переход с инструкции from на to (индексы в code)
+uint32_t Branch(uint32_t op, uint32_t rs, uint32_t rt, size_t from, size_t to) {
+    return IType(op, rs, rt, uint32_t(int32_t(to) - int32_t(from) - 1));
+}
+
+void Call(std::vector<uint32_t>& code, uint32_t sysCode) {
+    code.push_back(Jal(StubAddr(sysCode)));
+    code.push_back(NOP);
+}
+
+// t9 = DATA_ADDR
+void LoadDataBase(std::vector<uint32_t>& code) {
+    code.push_back(Lui(T9, DATA_ADDR >> 16));
+    code.push_back(Ori(T9, T9, DATA_ADDR & 0xFFFF));
+}
+
+// Главный поток: создаёт поток B, затем ROUNDS раз засыпает и будит B,
+// считая пробуждения в s0
+std::vector<uint32_t> MainThread() {
+    std::vector<uint32_t> code;
+    LoadDataBase(code);
+    Call(code, SYS_GETTID);
+    code.push_back(Sw(V0, MAIN_THID, T9));
+
+    code.push_back(Addiu(A0, T9, THREAD_NAME));
+    code.push_back(Lui(A1, THREAD_B_ADDR >> 16));
+    code.push_back(Ori(A1, A1, THREAD_B_ADDR & 0xFFFF));
+    code.push_back(Addiu(A2, ZERO, ThreadManager::MAIN_THREAD_PRIORITY));
+    code.push_back(Lui(A3, 0x0001));                    // стек 64KB
+    code.push_back(Move(T0, ZERO));
+    Call(code, SYS_CREATE);
+
+    code.push_back(Move(S1, V0));
+    code.push_back(Move(A0, S1));
+    code.push_back(Move(A1, ZERO));
+    code.push_back(Move(A2, ZERO));
+    Call(code, SYS_START);
+
+    code.push_back(Move(S0, ZERO));
+    const size_t loop = code.size();
+    Call(code, SYS_SLEEP);
+    code.push_back(Addiu(S0, S0, 1));
+    code.push_back(Sw(S0, COUNT_A, T9));
+    code.push_back(Move(A0, S1));
+    Call(code, SYS_WAKEUP);
+    code.push_back(Addiu(AT, ZERO, ROUNDS));
+    code.push_back(Branch(0x05, S0, AT, code.size(), loop));   // bne s0, at, loop
+    code.push_back(NOP);
+    Call(code, SYS_STOP);
+    return code;
+}
+
+// Поток B: будит главный и засыпает сам, считая пробуждения в s0
+std::vector<uint32_t> ThreadB() {
+    std::vector<uint32_t> code;
+    LoadDataBase(code);
+    code.push_back(Move(S0, ZERO));
+    const size_t loop = code.size();
+    code.push_back(Lw(A0, MAIN_THID, T9));
+    Call(code, SYS_WAKEUP);
+    Call(code, SYS_SLEEP);
+    code.push_back(Addiu(S0, S0, 1));
+    code.push_back(Sw(S0, COUNT_B, T9));
+    code.push_back(Branch(0x04, ZERO, ZERO, code.size(), loop));   // b loop
+    code.push_back(NOP);
+    return code;
+}
+
+// HLE для теста: коды заглушек отображаются прямо на ThreadManager
+ThreadManager* g_threads = nullptr;
+
+void TestSyscall(CPUState* cpu, uint32_t code) {
+    uint32_t* gpr = cpu->GetGPRPtr();
+    uint32_t result = 0;
+    switch (code) {
+        case SYS_CREATE: result = g_threads->CreateThread("B", gpr[A1], gpr[A2], gpr[A3], gpr[T0]); break;
+        case SYS_START:  result = g_threads->StartThread(gpr[A0], gpr[A1], gpr[A2]); break;
+        case SYS_SLEEP:  result = g_threads->SleepThread(); break;
+        case SYS_WAKEUP: result = g_threads->WakeupThread(gpr[A0]); break;
+        case SYS_GETTID: result = g_threads->GetThreadId(); break;
+        case SYS_STOP:
+            *cpu->GetPCPtr() = CPUState::INVALID_PC;
+            return;
+        default:
+            std::fprintf(stderr, "unexpected syscall %u\n", code);
+            ++g_failures;
+            *cpu->GetPCPtr() = CPUState::INVALID_PC;
+            return;
+    }
+    gpr[V0] = result;
+    g_threads->RescheduleIfNeeded();
+}
+
+void RunPingPong(bool useJit) {
+    Memory memory(true);
+    CPUState cpu;
+    CoreTiming timing;
+    ThreadManager threads(cpu, memory, timing);
+    g_threads = &threads;
+
+    LoadCode(memory, CODE_ADDR, MainThread());
+    LoadCode(memory, THREAD_B_ADDR, ThreadB());
+    for (uint32_t code : STUB_CODES) {
+        LoadCode(memory, StubAddr(code), { Jr(RA), Syscall(code) });
+    }
+    cpu.SetPC(CODE_ADDR);
+
+    BlockCache blocks(memory);
+    if (useJit) {
+        ppsspp::jit::Jit jit(cpu, memory, blocks);
+        jit.SetSyscallHook(&TestSyscall);
+        jit.Run(1000000);
+    } else {
+        Interpreter interpreter(cpu, memory, blocks);
+        interpreter.SetSyscallHook(&TestSyscall);
+        interpreter.Run(1000000);
+    }
+
+    CHECK_EQ(cpu.GetPC(), CPUState::INVALID_PC);
+    CHECK_EQ(memory.Read32(DATA_ADDR + COUNT_A), ROUNDS);
+    CHECK_EQ(memory.Read32(DATA_ADDR + COUNT_B), ROUNDS - 1);
+    // Главный поток засыпает ROUNDS раз, B - столько же, считая первый
+    CHECK_EQ(threads.GetContextSwitchCount(), uint64_t(2 * ROUNDS));
+    g_threads = nullptr;
+}
+
+}  // namespace
+
+int main() {
+    if (!Memory(true).IsFastmem()) {
+        std::printf("thread_switch_test: skipped, PSP memory map is unavailable\n");
+        return 0;
+    }
+    RunPingPong(false);
+    RunPingPong(true);
+    return TestResult("thread_switch_test");
+}